@@ -0,0 +1,121 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "FileStream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+
+/*
+* Measures the three ways FileReader and FileStream read a file: read() into one buffer, a FileStream
+* overlapping reads with consuming chunks, and map(). Each sums every byte, so each touches the whole file.
+*
+* A file is generated first, so it is likely in the page cache, and the times are of copying and mapping
+* rather than of the disk. Each way is run several times and the fastest reported.
+*
+* Usage: FileReaderBenchmark [megabytes] [runs]
+*/
+
+namespace
+{
+	uint64_t
+	sum(const unsigned char* data, size_t size)
+	{
+		uint64_t total = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			total += data[i];
+		}
+		return total;
+	}
+
+	void
+	measure(const char* name, uint64_t size, int runs, uint64_t expected, const std::function<uint64_t()>& read)
+	{
+		double best = 0.0;
+		bool matched = true;
+		for (int run = 0; run < runs; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			matched = read() == expected && matched;
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = run == 0 || seconds < best ? seconds : best;
+		}
+		std::printf("%-12s %8.2fms %9.1fMB/s%s\n", name, best * 1e3,
+			best > 0.0 ? static_cast<double>(size) / (1024.0 * 1024.0) / best : 0.0,
+			matched ? "" : " (mismatch)");
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	int megabytes = argc > 1 ? std::atoi(argv[1]) : 256;
+	int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+	const char* path = "FileReaderBenchmark.bin";
+	uint64_t size = static_cast<uint64_t>(megabytes) * 1024 * 1024;
+
+	uint64_t expected = 0;
+	{
+		std::vector<unsigned char> block(1024 * 1024);
+		for (size_t i = 0; i < block.size(); i++)
+		{
+			block[i] = static_cast<unsigned char>(i * 31 + (i >> 12));
+		}
+		std::ofstream file(path, std::ios::binary);
+		for (int i = 0; i < megabytes; i++)
+		{
+			file.write(reinterpret_cast<const char*>(block.data()), block.size());
+			expected += sum(block.data(), block.size());
+		}
+	}
+
+	FileReader file(L"FileReaderBenchmark.bin");
+	if (!file.isOpen() || file.getSize() != size)
+	{
+		std::fprintf(stderr, "The file couldn't be generated\n");
+		return EXIT_FAILURE;
+	}
+	WorkerPool workers;
+
+	std::printf("file %dMB, fastest of %d\n", megabytes, runs);
+	measure("read()", size, runs, expected, [&]
+	{
+		std::vector<unsigned char> data;
+		return file.read(data) ? sum(data.data(), data.size()) : 0;
+	});
+	measure("FileStream", size, runs, expected, [&]
+	{
+		FileStream stream(file, workers);
+		FileStream::Chunk chunk;
+		uint64_t total = 0;
+		while (stream.next(chunk))
+		{
+			total += sum(chunk.data, chunk.size);
+		}
+		return stream.hasFailed() ? 0 : total;
+	});
+	measure("map()", size, runs, expected, [&]
+	{
+		const unsigned char* data = file.map();
+		uint64_t total = data ? sum(data, static_cast<size_t>(size)) : 0;
+		file.unmap();
+		return total;
+	});
+
+	std::remove(path);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "InstanceController.h"
+#include "NullRenderer.h"
+#include "RunLoop.h"
+#include "TEStandIn.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/*
+* Measures the host's own cost per frame, running one instance against the stand-in TouchEngine with no frame
+* latency, so the time is all spent in InstanceController, the renderer and the calls they make.
+*
+* Usage: HostBenchmark [seconds] [input groups] [inputs per group] [outputs]
+*/
+
+namespace
+{
+	int
+	getArgument(int argc, char* argv[], int index, int fallback)
+	{
+		return index < argc ? std::atoi(argv[index]) : fallback;
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	int seconds = getArgument(argc, argv, 1, 5);
+	int inputGroups = getArgument(argc, argv, 2, 4);
+	int inputsPerGroup = getArgument(argc, argv, 3, 12);
+	int outputs = getArgument(argc, argv, 4, 12);
+
+	TEStandInConfiguration configuration = TEStandInGetConfiguration();
+	configuration.links = TEStandInMakeLayout(inputGroups, inputsPerGroup, outputs);
+	configuration.maxFramesInFlight = 2;
+	TEStandInSetConfiguration(configuration);
+
+	NullRenderer renderer;
+	renderer.setup(nullptr);
+	ConditionRunLoop runLoop;
+	InstanceController controller(renderer, &runLoop, false);
+	// Faster than any display, so the loop is limited by the host rather than the pacer
+	controller.setFrameRate(1000, 1);
+	if (controller.load("benchmark.tox") != TEResultSuccess)
+	{
+		std::fprintf(stderr, "The instance couldn't be created\n");
+		return EXIT_FAILURE;
+	}
+
+	auto run = [&](std::chrono::steady_clock::duration duration)
+	{
+		auto end = std::chrono::steady_clock::now() + duration;
+		while (std::chrono::steady_clock::now() < end)
+		{
+			int64_t wait = controller.getWaitTime();
+			if (wait > 0 && runLoop.wait(wait) == RunLoop::Wake::Signal)
+			{
+				controller.update();
+			}
+			else
+			{
+				controller.pace();
+			}
+		}
+	};
+
+	// Load and warm the caches before measuring
+	run(std::chrono::milliseconds(500));
+	if (!controller.isLoaded())
+	{
+		std::fprintf(stderr, "The instance didn't load\n");
+		return EXIT_FAILURE;
+	}
+	controller.getStatistics().collect();
+	controller.getStatistics().reset();
+	uint64_t startFrames = controller.getPacerStatistics().frames;
+	FramePipeline::Statistics startPipeline = controller.getFrameStatistics();
+	TEStandInResetCounters();
+
+	run(std::chrono::seconds(seconds));
+	controller.update();
+
+	const LatencyHistogram& update = controller.getStatistics().getHistogram(StatisticsCollector::Metric::Update);
+	uint64_t frames = controller.getPacerStatistics().frames - startFrames;
+	TEStandInCounters counters = TEStandInGetCounters();
+	double perFrame = frames > 0 ? 1.0 / static_cast<double>(frames) : 0.0;
+	const FramePipeline::Statistics& pipeline = controller.getFrameStatistics();
+	uint64_t started = pipeline.started - startPipeline.started;
+	uint64_t finished = pipeline.finished - startPipeline.finished;
+	double inFlight = started > 0 ? static_cast<double>(pipeline.inFlightSum - startPipeline.inFlightSum) / started : 0.0;
+	double latency = finished > 0 ? std::chrono::duration<double, std::micro>(pipeline.latencySum - startPipeline.latencySum).count() / finished : 0.0;
+
+	std::printf("links %d inputs, %d outputs\n", inputGroups * inputsPerGroup, outputs);
+	std::printf("frames %llu in %ds\n", static_cast<unsigned long long>(frames), seconds);
+	std::printf("update() ns: mean %lld p50 %lld p90 %lld p99 %lld max %lld\n",
+		static_cast<long long>(update.getMean()),
+		static_cast<long long>(update.getPercentile(50.0)),
+		static_cast<long long>(update.getPercentile(90.0)),
+		static_cast<long long>(update.getPercentile(99.0)),
+		static_cast<long long>(update.getMax()));
+	std::printf("per frame: api calls %.1f value sets %.1f value gets %.1f objects created %.1f\n",
+		counters.apiCalls * perFrame,
+		counters.valueSets * perFrame,
+		counters.valueGets * perFrame,
+		counters.objectsCreated * perFrame);
+	std::printf("frames in flight: mean %.2f already at each start, max %zu, latency mean %.1fus, unmatched %llu\n",
+		inFlight, pipeline.maxInFlight, latency, static_cast<unsigned long long>(pipeline.unmatched - startPipeline.unmatched));
+	return frames > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,148 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Strings.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*
+* Measures the UTF-8 transcoders in Strings.h on paths and labels of a few kinds, both the overloads which
+* reuse a destination and those which return a new string. On Windows they are compared with the
+* MultiByteToWideChar()/WideCharToMultiByte() conversions they replaced.
+*
+* Usage: StringsBenchmark [iterations]
+*/
+
+namespace
+{
+	struct Case
+	{
+		const char*		name;
+		std::string		utf8;
+	};
+
+	std::string
+	repeat(const std::string& text, size_t length)
+	{
+		std::string result;
+		while (result.size() < length)
+		{
+			result += text;
+		}
+		return result;
+	}
+
+#ifdef _WIN32
+	// The two-pass conversions Strings.cpp used before
+	std::wstring
+	win32ToWide(const std::string& string)
+	{
+		int count = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), nullptr, 0);
+		std::wstring wide;
+		wide.resize(count);
+		count = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), wide.data(), static_cast<int>(wide.size()));
+		wide.resize(count);
+		return wide;
+	}
+
+	std::string
+	win32ToMultiByte(const std::wstring& string)
+	{
+		int count = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), nullptr, 0, nullptr, nullptr);
+		std::string utf8;
+		utf8.resize(count);
+		count = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), utf8.data(), static_cast<int>(utf8.size()), nullptr, nullptr);
+		utf8.resize(count);
+		return utf8;
+	}
+#endif
+
+	// Runs convert iterations times, printing the time per call and the rate through the UTF-8 side
+	template <typename Convert>
+	void
+	measure(const char* name, const Case& test, int iterations, Convert convert)
+	{
+		size_t check = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			check += convert();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		double megabytes = static_cast<double>(test.utf8.size()) * iterations / (1024.0 * 1024.0);
+		std::printf("%-10s %-24s %9.1fns %9.1fMB/s%s\n", test.name, name,
+			seconds * 1e9 / iterations, seconds > 0.0 ? megabytes / seconds : 0.0,
+			check == static_cast<size_t>(iterations) * test.utf8.size() ? "" : " (mismatch)");
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+	const std::vector<Case> cases = {
+		{ "path", "C:/Users/Derivative/Documents/TouchDesigner/Components/movie_player.tox" },
+		{ "ascii", repeat("The quick brown fox jumps over the lazy dog. ", 4096) },
+		{ "latin", repeat("Gr\xC3\xBC\xC3\x9F" "e aus K\xC3\xB6ln, se\xC3\xB1or: d\xC3\xA9j\xC3\xA0 vu \xC3\xA0 la carte. ", 4096) },
+		{ "cjk", repeat("\xE6\x9D\xB1\xE4\xBA\xAC\xE9\x83\xBD\xE6\xB8\x8B\xE8\xB0\xB7\xE5\x8C\xBA\xE3\x81\xAE\xE6\x98\xA0\xE5\x83\x8F\xE5\x88\xB6\xE4\xBD\x9C\xE3\x82\xB9\xE3\x82\xBF\xE3\x82\xB8\xE3\x82\xAA\xE3\x80\x81", 4096) },
+		{ "emoji", repeat("frame \xF0\x9F\x8E\xAC take \xF0\x9F\x8E\xA5 ", 4096) },
+	};
+
+	for (const Case& test : cases)
+	{
+		std::wstring wide = ConvertToWide(test.utf8);
+		// Keep the iterations over the long strings to a comparable amount of text
+		int count = test.utf8.size() > 1024 ? iterations / 1000 + 1 : iterations;
+
+		std::wstring wideOut;
+		std::string utf8Out;
+		measure("ConvertToWide reuse", test, count, [&]
+		{
+			ConvertToWide(test.utf8, wideOut);
+			return wideOut.size() == wide.size() ? test.utf8.size() : 0;
+		});
+		measure("ConvertToWide", test, count, [&]
+		{
+			return ConvertToWide(test.utf8).size() == wide.size() ? test.utf8.size() : 0;
+		});
+		measure("ConvertToMultiByte reuse", test, count, [&]
+		{
+			ConvertToMultiByte(wide, utf8Out);
+			return utf8Out.size();
+		});
+		measure("ConvertToMultiByte", test, count, [&]
+		{
+			return ConvertToMultiByte(wide).size();
+		});
+#ifdef _WIN32
+		measure("MultiByteToWideChar", test, count, [&]
+		{
+			return win32ToWide(test.utf8).size() == wide.size() ? test.utf8.size() : 0;
+		});
+		measure("WideCharToMultiByte", test, count, [&]
+		{
+			return win32ToMultiByte(wide).size();
+		});
+#endif
+	}
+	return EXIT_SUCCESS;
+}
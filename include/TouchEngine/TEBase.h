@@ -27,7 +27,7 @@ extern "C" {
 	#if !defined(TE_EXPORT)
 		#define TE_EXPORT __attribute__((visibility("default")))
 	#endif
-#else
+#elif defined(_WIN32)
 	#define TE_ASSUME_NONNULL_BEGIN
 	#define TE_ASSUME_NONNULL_END
 	#define TE_NONNULL
@@ -39,10 +39,25 @@ extern "C" {
 			#define TE_EXPORT __declspec(dllimport)
 		#endif
 	#endif
+#else
+	// Only used to build against the stand-in library (see src/TEStandIn.h)
+	#define TE_ASSUME_NONNULL_BEGIN
+	#define TE_ASSUME_NONNULL_END
+	#define TE_NONNULL
+	#define TE_NULLABLE
+	#if !defined(TE_EXPORT)
+		#define TE_EXPORT __attribute__((visibility("default")))
+	#endif
 #endif
 
+#if defined(__cplusplus) && defined(__GNUC__) && !defined(__clang__)
+// GCC rejects the opaque form below in C++, where the enum name is already usable as a type. The typedef the macro
+// follows is given the underlying type instead, so it declares something and GCC doesn't warn it was ignored
+#define TE_ENUM(_name, _type) _type _name##Underlying; enum _name : _type
+#else
 // This form is supported for C by MSVC and LLVM, please contact us if your compiler doesn't support it
 #define TE_ENUM(_name, _type) enum _name : _type _name; enum _name : _type
+#endif
 
 #ifdef __cplusplus
 }
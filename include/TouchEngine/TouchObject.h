@@ -85,8 +85,10 @@ struct TouchIsMemberOf<T, U, typename std::enable_if_t<
 		std::is_same<U, TED3DSharedTexture>::value ||
 		std::is_same<U, TED3D11Texture>::value ||
 		std::is_same<U, TEVulkanTexture>::value
-#else
+#elif defined(__APPLE__)
 		std::is_same<U, TEIOSurfaceTexture>::value
+#else
+		false
 #endif
 		)
 	) ||
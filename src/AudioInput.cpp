@@ -0,0 +1,371 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "AudioInput.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	uint32_t
+	readLittleEndian(const unsigned char* data, size_t bytes)
+	{
+		uint32_t value = 0;
+		for (size_t i = 0; i < bytes; i++)
+		{
+			value |= static_cast<uint32_t>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	float
+	decodeSample(const unsigned char* data, uint32_t bits, bool isFloat)
+	{
+		if (isFloat)
+		{
+			uint32_t word = readLittleEndian(data, 4);
+			float value;
+			std::memcpy(&value, &word, sizeof(value));
+			return value;
+		}
+		switch (bits)
+		{
+		case 8:
+			// 8 bit samples are unsigned
+			return (static_cast<float>(data[0]) - 128.0f) / 128.0f;
+		case 16:
+			return static_cast<float>(static_cast<int16_t>(readLittleEndian(data, 2))) / 32768.0f;
+		case 24:
+			// Shift up so the sign bit lands at the top of the word
+			return static_cast<float>(static_cast<int32_t>(readLittleEndian(data, 3) << 8)) / 2147483648.0f;
+		default:
+			return static_cast<float>(static_cast<int32_t>(readLittleEndian(data, 4))) / 2147483648.0f;
+		}
+	}
+}
+
+AudioInput::AudioInput(double rate, int32_t channels, uint32_t capacity)
+	: myRate(rate), myCapacity(std::max(capacity, 1u)), myRing(channels, static_cast<size_t>(myCapacity) * 2), myLatency(myCapacity)
+{
+	myScratch.resize(myRing.getChannelCount());
+	for (auto& channel : myScratch)
+	{
+		channel.resize(myCapacity);
+		myChannels.push_back(channel.data());
+		myValues.push_back(channel.data());
+	}
+}
+
+AudioInput::~AudioInput()
+{
+	stop();
+}
+
+void
+AudioInput::setLatency(uint32_t latency)
+{
+	myLatency.store(latency, std::memory_order_relaxed);
+}
+
+void
+AudioInput::start(Generator generator, uint32_t latency)
+{
+	stop();
+	setLatency(latency);
+	myThread = std::thread(&AudioInput::run, this, std::move(generator), latency);
+}
+
+void
+AudioInput::stop()
+{
+	if (myThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> guard(myMutex);
+			myStopping = true;
+		}
+		myCondition.notify_all();
+		myThread.join();
+		myStopping = false;
+	}
+}
+
+void
+AudioInput::run(Generator generator, uint32_t latency)
+{
+	Trace::setThreadName("AudioInput");
+
+	std::vector<float> chunk(GeneratorChunk * getChannelCount());
+	auto start = std::chrono::steady_clock::now();
+	int64_t written = 0;
+
+	std::unique_lock<std::mutex> lock(myMutex);
+	while (!myStopping)
+	{
+		lock.unlock();
+		// Keep latency frames ahead of the audio clock, which starts with the thread
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		int64_t target = static_cast<int64_t>(elapsed * myRate) + latency;
+		while (written < target)
+		{
+			size_t frames = static_cast<size_t>(std::min<int64_t>(target - written, GeneratorChunk));
+			generator(chunk.data(), frames);
+			write(chunk.data(), frames);
+			written += frames;
+		}
+		lock.lock();
+		myCondition.wait_for(lock, std::chrono::nanoseconds(GeneratorPeriod), [this] { return myStopping; });
+	}
+}
+
+size_t
+AudioInput::write(const float* interleaved, size_t frames)
+{
+	size_t stored = myRing.write(interleaved, frames);
+	if (stored < frames)
+	{
+		myOverrun.fetch_add(frames - stored, std::memory_order_relaxed);
+	}
+	return stored;
+}
+
+int64_t
+AudioInput::toSampleTime(int64_t timeValue, int32_t timeScale) const
+{
+	// Exact for whole-number rates, so consecutive frames meet at the same sample
+	if (myRate == std::floor(myRate))
+	{
+		return timeValue * static_cast<int64_t>(myRate) / timeScale;
+	}
+	return static_cast<int64_t>(std::floor(static_cast<double>(timeValue) * myRate / timeScale));
+}
+
+TEFloatBuffer*
+AudioInput::prepare(size_t slot, int64_t timeValue, int64_t duration, int32_t timeScale)
+{
+	TRACE_SCOPE("AudioInput::prepare");
+
+	int64_t start = toSampleTime(timeValue, timeScale);
+	int64_t end = toSampleTime(timeValue + duration, timeScale);
+	if (!myStarted || start != myNextSample)
+	{
+		if (myStarted)
+		{
+			myStatistics.discontinuities++;
+		}
+		// Drop any backlog beyond the latency - samples for skipped frames, or those written before we started
+		size_t latency = myLatency.load(std::memory_order_relaxed);
+		size_t available = myRing.getAvailable();
+		if (available > latency)
+		{
+			myRing.discard(available - latency);
+		}
+		myNextSample = start;
+		myStarted = true;
+	}
+
+	uint32_t count = static_cast<uint32_t>(std::clamp<int64_t>(end - myNextSample, 0, myCapacity));
+	if (count == 0)
+	{
+		return nullptr;
+	}
+
+	// The samples stay in the ring until they are in a buffer, so a failure here loses none of them
+	size_t read = myRing.peek(myChannels.data(), count);
+	if (read < count)
+	{
+		// Silence rather than a gap, so later samples keep their times
+		for (auto& channel : myScratch)
+		{
+			std::fill(channel.begin() + read, channel.begin() + count, 0.0f);
+		}
+	}
+
+	if (myHeld.size() <= slot)
+	{
+		myHeld.resize(slot + 1);
+	}
+	abandon(slot);
+
+	TouchObject<TEFloatBuffer> buffer;
+	if (myPool.empty())
+	{
+		buffer.take(TRACE_TE(TEFloatBufferCreateTimeDependent, myRate, getChannelCount(), myCapacity, nullptr));
+		myStatistics.created++;
+	}
+	else
+	{
+		buffer = std::move(myPool.back());
+		myPool.pop_back();
+	}
+	if (!buffer)
+	{
+		return nullptr;
+	}
+	if (TRACE_TE(TEFloatBufferSetValues, buffer, myValues.data(), count) != TEResultSuccess ||
+		TRACE_TE(TEFloatBufferSetStartTime, buffer, myNextSample) != TEResultSuccess)
+	{
+		// The instance has never seen this buffer, so it can be reused
+		myPool.push_back(std::move(buffer));
+		return nullptr;
+	}
+	myRing.discard(read);
+	myNextSample += count;
+	myStatistics.underrun += count - read;
+	myStatistics.buffers++;
+	myStatistics.samples += count;
+
+	myHeld[slot] = std::move(buffer);
+	return myHeld[slot];
+}
+
+void
+AudioInput::release(size_t slot)
+{
+	if (slot < myHeld.size() && myHeld[slot])
+	{
+		myPool.push_back(std::move(myHeld[slot]));
+		myHeld[slot].reset();
+	}
+}
+
+void
+AudioInput::abandon(size_t slot)
+{
+	if (slot < myHeld.size())
+	{
+		myHeld[slot].reset();
+	}
+}
+
+void
+AudioInput::reset()
+{
+	for (size_t slot = 0; slot < myHeld.size(); slot++)
+	{
+		abandon(slot);
+	}
+	myStarted = false;
+}
+
+AudioInput::Statistics
+AudioInput::getStatistics() const
+{
+	Statistics statistics = myStatistics;
+	statistics.overrun = myOverrun.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+AudioInput::Generator
+AudioInput::makeTone(double rate, int32_t channels, double frequency, float amplitude)
+{
+	double step = 2.0 * 3.14159265358979323846 * frequency / rate;
+	return [channels, step, amplitude, phase = 0.0](float* interleaved, size_t frames) mutable
+	{
+		for (size_t i = 0; i < frames; i++)
+		{
+			float value = amplitude * static_cast<float>(std::sin(phase));
+			std::fill(interleaved + i * channels, interleaved + (i + 1) * channels, value);
+			phase = std::fmod(phase + step, 2.0 * 3.14159265358979323846);
+		}
+	};
+}
+
+AudioInput::Generator
+AudioInput::makeLoop(std::vector<float> samples, int32_t channels)
+{
+	size_t length = samples.size() / channels;
+	return [samples = std::move(samples), channels, length, position = size_t(0)](float* interleaved, size_t frames) mutable
+	{
+		if (length == 0)
+		{
+			std::fill(interleaved, interleaved + frames * channels, 0.0f);
+			return;
+		}
+		while (frames > 0)
+		{
+			size_t run = std::min(frames, length - position);
+			std::copy(samples.begin() + position * channels, samples.begin() + (position + run) * channels, interleaved);
+			interleaved += run * channels;
+			frames -= run;
+			position = (position + run) % length;
+		}
+	};
+}
+
+bool
+AudioInput::decodeWAV(const unsigned char* data, size_t size, int32_t channels, double& rate, std::vector<float>& samples)
+{
+	if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0 || channels < 1)
+	{
+		return false;
+	}
+
+	uint32_t format = 0;
+	uint32_t fileChannels = 0;
+	uint32_t bits = 0;
+	uint32_t blockAlign = 0;
+	const unsigned char* sampleData = nullptr;
+	size_t sampleSize = 0;
+
+	size_t offset = 12;
+	while (offset + 8 <= size)
+	{
+		const unsigned char* chunk = data + offset;
+		size_t chunkSize = std::min<size_t>(readLittleEndian(chunk + 4, 4), size - offset - 8);
+		if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+		{
+			format = readLittleEndian(chunk + 8, 2);
+			fileChannels = readLittleEndian(chunk + 10, 2);
+			rate = static_cast<double>(readLittleEndian(chunk + 12, 4));
+			blockAlign = readLittleEndian(chunk + 20, 2);
+			bits = readLittleEndian(chunk + 22, 2);
+			// WAVE_FORMAT_EXTENSIBLE keeps the real format at the start of its sub-format GUID
+			if (format == 0xFFFE && chunkSize >= 26)
+			{
+				format = readLittleEndian(chunk + 32, 2);
+			}
+		}
+		else if (std::memcmp(chunk, "data", 4) == 0)
+		{
+			sampleData = chunk + 8;
+			sampleSize = chunkSize;
+		}
+		// Chunks are padded to an even size
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+
+	bool isFloat = format == 3 && bits == 32;
+	bool isPCM = format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+	if (!(isFloat || isPCM) || sampleData == nullptr || fileChannels == 0 || rate <= 0.0 || blockAlign < fileChannels * (bits / 8))
+	{
+		return false;
+	}
+
+	size_t frames = sampleSize / blockAlign;
+	samples.resize(frames * channels);
+	for (size_t frame = 0; frame < frames; frame++)
+	{
+		const unsigned char* source = sampleData + frame * blockAlign;
+		for (int32_t channel = 0; channel < channels; channel++)
+		{
+			uint32_t sourceChannel = std::min(static_cast<uint32_t>(channel), fileChannels - 1);
+			samples[frame * channels + channel] = decodeSample(source + sourceChannel * (bits / 8), bits, isFloat);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,152 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <TouchEngine/TouchObject.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SampleRing.h"
+
+/*
+* Streams audio into time-dependent float buffer inputs.
+*
+* A producer - our own thread running a Generator, or any single thread calling write() - feeds samples
+* into a SampleRing at the audio rate. For each frame the update thread calls prepare(), which slices the
+* samples up to the end of that frame into a time-dependent TEFloatBuffer whose start time follows on from
+* the last, so TouchEngine receives a gapless stream matched to frame times. Should the producer fall
+* behind, the shortfall is filled with silence.
+*
+* Buffers are pooled: each is held for the frame slot it was prepared for and reused once release() is
+* called for that slot as the frame finishes, so no buffers are created once the pool has warmed up.
+*/
+class AudioInput
+{
+public:
+	// Fills interleaved with frames sample frames, called from the producer thread
+	using Generator = std::function<void(float* interleaved, size_t frames)>;
+
+	struct Statistics
+	{
+		uint64_t	buffers = 0;
+		uint64_t	samples = 0;
+		// Sample frames of silence sent because the producer had fallen behind
+		uint64_t	underrun = 0;
+		// Sample frames the producer couldn't store because the ring was full
+		uint64_t	overrun = 0;
+		// Times the stream was restarted because frame times didn't follow on, as when frames are skipped
+		uint64_t	discontinuities = 0;
+		// TEFloatBuffers created for the pool
+		uint64_t	created = 0;
+	};
+
+	// capacity is the most sample frames sent for one frame, which also sizes the ring
+	AudioInput(double rate, int32_t channels, uint32_t capacity);
+	AudioInput(const AudioInput& o) = delete;
+	AudioInput& operator=(const AudioInput& o) = delete;
+	~AudioInput();
+
+	double
+	getRate() const
+	{
+		return myRate;
+	}
+
+	int32_t
+	getChannelCount() const
+	{
+		return myRing.getChannelCount();
+	}
+
+	/*
+	* Starts a thread which calls generator to keep the ring filled to latency sample frames ahead of
+	* the audio clock. Stops any previous generator.
+	*/
+	void	start(Generator generator, uint32_t latency);
+	void	stop();
+
+	/*
+	* The most sample frames left queued when the stream restarts, at the first frame or after skipped frames.
+	* Set by start(), and should exceed a frame's samples. Defaults to the capacity.
+	*/
+	void	setLatency(uint32_t latency);
+
+	// Feeds samples from a single producer thread of your own, returning the number of frames stored
+	size_t	write(const float* interleaved, size_t frames);
+
+	/*
+	* Update thread only. Returns a buffer holding the samples up to the end of the frame at timeValue, to be
+	* added to float buffer input links with TEInstanceLinkAddFloatBuffer(), or null if there are none.
+	* The buffer is held for slot until release().
+	*/
+	TEFloatBuffer*	prepare(size_t slot, int64_t timeValue, int64_t duration, int32_t timeScale);
+	// Returns the buffer held for a finished frame to the pool
+	void	release(size_t slot);
+	// Forgets the buffer held for a frame which failed to start, without reusing it as the instance may still hold it
+	void	abandon(size_t slot);
+	// Abandons every held buffer, and restarts the stream at the next frame
+	void	reset();
+
+	Statistics	getStatistics() const;
+
+	// A Generator for a sine tone, the same in every channel
+	static Generator	makeTone(double rate, int32_t channels, double frequency, float amplitude);
+	// A Generator which repeats samples (interleaved, channels per frame) forever
+	static Generator	makeLoop(std::vector<float> samples, int32_t channels);
+
+	/*
+	* Decodes a RIFF WAVE file holding 8, 16, 24 or 32 bit PCM or 32 bit float samples, to interleaved
+	* samples with channels per frame - dropping extra channels, or repeating the last for missing ones.
+	* Returns false if the data can't be decoded.
+	*/
+	static bool	decodeWAV(const unsigned char* data, size_t size, int32_t channels, double& rate, std::vector<float>& samples);
+private:
+	// Sample frames the producer thread generates at a time
+	static constexpr size_t	 GeneratorChunk{ 256 };
+	// How often the producer thread tops up the ring (nanoseconds)
+	static constexpr int64_t GeneratorPeriod{ 2000000 };
+
+	void	run(Generator generator, uint32_t latency);
+	int64_t	toSampleTime(int64_t timeValue, int32_t timeScale) const;
+
+	double			myRate;
+	uint32_t		myCapacity;
+	SampleRing		myRing;
+	std::atomic<uint32_t>	myLatency;
+	std::atomic<uint64_t>	myOverrun{ 0 };
+
+	std::thread				myThread;
+	std::mutex				myMutex;
+	std::condition_variable	myCondition;
+	bool					myStopping{ false };
+
+	// Update thread state
+	bool			myStarted{ false };
+	int64_t			myNextSample{ 0 };
+	std::vector<std::vector<float>>	myScratch;
+	std::vector<float*>				myChannels;
+	std::vector<const float*>		myValues;
+	std::vector<TouchObject<TEFloatBuffer>>	myPool;
+	// Indexed by frame slot
+	std::vector<TouchObject<TEFloatBuffer>>	myHeld;
+	Statistics		myStatistics;
+};
@@ -0,0 +1,155 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "CSVLoader.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cwctype>
+
+CSVLoader::CSVLoader(const std::wstring& path, WorkerPool* workers)
+	: myFile(path), myWorkers(workers), myParser(makeParser(path, workers))
+{
+	mySize = myFile.getSize();
+}
+
+CSVParser
+CSVLoader::makeParser(const std::wstring& path, WorkerPool* workers)
+{
+	std::wstring extension = path.substr((std::min)(path.find_last_of(L'.'), path.size()));
+	std::transform(extension.begin(), extension.end(), extension.begin(), std::towlower);
+	if (extension == L".tsv" || extension == L".txt")
+	{
+		return CSVParser('\t', false, workers);
+	}
+	return CSVParser(',', true, workers);
+}
+
+bool
+CSVLoader::load(CSVTable& table)
+{
+	TRACE_SCOPE("CSVLoader::load");
+	if (!myFile.isOpen())
+	{
+		return false;
+	}
+	if (mySize == 0)
+	{
+		myParser.parse(nullptr, 0, table);
+		return true;
+	}
+	if (mySize > SIZE_MAX)
+	{
+		return false;
+	}
+	const unsigned char *view = myFile.map();
+	if (!view)
+	{
+		return false;
+	}
+	myParser.parse(reinterpret_cast<const char*>(view), static_cast<size_t>(mySize), table);
+	myFile.unmap();
+	return true;
+}
+
+bool
+CSVLoader::index()
+{
+	TRACE_SCOPE("CSVLoader::index");
+	myIndexed = false;
+	myRowCount = 0;
+	myRowOffsets.clear();
+	if (!myFile.isOpen())
+	{
+		return false;
+	}
+
+	bool inQuotes = false;
+	bool atRowStart = true;
+	// Quote and row state carry over from one piece of the file to the next
+	auto scan = [this, &inQuotes, &atRowStart](const unsigned char* data, size_t length, uint64_t offset)
+	{
+		myParser.scanRows(reinterpret_cast<const char*>(data), length, inQuotes, atRowStart, [this, offset](size_t row)
+			{
+				if (myRowCount++ % RowIndexStride == 0)
+				{
+					myRowOffsets.push_back(offset + row);
+				}
+				return true;
+			});
+	};
+	if (myWorkers)
+	{
+		// The next chunks are read while this one is scanned
+		FileStream stream(myFile, *myWorkers);
+		FileStream::Chunk chunk;
+		while (stream.next(chunk))
+		{
+			scan(chunk.data, chunk.size, chunk.offset);
+		}
+		if (stream.hasFailed())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		for (uint64_t offset = 0; offset < mySize; offset += IndexWindow)
+		{
+			size_t length = static_cast<size_t>((std::min<uint64_t>)(IndexWindow, mySize - offset));
+			const unsigned char *view = myFile.map(offset, length);
+			if (!view)
+			{
+				return false;
+			}
+			scan(view, length, offset);
+		}
+	}
+	myFile.unmap();
+	myIndexed = true;
+	return true;
+}
+
+bool
+CSVLoader::loadRows(size_t first, size_t count, CSVTable& table)
+{
+	TRACE_SCOPE("CSVLoader::loadRows");
+	if (!myIndexed || first >= myRowCount)
+	{
+		return false;
+	}
+	size_t last = first + (std::min)(count, myRowCount - first);
+
+	// Map from the indexed row at or before first to the indexed row after last, then find the rows exactly
+	size_t startBlock = first / RowIndexStride;
+	size_t endBlock = last / RowIndexStride;
+	uint64_t start = myRowOffsets[startBlock];
+	uint64_t end = endBlock + 1 < myRowOffsets.size() ? myRowOffsets[endBlock + 1] : mySize;
+	size_t length = static_cast<size_t>(end - start);
+	const char* view = reinterpret_cast<const char*>(myFile.map(start, length));
+	if (!view)
+	{
+		return false;
+	}
+
+	size_t begin = myParser.skipRows(view, length, first % RowIndexStride);
+	size_t finish = length;
+	if (endBlock < myRowOffsets.size())
+	{
+		size_t block = static_cast<size_t>(myRowOffsets[endBlock] - start);
+		finish = block + myParser.skipRows(view + block, length - block, last % RowIndexStride);
+	}
+	myParser.parse(view + begin, finish - begin, table);
+	myFile.unmap();
+	return true;
+}
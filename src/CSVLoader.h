@@ -0,0 +1,72 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CSVParser.h"
+#include "FileReader.h"
+#include "FileStream.h"
+#include "WorkerPool.h"
+
+/*
+* Loads CSV or TSV files for string data inputs through a memory-mapped FileReader, so files are parsed
+* in place rather than read into memory first.
+*
+* load() parses a whole file, in parallel if given workers. For files too large for that, index() notes where
+* every RowIndexStride'th row starts - reading ahead through a FileStream on the workers, or without them
+* mapping a window of the file at a time - after which loadRows() maps and parses only the rows asked for.
+*
+* Large files take a while to load, so call these from a worker rather than the thread running frames - but
+* not one of the loader's own workers, which index() waits on.
+*/
+class CSVLoader
+{
+public:
+	// Files ending .tsv or .txt are taken to be tab separated without quoting, others comma separated
+	explicit CSVLoader(const std::wstring& path, WorkerPool* workers = nullptr);
+	CSVLoader(const CSVLoader& o) = delete;
+	CSVLoader& operator=(const CSVLoader& o) = delete;
+
+	bool	load(CSVTable& table);
+
+	// Streaming, for files larger than memory
+	bool	index();
+	// After index()
+	size_t
+	getRowCount() const
+	{
+		return myRowCount;
+	}
+	// Loads up to count rows from first, after index()
+	bool	loadRows(size_t first, size_t count, CSVTable& table);
+private:
+	static constexpr size_t	 RowIndexStride{ 1024 };
+	// How much of the file index() maps at a time
+	static constexpr size_t	 IndexWindow{ 64 * 1024 * 1024 };
+
+	static CSVParser	makeParser(const std::wstring& path, WorkerPool* workers);
+
+	FileReader				myFile;
+	WorkerPool*				myWorkers;
+	uint64_t				mySize;
+	CSVParser				myParser;
+	bool					myIndexed{ false };
+	size_t					myRowCount{ 0 };
+	// The offset of every RowIndexStride'th row
+	std::vector<uint64_t>	myRowOffsets;
+};
@@ -0,0 +1,307 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "CSVParser.h"
+#include "TableModel.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CSV_PARSER_SSE
+#endif
+
+const char*
+CSVTable::getCell(size_t row, int32_t column) const
+{
+	// The chunk holding row is the last to start at or before it
+	size_t index = std::upper_bound(myFirstRows.begin(), myFirstRows.end(), row) - myFirstRows.begin() - 1;
+	const Chunk& chunk = myChunks[index];
+	size_t local = row - myFirstRows[index];
+	size_t cell = chunk.rows[local] + column;
+	if (column < 0 || cell >= chunk.rows[local + 1])
+	{
+		return "";
+	}
+	return chunk.text.data() + chunk.cells[cell];
+}
+
+void
+CSVTable::fill(TETable* table) const
+{
+	TRACE_SCOPE("CSVTable::fill");
+	TRACE_TE(TETableResize, table, static_cast<int32_t>(myRowCount), myColumnCount);
+	int32_t row = 0;
+	for (const auto& chunk : myChunks)
+	{
+		for (size_t local = 0; local < chunk.getRowCount(); local++, row++)
+		{
+			// Cells missing from short rows are left empty
+			for (size_t cell = chunk.rows[local]; cell < chunk.rows[local + 1]; cell++)
+			{
+				TETableSetStringValue(table, row, static_cast<int32_t>(cell - chunk.rows[local]), chunk.text.data() + chunk.cells[cell]);
+			}
+		}
+	}
+}
+
+void
+CSVTable::fill(TableModel& model) const
+{
+	TRACE_SCOPE("CSVTable::fill");
+	model.resize(static_cast<int32_t>(myRowCount), myColumnCount);
+	int32_t row = 0;
+	for (const auto& chunk : myChunks)
+	{
+		for (size_t local = 0; local < chunk.getRowCount(); local++, row++)
+		{
+			int32_t count = static_cast<int32_t>(chunk.rows[local + 1] - chunk.rows[local]);
+			for (int32_t column = 0; column < myColumnCount; column++)
+			{
+				model.set(row, column, column < count ? chunk.text.data() + chunk.cells[chunk.rows[local] + column] : "");
+			}
+		}
+	}
+}
+
+CSVParser::CSVParser(char delimiter, bool quoted, WorkerPool* workers)
+	: myDelimiter(delimiter), myQuoted(quoted), myWorkers(workers)
+{
+}
+
+const char*
+CSVParser::find(const char* begin, const char* end, char a, char b, char c)
+{
+	const char* p = begin;
+#ifdef CSV_PARSER_SSE
+	__m128i va = _mm_set1_epi8(a);
+	__m128i vb = _mm_set1_epi8(b);
+	__m128i vc = _mm_set1_epi8(c);
+	for (; p + 16 <= end; p += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vc));
+		int mask = _mm_movemask_epi8(match);
+		if (mask != 0)
+		{
+			int bit = 0;
+			while ((mask & (1 << bit)) == 0)
+			{
+				bit++;
+			}
+			return p + bit;
+		}
+	}
+#endif
+	for (; p < end; p++)
+	{
+		if (*p == a || *p == b || *p == c)
+		{
+			return p;
+		}
+	}
+	return end;
+}
+
+size_t
+CSVParser::findRowStart(const char* data, size_t size, size_t offset, bool inQuotes) const
+{
+	bool atRowStart = false;
+	size_t start = size;
+	scanRows(data + offset, size - offset, inQuotes, atRowStart, [&start, offset](size_t row)
+		{
+			start = offset + row;
+			return false;
+		});
+	return start;
+}
+
+size_t
+CSVParser::skipRows(const char* data, size_t size, size_t count) const
+{
+	bool inQuotes = false;
+	bool atRowStart = true;
+	size_t seen = 0;
+	size_t found = size;
+	scanRows(data, size, inQuotes, atRowStart, [&seen, &found, count](size_t row)
+		{
+			if (seen++ < count)
+			{
+				return true;
+			}
+			found = row;
+			return false;
+		});
+	return found;
+}
+
+void
+CSVParser::parseChunk(const char* begin, const char* end, CSVTable::Chunk& chunk) const
+{
+	// Text is at most the input plus a terminator per cell, reserving the input size avoids most regrowth
+	chunk.text.clear();
+	chunk.text.reserve(static_cast<size_t>(end - begin) + 1024);
+	chunk.cells.clear();
+	chunk.rows.clear();
+	chunk.columnCount = 0;
+
+	const char* p = begin;
+	while (p < end)
+	{
+		size_t firstCell = chunk.cells.size();
+		chunk.rows.push_back(firstCell);
+		bool rowEnded = false;
+		while (!rowEnded)
+		{
+			chunk.cells.push_back(chunk.text.size());
+			if (myQuoted && p < end && *p == '"')
+			{
+				// Copy runs between quotes, a doubled quote standing for one
+				p++;
+				while (p < end)
+				{
+					const char* quote = static_cast<const char*>(std::memchr(p, '"', end - p));
+					const char* runEnd = quote ? quote : end;
+					chunk.text.insert(chunk.text.end(), p, runEnd);
+					p = runEnd;
+					if (p < end)
+					{
+						p++;
+						if (p < end && *p == '"')
+						{
+							chunk.text.push_back('"');
+							p++;
+							continue;
+						}
+					}
+					break;
+				}
+			}
+			// The rest of an unquoted field, or anything between a closing quote and the delimiter
+			const char* next = find(p, end, myDelimiter, '\n', '\r');
+			// A \r only ends a row before \n
+			while (next < end && *next == '\r' && !(next + 1 < end && next[1] == '\n'))
+			{
+				next = find(next + 1, end, myDelimiter, '\n', '\r');
+			}
+			chunk.text.insert(chunk.text.end(), p, next);
+			chunk.text.push_back('\0');
+			p = next;
+
+			if (p == end)
+			{
+				rowEnded = true;
+			}
+			else if (*p == myDelimiter)
+			{
+				p++;
+			}
+			else
+			{
+				// \n or \r\n
+				p += *p == '\r' ? 2 : 1;
+				rowEnded = true;
+			}
+		}
+		chunk.columnCount = std::max(chunk.columnCount, static_cast<int32_t>(chunk.cells.size() - firstCell));
+	}
+	chunk.rows.push_back(chunk.cells.size());
+}
+
+void
+CSVParser::parse(const char* data, size_t size, CSVTable& table) const
+{
+	TRACE_SCOPE("CSVParser::parse");
+
+	// Skip a UTF-8 byte order mark
+	if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+	{
+		data += 3;
+		size -= 3;
+	}
+
+	size_t threads = myWorkers ? myWorkers->getThreadCount() + 1 : 1;
+	size_t count = std::max<size_t>(1, std::min(threads, size / MinimumChunkSize));
+
+	// Each chunk starts at the first row beginning at or after an even split
+	std::vector<size_t> starts(count + 1, size);
+	starts[0] = 0;
+	if (count > 1)
+	{
+		std::vector<char> inQuotes(count, 0);
+		if (myQuoted)
+		{
+			std::vector<size_t> quotes(count, 0);
+			auto countQuotes = [&](size_t i)
+			{
+				const char* p = data + size * i / count;
+				const char* end = data + size * (i + 1) / count;
+				while ((p = find(p, end, '"', '"', '"')) != end)
+				{
+					quotes[i]++;
+					p++;
+				}
+			};
+			myWorkers->parallelFor(count, countQuotes);
+			size_t total = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				inQuotes[i] = (total & 1) != 0;
+				total += quotes[i];
+			}
+		}
+		myWorkers->parallelFor(count - 1, [&](size_t i)
+			{
+				size_t split = size * (i + 1) / count;
+				// A split just after a newline is already a row start
+				if (data[split - 1] == '\n' && !inQuotes[i + 1])
+				{
+					starts[i + 1] = split;
+				}
+				else
+				{
+					starts[i + 1] = findRowStart(data, size, split, inQuotes[i + 1] != 0);
+				}
+			});
+	}
+
+	table.myChunks.resize(count);
+	auto parse = [&](size_t i)
+	{
+		size_t begin = std::min(starts[i], size);
+		size_t end = std::max(begin, std::min(starts[i + 1], size));
+		parseChunk(data + begin, data + end, table.myChunks[i]);
+	};
+	if (count > 1)
+	{
+		myWorkers->parallelFor(count, parse);
+	}
+	else
+	{
+		parse(0);
+	}
+
+	// Chunks which found no row start are empty, and getCell() relies on there being none
+	table.myChunks.erase(std::remove_if(table.myChunks.begin(), table.myChunks.end(), [](const CSVTable::Chunk& chunk) { return chunk.getRowCount() == 0; }), table.myChunks.end());
+	table.myFirstRows.resize(table.myChunks.size());
+	table.myRowCount = 0;
+	table.myColumnCount = 0;
+	for (size_t i = 0; i < table.myChunks.size(); i++)
+	{
+		table.myFirstRows[i] = table.myRowCount;
+		table.myRowCount += table.myChunks[i].getRowCount();
+		table.myColumnCount = std::max(table.myColumnCount, table.myChunks[i].columnCount);
+	}
+}
@@ -0,0 +1,162 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WorkerPool.h"
+
+class TableModel;
+
+/*
+* Parsed rows of a CSV or TSV file, held as null-terminated cells in one buffer per parsed chunk, ready to
+* pass straight to TETableSetStringValue().
+*/
+class CSVTable
+{
+public:
+	size_t
+	getRowCount() const
+	{
+		return myRowCount;
+	}
+
+	// The most cells in any row
+	int32_t
+	getColumnCount() const
+	{
+		return myColumnCount;
+	}
+
+	// Cells missing from the end of short rows are empty
+	const char*	getCell(size_t row, int32_t column) const;
+
+	// Resizes table to fit and sets every cell
+	void	fill(TETable* table) const;
+	// Resizes model to fit and sets every cell, so only cells which differ from the model are sent
+	void	fill(TableModel& model) const;
+private:
+	friend class CSVParser;
+
+	struct Chunk
+	{
+		std::vector<char>		text;
+		// Offset in text of each cell
+		std::vector<size_t>		cells;
+		// Index in cells of each row's first cell, followed by the total cell count
+		std::vector<size_t>		rows;
+		int32_t					columnCount = 0;
+
+		size_t
+		getRowCount() const
+		{
+			return rows.empty() ? 0 : rows.size() - 1;
+		}
+	};
+
+	std::vector<Chunk>	myChunks;
+	// The index of each chunk's first row
+	std::vector<size_t>	myFirstRows;
+	size_t				myRowCount{ 0 };
+	int32_t				myColumnCount{ 0 };
+};
+
+/*
+* Parses CSV (RFC 4180, with fields optionally enclosed in double quotes) or TSV text. Rows end with \n or \r\n.
+*
+* Large inputs are split into chunks at row boundaries and parsed in parallel. A newline only ends a row
+* outside quotes, so each chunk's quote state is found from the parity of the quotes before it, which
+* assumes quotes only appear at the start of fields or doubled within quoted fields. Delimiters, quotes
+* and line ends are found with SSE2 where it is available.
+*/
+class CSVParser
+{
+public:
+	// TSV normally has no quoting, in which case pass quoted as false
+	explicit CSVParser(char delimiter = ',', bool quoted = true, WorkerPool* workers = nullptr);
+
+	// Replaces the contents of table
+	void	parse(const char* data, size_t size, CSVTable& table) const;
+
+	/*
+	* Scans for row starts without parsing cells, calling onRow with the offset of each row until it returns
+	* false. Continues from inQuotes and atRowStart (initially false and true) so text may be scanned in pieces.
+	* Returns the number of rows started.
+	*/
+	template <typename F>
+	size_t	scanRows(const char* data, size_t size, bool& inQuotes, bool& atRowStart, F onRow) const;
+
+	// Returns the offset of the row count rows after the start of data, or size if there are fewer
+	size_t	skipRows(const char* data, size_t size, size_t count) const;
+
+	char
+	getDelimiter() const
+	{
+		return myDelimiter;
+	}
+private:
+	// Inputs smaller than this per worker aren't split further
+	static constexpr size_t	 MinimumChunkSize{ 1 << 20 };
+
+	static const char*	find(const char* begin, const char* end, char a, char b, char c);
+	// Returns the offset of the first row starting at or after offset, given the quote state there
+	size_t	findRowStart(const char* data, size_t size, size_t offset, bool inQuotes) const;
+	void	parseChunk(const char* begin, const char* end, CSVTable::Chunk& chunk) const;
+
+	char		myDelimiter;
+	bool		myQuoted;
+	WorkerPool*	myWorkers;
+};
+
+template <typename F>
+size_t
+CSVParser::scanRows(const char* data, size_t size, bool& inQuotes, bool& atRowStart, F onRow) const
+{
+	const char* end = data + size;
+	const char* p = data;
+	size_t rows = 0;
+	while (p < end)
+	{
+		if (atRowStart)
+		{
+			rows++;
+			atRowStart = false;
+			if (!onRow(static_cast<size_t>(p - data)))
+			{
+				break;
+			}
+		}
+		// Within quotes only a quote matters, outside we want the next quote or newline
+		const char* next = inQuotes ? find(p, end, '"', '"', '"') : find(p, end, myQuoted ? '"' : '\n', '\n', '\n');
+		if (next == end)
+		{
+			break;
+		}
+		if (*next == '"')
+		{
+			inQuotes = !inQuotes;
+		}
+		else
+		{
+			atRowStart = true;
+		}
+		p = next + 1;
+	}
+	return rows;
+}
@@ -0,0 +1,440 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "ComponentCache.h"
+#include "FileReader.h"
+#include "Trace.h"
+#ifdef _WIN32
+#include <TouchEngine/TED3D.h>
+#endif
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace
+{
+	constexpr char Magic[4] = { 'T', 'E', 'C', 'C' };
+
+	// Entries are written in the machine's byte order, as they never leave it
+	class EntryWriter
+	{
+	public:
+		template <typename T>
+		void
+		write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written directly");
+			myData.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		void
+		write(const std::vector<T>& values)
+		{
+			write(static_cast<uint32_t>(values.size()));
+			myData.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+		}
+
+		void
+		write(const std::string& value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			myData.append(value);
+		}
+
+		void
+		write(const std::wstring& value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			myData.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(wchar_t));
+		}
+
+		const std::string&
+		getData() const
+		{
+			return myData;
+		}
+	private:
+		std::string	myData;
+	};
+
+	// Reads fail, and keep failing, once the data runs out
+	class EntryReader
+	{
+	public:
+		EntryReader(const unsigned char* data, size_t size)
+			: myPosition(data), myEnd(data + size)
+		{
+		}
+
+		template <typename T>
+		bool
+		read(T& value)
+		{
+			return readBytes(&value, sizeof(T));
+		}
+
+		// A damaged file could hold any value, so fail for those outside first to last
+		template <typename T>
+		bool
+		read(T& value, T first, T last)
+		{
+			if (read(value) && (value < first || value > last))
+			{
+				myFailed = true;
+			}
+			return !myFailed;
+		}
+
+		bool
+		read(bool& value)
+		{
+			uint8_t byte = 0;
+			if (read(byte, uint8_t(0), uint8_t(1)))
+			{
+				value = byte != 0;
+			}
+			return !myFailed;
+		}
+
+		template <typename T>
+		bool
+		read(std::vector<T>& values, T first, T last)
+		{
+			if (read(values))
+			{
+				for (const T& value : values)
+				{
+					if (value < first || value > last)
+					{
+						myFailed = true;
+						break;
+					}
+				}
+			}
+			return !myFailed;
+		}
+
+		template <typename T>
+		bool
+		read(std::vector<T>& values)
+		{
+			uint32_t count = 0;
+			if (!read(count) || count > (myEnd - myPosition) / sizeof(T))
+			{
+				myFailed = true;
+				return false;
+			}
+			values.resize(count);
+			return readBytes(values.data(), count * sizeof(T));
+		}
+
+		bool
+		read(std::string& value)
+		{
+			std::vector<char> characters;
+			if (!read(characters))
+			{
+				return false;
+			}
+			value.assign(characters.begin(), characters.end());
+			return true;
+		}
+
+		bool
+		read(std::wstring& value)
+		{
+			std::vector<wchar_t> characters;
+			if (!read(characters))
+			{
+				return false;
+			}
+			value.assign(characters.begin(), characters.end());
+			return true;
+		}
+
+		bool
+		hasFailed() const
+		{
+			return myFailed;
+		}
+	private:
+		bool
+		readBytes(void* destination, size_t length)
+		{
+			if (myFailed || static_cast<size_t>(myEnd - myPosition) < length)
+			{
+				myFailed = true;
+				return false;
+			}
+			if (length > 0)
+			{
+				memcpy(destination, myPosition, length);
+			}
+			myPosition += length;
+			return true;
+		}
+
+		const unsigned char*	myPosition;
+		const unsigned char*	myEnd;
+		bool					myFailed{ false };
+	};
+
+	constexpr uint64_t Prime1 = 11400714785074694791ULL;
+	constexpr uint64_t Prime2 = 14029467366897019727ULL;
+	constexpr uint64_t Prime3 = 1609587929392839161ULL;
+	constexpr uint64_t Prime4 = 9650029242287828579ULL;
+	constexpr uint64_t Prime5 = 2870177450012600261ULL;
+
+	uint64_t
+	rotate(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	uint64_t
+	mix(uint64_t accumulator, uint64_t input)
+	{
+		return rotate(accumulator + input * Prime2, 31) * Prime1;
+	}
+
+	uint64_t
+	load64(const unsigned char* data)
+	{
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint32_t
+	load32(const unsigned char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+}
+
+bool
+ComponentCache::Link::isSameLink(const Link& other) const
+{
+	return identifier == other.identifier &&
+		group == other.group &&
+		type == other.type &&
+		scope == other.scope &&
+		count == other.count &&
+		intent == other.intent;
+}
+
+ComponentCache::ComponentCache(const std::wstring& directory)
+	: myDirectory(directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(myDirectory, error);
+}
+
+bool
+ComponentCache::getKey(const std::wstring& path, uint64_t& key)
+{
+	TRACE_SCOPE("ComponentCache::getKey");
+	FileReader file(path);
+	if (!file.isOpen())
+	{
+		return false;
+	}
+	uint64_t size = file.getSize();
+	if (size == 0)
+	{
+		key = hash(nullptr, 0);
+		return true;
+	}
+	// Mapped rather than read, so a large component is hashed without a copy
+	const unsigned char* data = file.map();
+	if (!data)
+	{
+		return false;
+	}
+	key = hash(data, static_cast<size_t>(size));
+	return true;
+}
+
+uint64_t
+ComponentCache::hash(const void* data, size_t length)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	const unsigned char* end = p + length;
+	uint64_t h;
+	if (length >= 32)
+	{
+		// Four independent lanes, so the multiplies overlap
+		uint64_t lanes[4] = { Prime1 + Prime2, Prime2, 0, 0 - Prime1 };
+		for (; end - p >= 32; p += 32)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				lanes[i] = mix(lanes[i], load64(p + i * 8));
+			}
+		}
+		h = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+		for (uint64_t lane : lanes)
+		{
+			h = (h ^ mix(0, lane)) * Prime1 + Prime4;
+		}
+	}
+	else
+	{
+		h = Prime5;
+	}
+	h += length;
+
+	for (; end - p >= 8; p += 8)
+	{
+		h = rotate(h ^ mix(0, load64(p)), 27) * Prime1 + Prime4;
+	}
+	if (end - p >= 4)
+	{
+		h = rotate(h ^ (load32(p) * Prime1), 23) * Prime2 + Prime3;
+		p += 4;
+	}
+	for (; p < end; p++)
+	{
+		h = rotate(h ^ (*p * Prime5), 11) * Prime1;
+	}
+
+	h ^= h >> 33;
+	h *= Prime2;
+	h ^= h >> 29;
+	h *= Prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+bool
+ComponentCache::find(uint64_t key, Entry& entry) const
+{
+	TRACE_SCOPE("ComponentCache::find");
+	std::vector<unsigned char> data;
+	if (!FileReader(getPath(key).wstring()).read(data))
+	{
+		return false;
+	}
+
+	EntryReader reader(data.data(), data.size());
+	char magic[sizeof(Magic)];
+	uint32_t version = 0;
+	uint64_t storedKey = 0;
+	if (!reader.read(magic) || memcmp(magic, Magic, sizeof(Magic)) != 0 ||
+		!reader.read(version) || version != FormatVersion ||
+		!reader.read(storedKey) || storedKey != key)
+	{
+		return false;
+	}
+
+	uint32_t linkCount = 0;
+	reader.read(linkCount);
+	entry.links.clear();
+	for (uint32_t i = 0; i < linkCount && !reader.hasFailed(); i++)
+	{
+		Link link;
+		reader.read(link.identifier);
+		reader.read(link.group);
+		reader.read(link.type, TELinkTypeGroup, TELinkTypeSeparator);
+		reader.read(link.scope, TEScopeInput, TEScopeOutput);
+		reader.read(link.count, 0, INT32_MAX);
+		reader.read(link.intent, TELinkIntentNotSpecified, TELinkIntentPulse);
+		reader.read(link.defaults);
+		reader.read(link.defaultString);
+		entry.links.push_back(std::move(link));
+	}
+	reader.read(entry.deviceName);
+	reader.read(entry.engineVersion);
+	reader.read(entry.hasCapabilities);
+	reader.read(entry.capabilities.textureTypes, TETextureTypeOpenGL, TETextureTypeMetal);
+#ifdef _WIN32
+	reader.read(entry.capabilities.d3dHandleTypes, static_cast<int32_t>(TED3DHandleTypeD3D11Global), static_cast<int32_t>(TED3DHandleTypeD3D12ResourceNT));
+#else
+	reader.read(entry.capabilities.d3dHandleTypes);
+#endif
+	reader.read(entry.capabilities.semaphoreTypes, TESemaphoreTypeVulkan, TESemaphoreTypeD3DFence);
+	reader.read(entry.capabilities.textureFormats, TETextureFormatInvalid, TETextureFormatBC7SRGBUnorm);
+	reader.read(entry.capabilities.keyedMutexReleaseToZero);
+	reader.read(entry.capabilities.openGLTextures);
+	return !reader.hasFailed();
+}
+
+bool
+ComponentCache::store(uint64_t key, const Entry& entry) const
+{
+	TRACE_SCOPE("ComponentCache::store");
+	EntryWriter writer;
+	writer.write(Magic);
+	writer.write(FormatVersion);
+	writer.write(key);
+	writer.write(static_cast<uint32_t>(entry.links.size()));
+	for (const auto& link : entry.links)
+	{
+		writer.write(link.identifier);
+		writer.write(link.group);
+		writer.write(link.type);
+		writer.write(link.scope);
+		writer.write(link.count);
+		writer.write(link.intent);
+		writer.write(link.defaults);
+		writer.write(link.defaultString);
+	}
+	writer.write(entry.deviceName);
+	writer.write(entry.engineVersion);
+	writer.write(entry.hasCapabilities);
+	writer.write(entry.capabilities.textureTypes);
+	writer.write(entry.capabilities.d3dHandleTypes);
+	writer.write(entry.capabilities.semaphoreTypes);
+	writer.write(entry.capabilities.textureFormats);
+	writer.write(entry.capabilities.keyedMutexReleaseToZero);
+	writer.write(entry.capabilities.openGLTextures);
+
+	// Written aside and renamed into place, so other processes never see a partial entry
+	static std::atomic<uint32_t> theCount{ 0 };
+	std::filesystem::path path = getPath(key);
+	std::filesystem::path temporary = path;
+	temporary += "." + std::to_string(std::random_device()()) + "." + std::to_string(theCount++) + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(writer.getData().data(), static_cast<std::streamsize>(writer.getData().size()));
+		if (!file.good())
+		{
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+std::filesystem::path
+ComponentCache::getPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.tecache", static_cast<unsigned long long>(key));
+	return myDirectory / name;
+}
@@ -0,0 +1,83 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "InstanceCapabilities.h"
+
+/*
+* Remembers what was learned loading a component - its link tree, input defaults and the instance's
+* capabilities - keyed by a hash of the component file's contents, so the next load of the same file can
+* build its layout before the instance finishes loading, and configure without querying the instance.
+*
+* Entries are kept as a file each in a directory, so they persist between runs. The cache only saves time:
+* the instance remains the authority, and its layout replaces a cached one which turns out to differ.
+*/
+class ComponentCache
+{
+public:
+	struct Link
+	{
+		std::string		identifier;
+		// The identifier of the link group containing the link
+		std::string		group;
+		TELinkType		type;
+		TEScope			scope;
+		int32_t			count;
+		TELinkIntent	intent;
+		// TELinkValueDefault of double, int and boolean inputs
+		std::vector<double>	defaults{};
+		// TELinkValueDefault of string inputs
+		std::string		defaultString{};
+
+		// Compares everything but the defaults
+		bool	isSameLink(const Link& other) const;
+	};
+
+	struct Entry
+	{
+		std::vector<Link>		links;
+		// The Renderer device and TouchEngine the capabilities were queried with, as they only hold for those
+		std::wstring			deviceName;
+		std::string				engineVersion;
+		bool					hasCapabilities = false;
+		InstanceCapabilities	capabilities;
+	};
+
+	// Entries are kept in directory, which is created if necessary
+	explicit ComponentCache(const std::wstring& directory);
+
+	// Hashes the contents of the file at path, returning false if it can't be read
+	static bool		getKey(const std::wstring& path, uint64_t& key);
+	// 64-bit, after xxHash64
+	static uint64_t	hash(const void* data, size_t length);
+
+	// Returns false if there is no entry for key or it can't be read
+	bool	find(uint64_t key, Entry& entry) const;
+	bool	store(uint64_t key, const Entry& entry) const;
+private:
+	// Increase whenever the layout of entry files changes, so old files are ignored
+	static constexpr uint32_t FormatVersion{ 3 };
+
+	std::filesystem::path	getPath(uint64_t key) const;
+
+	std::filesystem::path	myDirectory;
+};
@@ -16,6 +16,7 @@
 #include "DX11Device.h"
 #include "FileReader.h"
 #include "DXGIUtility.h"
+#include "Trace.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -214,9 +215,9 @@ DX11Device::loadIndexBuffer(unsigned short * indices, int count)
 }
 
 DX11Texture
-DX11Device::loadTexture(const unsigned char * src, int bytesPerRow, int width, int height)
+DX11Device::loadTexture(const unsigned char * src, int bytesPerRow, int width, int height, PixelFormat format)
 {
-	return DX11Texture(*this, src, bytesPerRow, width, height, true);
+	return DX11Texture(*this, src, bytesPerRow, width, height, format, true);
 }
 
 void
@@ -235,6 +236,7 @@ DX11Device::clear(float r, float g, float b, float a)
 void
 DX11Device::present()
 {
+	TRACE_SCOPE("DX11Device::present");
 	mySwapChain->Present(1, 0);
 }
 
@@ -47,7 +47,7 @@ public:
 		return loadBuffer(sizeof(T), D3D11_BIND_CONSTANT_BUFFER, nullptr);
 	}
 
-	DX11Texture	loadTexture(const unsigned char *src, int bytesPerRow, int width, int height);
+	DX11Texture	loadTexture(const unsigned char *src, int bytesPerRow, int width, int height, PixelFormat format = PixelFormat::BGRA8);
 	void			setRenderTarget();
 	void			clear(float r, float g, float b, float a);
 	void			present();
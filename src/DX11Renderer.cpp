@@ -14,6 +14,8 @@
 
 #include "stdafx.h"
 #include "DX11Renderer.h"
+#include "DXGIUtility.h"
+#include "Trace.h"
 #include <TouchEngine/TouchEngine.h>
 #include <TouchEngine/TED3D11.h>
 #include <array>
@@ -71,10 +73,16 @@ DX11Renderer::setup(HWND window)
 	return SUCCEEDED(result);
 }
 
-bool DX11Renderer::configure(TEInstance* instance, std::wstring& error)
+void DX11Renderer::getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities)
 {
-	myReleaseToZero = TEInstanceRequiresKeyedMutexReleaseToZero(instance);
-	return true;
+	Renderer::getCapabilities(instance, capabilities);
+	capabilities.keyedMutexReleaseToZero = TEInstanceRequiresKeyedMutexReleaseToZero(instance);
+}
+
+bool DX11Renderer::configure(const InstanceCapabilities& capabilities, std::wstring& error)
+{
+	myReleaseToZero = capabilities.keyedMutexReleaseToZero;
+	return Renderer::configure(capabilities, error);
 }
 
 void
@@ -97,6 +105,7 @@ DX11Renderer::stop()
 bool
 DX11Renderer::render()
 { 
+	TRACE_SCOPE("DX11Renderer::render");
 	myDevice.setRenderTarget();
 	myDevice.clear(myBackgroundColor[0], myBackgroundColor[1], myBackgroundColor[2], 1.0f);
 
@@ -112,22 +121,41 @@ DX11Renderer::render()
 	return true;
 }
 
+bool
+DX11Renderer::supportsUploadFormat(PixelFormat format) const
+{
+	UINT support = 0;
+	DXGI_FORMAT dxgiFormat = DXGIUtility::getFormat(format);
+	// Input textures are created with mipmaps generated from the image
+	return dxgiFormat != DXGI_FORMAT_UNKNOWN && SUCCEEDED(myDevice.getDevice()->CheckFormatSupport(dxgiFormat, &support)) &&
+		(support & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN) != 0;
+}
+
 void
-DX11Renderer::addInputImage(const unsigned char* rgba, size_t bytesPerRow, int width, int height)
+DX11Renderer::createInputImage(const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
 {
-	DX11Texture texture = myDevice.loadTexture(rgba, int32_t(bytesPerRow), width, height);
+	TRACE_SCOPE("DX11Renderer::createInputImage");
+	DX11Texture texture = myDevice.loadTexture(pixels, int32_t(bytesPerRow), width, height, format);
 
 	myInputImages.emplace_back(texture);
 	myInputImages.back().setup(myDevice);
-	Renderer::addInputImage(rgba, bytesPerRow, width, height);
+}
+
+void
+DX11Renderer::uploadInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	TRACE_SCOPE("DX11Renderer::uploadInputImage");
+	// A new texture rather than updating the old one, which TouchEngine may not have finished copying
+	myInputImages[index].update(myDevice.loadTexture(pixels, int32_t(bytesPerRow), width, height, format));
 }
 
 bool DX11Renderer::getInputImage(size_t index, TouchObject<TETexture> & texture, TouchObject<TESemaphore> & semaphore, uint64_t & waitValue)
 {
+	TRACE_SCOPE("DX11Renderer::getInputImage");
 	if (inputDidChange(index))
 	{
 		auto& source = myInputImages[index];
-		texture.take(TED3D11TextureCreate(source.getTexture().getTexture(), TETextureOriginTopLeft, kTETextureComponentMapIdentity, nullptr, nullptr));
+		texture.take(TRACE_TE(TED3D11TextureCreate, source.getTexture().getTexture(), TETextureOriginTopLeft, kTETextureComponentMapIdentity, nullptr, nullptr));
 
 		// The TED3D11Context handles sync for us, so we needn't set semaphore or waitValue
 
@@ -155,6 +183,7 @@ DX11Renderer::addOutputImage()
 
 bool DX11Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier)
 {
+	TRACE_SCOPE("DX11Renderer::updateOutputImage");
 	bool success = false;
 	TEResult result = TEResultSuccess;
 	const auto& previous = getOutputImage(index);
@@ -178,12 +207,12 @@ bool DX11Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, si
 		myOutputImages[index].getTexture().release(waitValue);
 
 		// DXGI Keyed Mutexes use the texture as the sync object, so `semaphore` is nullptr
-		result = TEInstanceAddTextureTransfer(instance, previous, nullptr, waitValue);
+		result = TRACE_TE(TEInstanceAddTextureTransfer, instance, previous, nullptr, waitValue);
 	}
 	TouchObject<TETexture> texture;
 	if (result == TEResultSuccess)
 	{
-		result = TEInstanceLinkGetTextureValue(instance, identifier.c_str(), TELinkValueCurrent, texture.take());
+		result = TRACE_TE(TEInstanceLinkGetTextureValue, instance, identifier.c_str(), TELinkValueCurrent, texture.take());
 	}
 	if (result == TEResultSuccess)
 	{
@@ -192,7 +221,7 @@ bool DX11Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, si
 		if (texture && TETextureGetType(texture) == TETextureTypeD3DShared)
 		{
 			TouchObject<TED3D11Texture> created;
-			if (TED3D11ContextGetTexture(myContext, static_cast<TED3DSharedTexture*>(texture.get()), created.take()) == TEResultSuccess)
+			if (TRACE_TE(TED3D11ContextGetTexture, myContext, static_cast<TED3DSharedTexture*>(texture.get()), created.take()) == TEResultSuccess)
 			{
 				DX11Texture tex(created);
 
@@ -200,12 +229,12 @@ bool DX11Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, si
 
 				success = true;
 
-				if (texture && TEInstanceHasTextureTransfer(instance, texture))
+				if (texture && TRACE_TE(TEInstanceHasTextureTransfer, instance, texture))
 				{
 					TouchObject<TESemaphore> semaphore;
 					uint64_t waitValue = 0;
 					// DXGI Keyed Mutexes will be used for sync, so semaphore will be null on return
-					result = TEInstanceGetTextureTransfer(instance, texture, semaphore.take(), &waitValue);
+					result = TRACE_TE(TEInstanceGetTextureTransfer, instance, texture, semaphore.take(), &waitValue);
 
 					if (result == TEResultSuccess)
 					{
@@ -33,7 +33,8 @@ public:
 	}
 
 	virtual bool	setup(HWND window) override;
-	virtual bool	configure(TEInstance* instance, std::wstring& error) override;
+	virtual void	getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities) override;
+	virtual bool	configure(const InstanceCapabilities& capabilities, std::wstring& error) override;
 	virtual void	resize(int width, int height) override;
 	virtual void	stop() override;
 	virtual bool	render() override;
@@ -43,7 +44,6 @@ public:
 	{
 		return myInputImages.size();
 	}
-	virtual void		addInputImage(const unsigned char *rgba, size_t bytesPerRow, int width, int height) override;
 	virtual bool		getInputImage(size_t index, TouchObject<TETexture>& texture, TouchObject<TESemaphore>& semaphore, uint64_t& waitValue) override;
 	virtual void		clearInputImages() override;
 	virtual void		addOutputImage() override;
@@ -57,6 +57,10 @@ public:
 	}
 
 	virtual const std::wstring& getDeviceName() const override;
+protected:
+	virtual bool		supportsUploadFormat(PixelFormat format) const override;
+	virtual void		createInputImage(const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void		uploadInputImage(size_t index, const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
 private:
 	void		drawImages(std::vector<DX11Image> &images, float scale, float xOffset);
 
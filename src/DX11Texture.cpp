@@ -15,6 +15,8 @@
 #include "stdafx.h"
 #include "DX11Texture.h"
 #include "DX11Device.h"
+#include "DXGIUtility.h"
+#include "Trace.h"
 #include <TouchEngine/TED3D11.h>
 
 DX11Texture::DX11Texture()
@@ -75,6 +77,7 @@ DX11Texture::getFlipped() const
 
 void DX11Texture::acquire(uint64_t value)
 {
+	TRACE_SCOPE("DX11Texture::acquire");
 	myKeyedMutex->AcquireSync(value, INFINITE);
 	myLastAcquireValue = value;
 }
@@ -130,7 +133,7 @@ DX11Texture::releaseResources()
 	mySource.reset();
 }
 
-DX11Texture::DX11Texture(DX11Device &device, const unsigned char * src, int bytesPerRow, int width, int height, bool automips)
+DX11Texture::DX11Texture(DX11Device &device, const unsigned char * src, int bytesPerRow, int width, int height, PixelFormat format, bool automips)
 {
 	D3D11_SUBRESOURCE_DATA subresource = { 0 };
 	subresource.pSysMem = src;
@@ -140,7 +143,7 @@ DX11Texture::DX11Texture(DX11Device &device, const unsigned char * src, int byte
 	D3D11_TEXTURE2D_DESC description = { 0 };
 	description.Width = width;
 	description.Height = height;
-	description.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	description.Format = DXGIUtility::getFormat(format);
 	description.Usage = D3D11_USAGE_DEFAULT;
 	description.CPUAccessFlags = 0;
 	description.MiscFlags = 0;
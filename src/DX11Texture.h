@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <TouchEngine/TouchObject.h>
+#include "PixelFormat.h"
 
 class DX11Device;
 
@@ -23,7 +24,7 @@ class DX11Texture
 {
 public:
 	DX11Texture();
-	DX11Texture(DX11Device &device, const unsigned char *src, int bytesPerRow, int width, int height, bool genMips = false);
+	DX11Texture(DX11Device &device, const unsigned char *src, int bytesPerRow, int width, int height, PixelFormat format = PixelFormat::BGRA8, bool genMips = false);
 	DX11Texture(const TouchObject<TED3D11Texture> &texture);
 
 	ID3D11Texture2D*	getTexture() const;
@@ -27,6 +27,7 @@
 #include "DX12Renderer.h"
 #include "DX12Utility.h"
 #include "DXGIUtility.h"
+#include "Trace.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -262,53 +263,60 @@ bool DX12Renderer::setup(HWND window)
     return true;
 }
 
-bool DX12Renderer::configure(TEInstance* instance, std::wstring & error)
+void DX12Renderer::getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities)
 {
+    Renderer::getCapabilities(instance, capabilities);
     int32_t count = 0;
     TEResult result = TEInstanceGetSupportedTextureTypes(instance, nullptr, &count);
     if (result == TEResultInsufficientMemory)
     {
-        std::vector<TETextureType> textureTypes(count);
-        result = TEInstanceGetSupportedTextureTypes(instance, textureTypes.data(), &count);
-        if (result == TEResultSuccess)
+        capabilities.textureTypes.resize(count);
+        result = TEInstanceGetSupportedTextureTypes(instance, capabilities.textureTypes.data(), &count);
+        capabilities.textureTypes.resize(result == TEResultSuccess ? count : 0);
+    }
+    auto& textureTypes = capabilities.textureTypes;
+    if (std::find(textureTypes.begin(), textureTypes.end(), TETextureTypeD3DShared) != textureTypes.end())
+    {
+        result = TEInstanceGetSupportedD3DHandleTypes(instance, nullptr, &count);
+        if (result == TEResultInsufficientMemory)
         {
-            textureTypes.resize(count);
-            if (std::find(textureTypes.begin(), textureTypes.end(), TETextureTypeD3DShared) != textureTypes.end())
+            std::vector<TED3DHandleType> handleTypes(count);
+            result = TEInstanceGetSupportedD3DHandleTypes(instance, handleTypes.data(), &count);
+            if (result == TEResultSuccess)
             {
-                result = TEInstanceGetSupportedD3DHandleTypes(instance, nullptr, &count);
-                if (result == TEResultInsufficientMemory)
-                {
-                    std::vector<TED3DHandleType> handleTypes(count);
-                    result = TEInstanceGetSupportedD3DHandleTypes(instance, handleTypes.data(), &count);
-                    if (result == TEResultSuccess)
-                    {
-                        handleTypes.resize(count);
-                        if (std::find(handleTypes.begin(), handleTypes.end(), TED3DHandleTypeD3D12ResourceNT) == handleTypes.end())
-                        {
-                            error = getConfigureError();
-                            return false;
-                        }
-                    }
-                }
+                capabilities.d3dHandleTypes.assign(handleTypes.begin(), handleTypes.begin() + count);
             }
         }
     }
     result = TEInstanceGetSupportedSemaphoreTypes(instance, nullptr, &count);
     if (result == TEResultInsufficientMemory)
     {
-        std::vector<TESemaphoreType> semaphoreTypes(count);
-        result = TEInstanceGetSupportedSemaphoreTypes(instance, semaphoreTypes.data(), &count);
-        if (result == TEResultSuccess)
-        {
-            semaphoreTypes.resize(count);
-            if (std::find(semaphoreTypes.begin(), semaphoreTypes.end(), TESemaphoreTypeD3DFence) == semaphoreTypes.end())
-            {
-                error = getConfigureError();
-                return false;
-            }
-        }
+        capabilities.semaphoreTypes.resize(count);
+        result = TEInstanceGetSupportedSemaphoreTypes(instance, capabilities.semaphoreTypes.data(), &count);
+        capabilities.semaphoreTypes.resize(result == TEResultSuccess ? count : 0);
     }
-    return true;
+}
+
+bool DX12Renderer::configure(const InstanceCapabilities& capabilities, std::wstring & error)
+{
+    // Types the instance didn't report aren't held against it
+    const auto& textureTypes = capabilities.textureTypes;
+    const auto& handleTypes = capabilities.d3dHandleTypes;
+    if (std::find(textureTypes.begin(), textureTypes.end(), TETextureTypeD3DShared) != textureTypes.end() &&
+        !handleTypes.empty() &&
+        std::find(handleTypes.begin(), handleTypes.end(), TED3DHandleTypeD3D12ResourceNT) == handleTypes.end())
+    {
+        error = getConfigureError();
+        return false;
+    }
+    const auto& semaphoreTypes = capabilities.semaphoreTypes;
+    if (!semaphoreTypes.empty() &&
+        std::find(semaphoreTypes.begin(), semaphoreTypes.end(), TESemaphoreTypeD3DFence) == semaphoreTypes.end())
+    {
+        error = getConfigureError();
+        return false;
+    }
+    return Renderer::configure(capabilities, error);
 }
 
 bool DX12Renderer::doesInputTextureTransfer() const
@@ -356,11 +364,15 @@ void DX12Renderer::stop()
 
 bool DX12Renderer::render()
 {
+    TRACE_SCOPE("DX12Renderer::render");
     populateRenderCommandList();
 
     executeCommandList();
 
-    mySwapChain->Present(1, 0);
+    {
+        TRACE_SCOPE("DX12Renderer::present");
+        mySwapChain->Present(1, 0);
+    }
 
     waitForGPU();
 
@@ -384,14 +396,23 @@ void DX12Renderer::beginImageLayout()
     beginCommandList(nullptr);
 }
 
-void DX12Renderer::addInputImage(const unsigned char* rgba, size_t bytesPerRow, int width, int height)
+bool DX12Renderer::supportsUploadFormat(PixelFormat format) const
+{
+    D3D12_FEATURE_DATA_FORMAT_SUPPORT support = { DXGIUtility::getFormat(format) };
+    return support.Format != DXGI_FORMAT_UNKNOWN &&
+        SUCCEEDED(myDevice->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT, &support, sizeof(support))) &&
+        (support.Support1 & D3D12_FORMAT_SUPPORT1_SHADER_SAMPLE) != 0;
+}
+
+void DX12Renderer::createInputImage(const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
 {
-	myInputImages.emplace_back(DX12Texture(myDevice.Get(), myCommandList.Get(), rgba, bytesPerRow, width, height));
-    Renderer::addInputImage(rgba, bytesPerRow, width, height);
+    TRACE_SCOPE("DX12Renderer::createInputImage");
+    myInputImages.emplace_back(DX12Texture(myDevice.Get(), myCommandList.Get(), pixels, bytesPerRow, width, height, format));
 }
 
 bool DX12Renderer::getInputImage(size_t index, TouchObject<TETexture> & texture, TouchObject<TESemaphore> & semaphore, uint64_t & waitValue)
 {
+    TRACE_SCOPE("DX12Renderer::getInputImage");
     if (inputDidChange(index))
     {
         texture.set(myInputImages[index].getTexture().getTETexture());
@@ -418,6 +439,29 @@ void DX12Renderer::addOutputImage()
 }
 
 void DX12Renderer::endImageLayout()
+{
+    completeUploads();
+}
+
+void DX12Renderer::beginInputImageUpload()
+{
+    beginCommandList(nullptr);
+}
+
+void DX12Renderer::uploadInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+    TRACE_SCOPE("DX12Renderer::uploadInputImage");
+    // A new texture rather than overwriting the one the instance may still be reading
+    DX12Texture texture(myDevice.Get(), myCommandList.Get(), pixels, bytesPerRow, width, height, format);
+    myInputImages[index].update(texture);
+}
+
+void DX12Renderer::endInputImageUpload()
+{
+    completeUploads();
+}
+
+void DX12Renderer::completeUploads()
 {
     myCommandList->Close();
 
@@ -436,18 +480,19 @@ void DX12Renderer::endImageLayout()
 
 bool DX12Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier)
 {
+    TRACE_SCOPE("DX12Renderer::updateOutputImage");
     bool success = false;
     const auto& previous = getOutputImage(index);
     TEResult result = TEResultSuccess;
     if (previous)
     {
-        result = TEInstanceAddTextureTransfer(instance, previous, myTEFence, myCompletedFenceValue);
+        result = TRACE_TE(TEInstanceAddTextureTransfer, instance, previous, myTEFence, myCompletedFenceValue);
     }
     TouchObject<TETexture> texture;
 
     if (result == TEResultSuccess)
     {
-        result = TEInstanceLinkGetTextureValue(instance, identifier.c_str(), TELinkValueCurrent, texture.take());
+        result = TRACE_TE(TEInstanceLinkGetTextureValue, instance, identifier.c_str(), TELinkValueCurrent, texture.take());
     }
     if (result == TEResultSuccess)
     {
@@ -464,16 +509,16 @@ bool DX12Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, si
                 // TouchEngine's callbacks allow us to delete our cached texture when the original is deleted
                 it = myOutputTextures.insert(std::make_pair(h, DX12Texture(myDevice.Get(), shared))).first;
 
-                TED3DSharedTextureSetCallback(shared, textureCallback, this);
+                TRACE_TE(TED3DSharedTextureSetCallback, shared, textureCallback, this);
             }
             myOutputImages[index].update(it->second);
             success = true;
 
-            if (texture && TEInstanceHasTextureTransfer(instance, texture))
+            if (texture && TRACE_TE(TEInstanceHasTextureTransfer, instance, texture))
             {
                 TouchObject<TESemaphore> semaphore;
                 uint64_t waitValue = 0;
-                result = TEInstanceGetTextureTransfer(instance, texture, semaphore.take(), &waitValue);
+                result = TRACE_TE(TEInstanceGetTextureTransfer, instance, texture, semaphore.take(), &waitValue);
 
                 if (result == TEResultSuccess)
                 {
@@ -492,7 +537,7 @@ bool DX12Renderer::updateOutputImage(const TouchObject<TEInstance>& instance, si
 
                             it = myOutputFences.insert(std::make_pair(handle, fence)).first;
 
-                            TED3DSharedFenceSetCallback(static_cast<TED3DSharedFence*>(semaphore.get()), fenceCallback, this);
+                            TRACE_TE(TED3DSharedFenceSetCallback, static_cast<TED3DSharedFence*>(semaphore.get()), fenceCallback, this);
                         }
 
                         myCommandQueue->Wait(it->second.Get(), waitValue);
@@ -537,6 +582,7 @@ const std::wstring& DX12Renderer::getDeviceName() const
 
 void DX12Renderer::waitForGPU()
 {
+    TRACE_SCOPE("DX12Renderer::waitForGPU");
     if (myCompletedFenceValue < myNextFenceValue)
     {
         myCommandQueue->Signal(myFence.Get(), myNextFenceValue);
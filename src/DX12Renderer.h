@@ -26,7 +26,8 @@ public:
 						DX12Renderer();
 	virtual				~DX12Renderer();
 	virtual bool		setup(HWND window) override;
-	virtual bool		configure(TEInstance* instance, std::wstring & error) override;
+	virtual void		getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities) override;
+	virtual bool		configure(const InstanceCapabilities& capabilities, std::wstring & error) override;
 	virtual bool		doesInputTextureTransfer() const override;
 	virtual void		resize(int width, int height) override;
 	virtual void		stop() override;
@@ -37,7 +38,6 @@ public:
 	virtual size_t		getInputImageCount() const override;
 
 	virtual void		beginImageLayout() override;
-	virtual void		addInputImage(const unsigned char* rgba, size_t bytesPerRow, int width, int height) override;
 	virtual bool		getInputImage(size_t index, TouchObject<TETexture>& texture, TouchObject<TESemaphore>& semaphore, uint64_t& waitValue) override;
 	virtual void		clearInputImages() override;
 	virtual void		addOutputImage() override;
@@ -49,8 +49,15 @@ public:
 	virtual TEGraphicsContext* getTEContext() const override;
 
 	virtual const std::wstring& getDeviceName() const override;
+protected:
+	virtual bool		supportsUploadFormat(PixelFormat format) const override;
+	virtual void		createInputImage(const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void		beginInputImageUpload() override;
+	virtual void		uploadInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void		endInputImageUpload() override;
 private:
 	static const UINT FrameCount = 2;
+	void				completeUploads();
 	void				waitForGPU();
 	void				beginCommandList(ID3D12PipelineState* state);
 	void				populateRenderCommandList();
@@ -15,6 +15,7 @@
 #include "stdafx.h"
 #include "DX12Texture.h"
 #include "DX12Utility.h"
+#include "DXGIUtility.h"
 #include <TouchEngine/TED3D12.h>
 
 using Microsoft::WRL::ComPtr;
@@ -23,13 +24,13 @@ DX12Texture::DX12Texture()
 {
 }
 
-DX12Texture::DX12Texture(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const unsigned char* src, size_t bytesPerRow, int width, int height, bool genMips)
+DX12Texture::DX12Texture(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const unsigned char* src, size_t bytesPerRow, int width, int height, PixelFormat format, bool genMips)
 	: myWidth(width), myHeight(height), myDevice(device)
 {
 	D3D12_RESOURCE_DESC textureDesc = {};
 
 	textureDesc.MipLevels = 1;
-	textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	textureDesc.Format = DXGIUtility::getFormat(format);
 	textureDesc.Width = width;
 	textureDesc.Height = height;
 	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
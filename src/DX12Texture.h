@@ -16,12 +16,13 @@
 
 #include <d3d12.h>
 #include <TouchEngine/TouchObject.h>
+#include "PixelFormat.h"
 
 class DX12Texture
 {
 public:
 	DX12Texture();
-	DX12Texture(ID3D12Device *device, ID3D12GraphicsCommandList *commandList, const unsigned char* src, size_t bytesPerRow, int width, int height, bool genMips = false);
+	DX12Texture(ID3D12Device *device, ID3D12GraphicsCommandList *commandList, const unsigned char* src, size_t bytesPerRow, int width, int height, PixelFormat format = PixelFormat::BGRA8, bool genMips = false);
 	DX12Texture(ID3D12Device* device, TED3DSharedTexture *texture);
 
 	void				uploadDidComplete();
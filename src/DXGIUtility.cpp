@@ -89,6 +89,29 @@ void DXGIUtility::setDX12()
     myIs12 = true;
 }
 
+DXGI_FORMAT DXGIUtility::getFormat(PixelFormat format)
+{
+    switch (format)
+    {
+    case PixelFormat::BGRA8:
+        return DXGI_FORMAT_B8G8R8A8_UNORM;
+    case PixelFormat::RGBA8:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case PixelFormat::R8:
+        return DXGI_FORMAT_R8_UNORM;
+    case PixelFormat::RGBA16:
+        return DXGI_FORMAT_R16G16B16A16_UNORM;
+    case PixelFormat::RGBA16F:
+        return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    case PixelFormat::RGBA32F:
+        return DXGI_FORMAT_R32G32B32A32_FLOAT;
+    case PixelFormat::RGB10A2:
+        return DXGI_FORMAT_R10G10B10A2_UNORM;
+    default:
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
 HRESULT DXGIUtility::test(IDXGIAdapter1* adapter)
 {
     if (myIs12)
@@ -14,9 +14,13 @@
 
 #pragma once
 
+#include "PixelFormat.h"
+
 class DXGIUtility
 {
 public:
+    // DXGI_FORMAT_UNKNOWN for a format with no texture format
+    static DXGI_FORMAT getFormat(PixelFormat format);
 	Microsoft::WRL::ComPtr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory1* pFactory, std::wstring& description, bool requestHighPerformanceAdapter = false);
 	void setDX11();
 	void setDX12();
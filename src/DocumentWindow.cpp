@@ -19,8 +19,15 @@
 #include "DX11Renderer.h"
 #include "DX12Renderer.h"
 #include "OpenGLRenderer.h"
+#include "NullRenderer.h"
+#include "InstanceHost.h"
 #include "Strings.h"
+#include "FileReader.h"
+#include "CSVLoader.h"
+#include "Trace.h"
 #include <codecvt>
+#include <fstream>
+#include <algorithm>
 #include <array>
 
 const wchar_t *DocumentWindow::WindowClassName = L"DocumentWindow";
@@ -28,9 +35,16 @@ const int32_t DocumentWindow::InputChannelCount = 2;
 const double DocumentWindow::InputSampleRate = 44100.0;
 const int64_t DocumentWindow::InputSampleLimit = 44100 / 2;
 const int64_t DocumentWindow::InputSamplesPerFrame = 44100 / 60;
-const UINT_PTR DocumentWindow::UpdateTimerID = 1;
 
 static std::shared_ptr<DocumentWindow> theOpenDocument;
+static std::unique_ptr<RunLoop> theRunLoop;
+// Created when first used, runs instances opened with "Open Many Headless"
+static std::unique_ptr<InstanceHost> theHost;
+// Created when first used, shared by every instance
+static std::shared_ptr<ComponentCache> theComponentCache;
+// Created when first used, shared by every instance to draw test patterns and parse tables
+static std::unique_ptr<WorkerPool> theWorkers;
+static std::shared_ptr<TestPatternCache> theTestPatterns;
 
 #define MAX_LOADSTRING 100
 
@@ -47,6 +61,10 @@ BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    About(HWND, UINT, WPARAM, LPARAM);
 std::shared_ptr<DocumentWindow>   Open(HWND, DocumentWindow::Mode mode);
+std::shared_ptr<ComponentCache>   GetComponentCache();
+std::shared_ptr<TestPatternCache> GetTestPatterns();
+void                OpenMany(HWND);
+void                SaveTrace(HWND);
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 	_In_opt_ HINSTANCE hPrevInstance,
@@ -70,6 +88,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
 	HACCEL hAccelTable = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDC_TETESTHOST));
 
+	Trace::setThreadName("Main");
+	theRunLoop = RunLoop::create();
+
 	MSG msg;
 
 	// Main message loop:
@@ -86,8 +107,32 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 				DispatchMessage(&msg);
 			}
 		}
+		else if (theOpenDocument)
+		{
+			// Sleep until a message arrives, the instance wakes us, or it's nearly time for the next frame
+			int64_t wait = theOpenDocument->getWaitTime();
+			RunLoop::Wake wake = wait > 0 ? theRunLoop->wait(wait) : RunLoop::Wake::Timeout;
+			if (wake == RunLoop::Wake::Signal)
+			{
+				theOpenDocument->update();
+			}
+			else if (wake == RunLoop::Wake::Timeout)
+			{
+				theOpenDocument->pace();
+			}
+		}
+		else
+		{
+			theRunLoop->wait(RunLoop::Infinite);
+		}
 	}
 
+	theHost.reset();
+	theOpenDocument.reset();
+	theTestPatterns.reset();
+	theWorkers.reset();
+	theRunLoop.reset();
+
 	return (int)msg.wParam;
 }
 
@@ -190,6 +235,15 @@ WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		case ID_FILE_OPENOPENGL:
 			theOpenDocument = Open(hWnd, DocumentWindow::Mode::OpenGL);
 			break;
+		case ID_FILE_OPEN_HEADLESS:
+			theOpenDocument = Open(hWnd, DocumentWindow::Mode::Headless);
+			break;
+		case ID_FILE_OPEN_HOST:
+			OpenMany(hWnd);
+			break;
+		case ID_FILE_SAVE_TRACE:
+			SaveTrace(hWnd);
+			break;
 		default:
 			return DefWindowProc(hWnd, message, wParam, lParam);
 		}
@@ -252,7 +306,7 @@ Open(HWND hWnd, DocumentWindow::Mode mode)
 	BOOL result = GetOpenFileName(&ofns);
 	if (result)
 	{
-		std::shared_ptr<DocumentWindow> win(std::make_shared<DocumentWindow>(buffer, mode));
+		std::shared_ptr<DocumentWindow> win(std::make_shared<DocumentWindow>(buffer, mode, theRunLoop.get()));
 		win->openWindow(hWnd);
 
 		return win;
@@ -260,6 +314,119 @@ Open(HWND hWnd, DocumentWindow::Mode mode)
 	return std::shared_ptr<DocumentWindow>();
 }
 
+std::shared_ptr<ComponentCache>
+GetComponentCache()
+{
+	if (!theComponentCache)
+	{
+		// In the temporary directory, as entries are only an optimization and can always be rebuilt
+		WCHAR buffer[MAX_PATH + 1];
+		DWORD length = GetTempPathW(MAX_PATH + 1, buffer);
+		std::wstring directory(buffer, length > 0 && length <= MAX_PATH ? length : 0);
+		theComponentCache = std::make_shared<ComponentCache>(directory + L"TouchEngineExample\\ComponentCache");
+	}
+	return theComponentCache;
+}
+
+std::shared_ptr<TestPatternCache>
+GetTestPatterns()
+{
+	if (!theTestPatterns)
+	{
+		theWorkers = std::make_unique<WorkerPool>();
+		theTestPatterns = std::make_shared<TestPatternCache>(theWorkers.get());
+	}
+	return theTestPatterns;
+}
+
+void
+OpenMany(HWND hWnd)
+{
+	// Multiple selections are returned as the directory followed by each file name, all null-terminated
+	std::vector<WCHAR> buffer(32 * 1024, 0);
+	OPENFILENAME ofns = { 0 };
+	ofns.lStructSize = sizeof(OPENFILENAME);
+	ofns.lpstrFile = buffer.data();
+	ofns.nMaxFile = static_cast<DWORD>(buffer.size());
+	ofns.lpstrTitle = L"Select files to open";
+	ofns.lpstrFilter = _T("All Files\0*.*\0TouchDesigner Components\0*.TOX\0");
+	ofns.nFilterIndex = 2;
+	ofns.Flags = OFN_ALLOWMULTISELECT | OFN_EXPLORER;
+	if (!GetOpenFileName(&ofns))
+	{
+		return;
+	}
+
+	std::vector<std::wstring> paths;
+	std::wstring directory = buffer.data();
+	for (const WCHAR* name = buffer.data() + directory.size() + 1; *name; name += wcslen(name) + 1)
+	{
+		paths.push_back(directory + L"\\" + name);
+	}
+	if (paths.empty())
+	{
+		// A single selection is returned as the full path
+		paths.push_back(directory);
+	}
+
+	if (!theHost)
+	{
+		theHost = std::make_unique<InstanceHost>();
+		theHost->setComponentCache(GetComponentCache());
+		theHost->setTestPatterns(GetTestPatterns());
+	}
+
+	std::wstring failed;
+	for (const auto& path : paths)
+	{
+		if (theHost->add(ConvertToMultiByte(path), 60, 1) != TEResultSuccess)
+		{
+			failed += path + L"\n";
+		}
+	}
+	if (!failed.empty())
+	{
+		std::wstring message = L"These files could not be opened:\n" + failed;
+		MessageBox(hWnd, message.c_str(), L"Error", MB_OK | MB_ICONERROR);
+	}
+}
+
+
+void
+SaveTrace(HWND hWnd)
+{
+	if (!Trace::isEnabled())
+	{
+		MessageBox(hWnd, L"Tracing is not compiled in to this build. Define TOUCHENGINE_TRACE to enable it.", L"Error", MB_OK | MB_ICONERROR);
+		return;
+	}
+
+	WCHAR buffer[MAX_PATH] = L"trace.json";
+	OPENFILENAME ofns = { 0 };
+	ofns.lStructSize = sizeof(OPENFILENAME);
+	ofns.lpstrFile = buffer;
+	ofns.nMaxFile = MAX_PATH;
+	ofns.lpstrTitle = L"Save trace as";
+	ofns.lpstrFilter = _T("All Files\0*.*\0Chrome Trace\0*.JSON\0");
+	ofns.nFilterIndex = 2;
+	ofns.lpstrDefExt = L"json";
+	ofns.Flags = OFN_OVERWRITEPROMPT;
+	if (!GetSaveFileName(&ofns))
+	{
+		return;
+	}
+
+	// Open in chrome://tracing or https://ui.perfetto.dev
+	std::ofstream file(buffer, std::ios::binary | std::ios::trunc);
+	if (file)
+	{
+		Trace::write(file);
+	}
+	if (!file)
+	{
+		MessageBox(hWnd, L"The trace could not be saved.", L"Error", MB_OK | MB_ICONERROR);
+	}
+}
 
 HRESULT
 DocumentWindow::registerClass(HINSTANCE hInstance)
@@ -299,7 +466,6 @@ DocumentWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	{
 	case WM_CLOSE:
 	{
-		KillTimer(hWnd, UpdateTimerID);
 		HMENU menu = GetMenu(hWnd);
 		if (menu)
 		{
@@ -327,205 +493,160 @@ DocumentWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		}
 		break;
 	}
-	case WM_TIMER:
-	{
-		if (wParam == UpdateTimerID)
-		{
-			if (theOpenDocument)
-			{
-				theOpenDocument->update();
-			}
-		}
-
-		break;
-	}
 	default:
 		return DefWindowProc(hWnd, message, wParam, lParam);
 	}
 	return LRESULT();
 }
 
-void DocumentWindow::didConfigure(TEResult result)
-{
-	// Configuration can be cancelled by a subsequent configuration or other action
-	// - we can ignore the event in that case and await a following one
-	if (result != TEResultCancelled)
-	{
-		std::lock_guard<std::mutex> guard(myMutex);
-		myConfigureRenderer = true;
-		myConfigureResult = result;
-	}
-}
-
-void
-DocumentWindow::eventCallback(TEInstance * instance,
-									TEEvent event,
-									TEResult result,
-									int64_t start_time_value,
-									int32_t start_time_scale,
-									int64_t end_time_value,
-									int32_t end_time_scale,
-									void * info)
+DocumentWindow::DocumentWindow(std::wstring path, Mode mode, RunLoop* runLoop)
+	: myPath(path), myMode(mode)
 {
-	DocumentWindow *window = static_cast<DocumentWindow *>(info);
-
-	switch (event)
+	switch (mode)
 	{
-	case TEEventInstanceReady:
-		window->didConfigure(result);
-		break;
-	case TEEventInstanceDidLoad:
-		window->didLoad();
-		break;
-	case TEEventInstanceDidUnload:
+	case Mode::DirectX11:
+		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<DX11Renderer>());
 		break;
-	case TEEventFrameDidFinish:
-		window->endFrame(start_time_value, start_time_scale, result);
+	case Mode::DirectX12:
+		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<DX12Renderer>());
 		break;
-	case TEEventGeneral:
-		// TODO: check result here
+	case Mode::Headless:
+		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<NullRenderer>());
 		break;
 	default:
+		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<OpenGLRenderer>());
 		break;
 	}
-}
+	// OpenGL's origin is bottom-left
+	myController = std::make_unique<InstanceController>(*myRenderer, runLoop, mode == Mode::OpenGL);
+	myController->setFrameRate(FramesPerSecond, 1);
+	// Components opened before start faster, see ComponentCache
+	myController->setComponentCache(GetComponentCache());
+	myController->setTestPatterns(GetTestPatterns());
 
-void
-DocumentWindow::linkEventCallback(TEInstance * instance, TELinkEvent event, const char *identifier, void * info)
-{
-	DocumentWindow* doc = static_cast<DocumentWindow*>(info);
-	switch (event)
+	// Other outputs are read once a second, their interest is lowered between reads
+	// Float buffers are analyzed every frame, on our worker
+	myController->subscribe(TELinkTypeFloatBuffer, 1, [this](TEInstance* instance, const LinkLayout::Link& link) { analyzeOutput(instance, link); });
+	myController->subscribe(TELinkTypeStringData, FramesPerSecond, [this](TEInstance* instance, const LinkLayout::Link& link) { readOutputValue(instance, link); });
+
+	// Float buffer inputs receive audio - from a WAV file alongside the component if there is one, otherwise a tone
+	std::wstring wavPath = myPath.substr(0, myPath.find_last_of(L'.')) + L".wav";
+	std::vector<unsigned char> wav;
+	std::vector<float> samples;
+	double rate = InputSampleRate;
+	bool haveFile = FileReader(wavPath).read(wav) && AudioInput::decodeWAV(wav.data(), wav.size(), InputChannelCount, rate, samples);
+
+	auto audio = std::make_shared<AudioInput>(rate, InputChannelCount, static_cast<uint32_t>(InputSampleLimit));
+	if (haveFile)
 	{
-	case TELinkEventAdded:
-		doc->linkLayoutDidChange();
-		break;
-	case TELinkEventValueChange:
-		doc->linkValueChange(identifier);
-		break;
-	default:
-		break;
+		audio->start(AudioInput::makeLoop(std::move(samples), InputChannelCount), static_cast<uint32_t>(InputSamplesPerFrame * 3));
 	}
-}
-
-void
-DocumentWindow::linkValueChange(const char* identifier)
-{
-	TouchObject<TELinkInfo> link;
-	TEResult result = TEInstanceLinkGetInfo(myInstance, identifier, link.take());
-	if (result == TEResultSuccess && link->scope == TEScopeOutput)
+	else
 	{
-		switch (link->type)
-		{
-		case TELinkTypeTexture:
-		{
-			// Stash the state, we don't do any actual renderer work from this thread
-			std::lock_guard<std::mutex> guard(myMutex);
-			myPendingOutputTextures.push_back(identifier);
-			break;
-		}
-		case TELinkTypeFloatBuffer:
-		{
-			TouchObject<TEFloatBuffer> buffer;
-			result = TEInstanceLinkGetFloatBufferValue(myInstance, identifier, TELinkValueCurrent, buffer.take());
+		audio->start(AudioInput::makeTone(rate, InputChannelCount, 440.0, 0.25f), static_cast<uint32_t>(InputSamplesPerFrame * 3));
+	}
+	myController->setAudioInput(audio);
 
-			if (result == TEResultSuccess)
-			{
-				uint32_t valueCount = TEFloatBufferGetValueCount(buffer);
-				int32_t channelCount = TEFloatBufferGetChannelCount(buffer);
-				if (buffer && channelCount > 0 && valueCount > 0)
-				{
-					const float * const *data = TEFloatBufferGetValues(buffer);
-
-					for (int channel = 0; channel < channelCount; channel++)
-					{
-						// Here we just grab the first sample in the channel
-						float value = data[channel][0];
-					}
-				}
-			}
-			break;
-		}
-		case TELinkTypeStringData:
+	// String data inputs receive a table from a CSV or TSV file alongside the component, if there is one
+	for (const wchar_t* extension : { L".csv", L".tsv" })
+	{
+		std::wstring tablePath = myPath.substr(0, myPath.find_last_of(L'.')) + extension;
+		if (FileReader(tablePath).isOpen())
 		{
-			TouchObject<TEObject> value;
-			result = TEInstanceLinkGetObjectValue(myInstance, identifier, TELinkValueCurrent, value.take());
-			// String data can be a TETable or TEString, so check the type
-			if (value && TEGetType(value) == TEObjectTypeTable)
-			{
-				TouchObject<TETable> table;
-				table.set(static_cast<TETable*>(value.get()));
-				// do something with the table
-			}
-			else if (value && TEGetType(value) == TEObjectTypeString)
-			{
-				TouchObject<TEString> string;
-				string.set(static_cast<TEString*>(value.get()));
-				// do something with the string
-			}
-			break;
-		}
-		default:
+			loadTable(tablePath);
 			break;
 		}
 	}
 }
 
 void
-DocumentWindow::endFrame(int64_t time_value, int32_t time_scale, TEResult result)
+DocumentWindow::loadTable(const std::wstring& path)
 {
-	setInFrame(false);
+	// Large files take a while, so the file is parsed and the model filled on a worker rather than the thread running frames
+	// - the model isn't shared until takeLoadedTable() picks it up
+	myTableWorkers.submit([this, path]
+		{
+			CSVLoader loader(path, theWorkers.get());
+			CSVTable table;
+			if (!loader.load(table))
+			{
+				return;
+			}
+			auto model = std::make_shared<TableModel>();
+			table.fill(*model);
+
+			std::lock_guard<std::mutex> guard(myTableMutex);
+			myLoadedTable = std::move(model);
+		});
 }
 
 void
-DocumentWindow::getState(bool& configured, bool& loaded, bool& linksChanged, bool& inFrame)
+DocumentWindow::takeLoadedTable()
 {
-	std::lock_guard<std::mutex> guard(myMutex);
-	configured = myConfigureRenderer;
-	myConfigureRenderer = false;
-	loaded = myDidLoad;
-	if (myDidLoad)
+	std::shared_ptr<TableModel> table;
 	{
-		// For this example, we are only interested in links after load has completed
-		linksChanged = myPendingLayoutChange;
-		inFrame = myInFrame;
-		myPendingLayoutChange = false;
+		std::lock_guard<std::mutex> guard(myTableMutex);
+		table = std::move(myLoadedTable);
 	}
-	else
+	if (table)
 	{
-		linksChanged = false;
-		inFrame = false;
+		myController->setTableInput(std::string(), std::move(table));
 	}
 }
 
-void
-DocumentWindow::setInFrame(bool inFrame)
-{
-	std::lock_guard<std::mutex> guard(myMutex);
-	myInFrame = inFrame;
-}
 
-DocumentWindow::DocumentWindow(std::wstring path, Mode mode)
-	: myPath(path), myMode(mode)
+void
+DocumentWindow::readOutputValue(TEInstance* instance, const LinkLayout::Link& link)
 {
-	switch (mode)
+	const char* identifier = link.identifier.c_str();
+	switch (link.type)
 	{
-	case Mode::DirectX11:
-		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<DX11Renderer>());
-		break;
-	case Mode::DirectX12:
-		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<DX12Renderer>());
+	case TELinkTypeStringData:
+	{
+		TouchObject<TEObject> value;
+		TEResult result = TRACE_TE(TEInstanceLinkGetObjectValue, instance, identifier, TELinkValueCurrent, value.take());
+		// String data can be a TETable or TEString, so check the type
+		if (value && TEGetType(value) == TEObjectTypeTable)
+		{
+			TouchObject<TETable> table;
+			table.set(static_cast<TETable*>(value.get()));
+			// Decoded in one pass - scan the snapshot's columns rather than the table
+			myTableOutputs[link.identifier].update(table);
+		}
+		else if (value && TEGetType(value) == TEObjectTypeString)
+		{
+			TouchObject<TEString> string;
+			string.set(static_cast<TEString*>(value.get()));
+			// do something with the string
+		}
 		break;
+	}
 	default:
-		myRenderer = static_cast<std::unique_ptr<Renderer>>(std::make_unique<OpenGLRenderer>());
 		break;
 	}
 }
 
+void
+DocumentWindow::analyzeOutput(TEInstance* instance, const LinkLayout::Link& link)
+{
+	TouchObject<TEFloatBuffer> buffer;
+	TEResult result = TRACE_TE(TEInstanceLinkGetFloatBufferValue, instance, link.identifier.c_str(), TELinkValueCurrent, buffer.take());
+	if (result == TEResultSuccess && buffer)
+	{
+		auto& analyzer = myAnalyzers[link.identifier];
+		if (!analyzer)
+		{
+			analyzer = std::make_unique<FloatBufferAnalyzer>(myAnalysisWorkers);
+		}
+		// Values are copied here, the analysis happens on our worker - see getSnapshot() for the results
+		analyzer->submit(buffer);
+	}
+}
 
 DocumentWindow::~DocumentWindow()
 {
 	// Do this first so releated resources our Renderer may be interested in are released
-	myInstance.reset();
+	myController.reset();
 
 	myRenderer->stop();
 
@@ -557,6 +678,9 @@ DocumentWindow::openWindow(HWND parent)
 	case Mode::DirectX12:
 		title += L" (DirectX 12 - ";
 		break;
+	case Mode::Headless:
+		title += L" (";
+		break;
 	default:
 		title += L" (OpenGL - ";
 		break;
@@ -597,41 +721,18 @@ DocumentWindow::openWindow(HWND parent)
 	}
 	if (SUCCEEDED(result))
 	{
-		std::string utf8 = ConvertToMultiByte(getPath());
-		
-		if (utf8.empty())
+		std::string utf8;
+		// Our conversion doesn't set the last error, so report the only way it fails
+		if (!ConvertToMultiByte(getPath(), utf8))
 		{
-			result = HRESULT_FROM_WIN32(GetLastError());
+			result = HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION);
 		}
 
 		if (SUCCEEDED(result))
 		{
-			TEResult teresult = TEInstanceCreate(eventCallback, linkEventCallback, this, myInstance.take());
-			if (teresult == TEResultSuccess)
-			{
-				teresult = TEInstanceAssociateGraphicsContext(myInstance, myRenderer->getTEContext());
-			}
-			if (teresult == TEResultSuccess)
-			{
-				teresult = TEInstanceConfigure(myInstance, utf8.c_str(), TETimeExternal);
-			}
-			if (teresult == TEResultSuccess)
-			{
-				teresult = TEInstanceSetFrameRate(myInstance, FramesPerSecond, 1);
-			}
-			if (teresult == TEResultSuccess)
-			{
-				teresult = TEInstanceLoad(myInstance);
-			}
-			if (teresult == TEResultSuccess)
-			{
-				teresult = TEInstanceResume(myInstance);
-			}
+			myLabel = utf8;
+			TEResult teresult = myController->load(utf8);
 			assert(teresult == TEResultSuccess);
-
-			const auto interval = static_cast<UINT>(std::ceil(1000. / FramesPerSecond / 2.));
-
-			SetTimer(myWindow, UpdateTimerID, interval, nullptr);
 		}
 
 		// Draw once
@@ -640,25 +741,36 @@ DocumentWindow::openWindow(HWND parent)
 }
 
 void
-DocumentWindow::linkLayoutDidChange()
+DocumentWindow::pace()
 {
-	std::lock_guard<std::mutex> guard(myMutex);
-	myPendingLayoutChange = true;    
+	takeLoadedTable();
+	if (myController->pace())
+	{
+		render(myController->isLoaded());
+	}
+}
+
+int64_t
+DocumentWindow::getWaitTime() const
+{
+	return myController->getWaitTime();
 }
 
 void
 DocumentWindow::update()
 {
-	bool configured, loaded, linksChanged, inFrame;
-	getState(configured, loaded, linksChanged, inFrame);
+	TRACE_SCOPE("DocumentWindow::update");
+	takeLoadedTable();
+	bool changed = myController->update();
 
-	if (configured)
+	TEResult result;
+	std::wstring message;
+	if (myController->takeConfigureError(result, message))
 	{
-		std::wstring message;
-		if (TEResultGetSeverity(myConfigureResult) == TESeverityError)
-		{			
-			const char *description = TEResultGetDescription(myConfigureResult);
-			
+		if (TEResultGetSeverity(result) == TESeverityError)
+		{
+			const char *description = TEResultGetDescription(result);
+
 			message = L"There was an error configuring TouchEngine: ";
 			if (description)
 			{
@@ -666,331 +778,59 @@ DocumentWindow::update()
 			}
 			else
 			{
-				message += std::to_wstring(myConfigureResult);
+				message += std::to_wstring(result);
 			}
-			
-			myConfigureError = true;
-		}
-		else
-		{
-			myConfigureError = !myRenderer->configure(myInstance, message);
-		}
-		if (myConfigureError)
-		{
-			MessageBox(myWindow, message.c_str(), L"Error", MB_OK | MB_ICONERROR);
-			SendMessage(myWindow, WM_CLOSE, 0, 0);
 		}
-	}
-
-	if (myConfigureError)
-	{
+		MessageBox(myWindow, message.c_str(), L"Error", MB_OK | MB_ICONERROR);
+		SendMessage(myWindow, WM_CLOSE, 0, 0);
 		return;
 	}
 
-	bool changed = linksChanged;
-
-	// Make any pending renderer state updates
-	if (linksChanged)
+	if (changed)
 	{
-		applyLayoutChange();
+		render(myController->isLoaded());
 	}
 
-	if (loaded && !inFrame)
+	if (myStatisticsExporter.poll(myController->getStatistics(), myLabel))
 	{
-		changed = changed || applyOutputTextureChange();
-
-		// Examples of setting input links
-		TouchObject<TEStringArray> groups;
-		TEResult result = TEInstanceGetLinkGroups(myInstance, TEScopeInput, groups.take());
-		if (result == TEResultSuccess)
+		const auto& buffers = myController->getInputObjects().getFloatBufferStatistics();
+		const auto& tables = myController->getInputObjects().getTableStatistics();
+		myStatisticsOutput << myLabel << ": pooled input float buffers " << buffers.hits << "/" << buffers.requests << " hits, " << buffers.live << " live, "
+			<< "tables " << tables.hits << "/" << tables.requests << " hits, " << tables.live << " live\n";
+		// Totals since the instance loaded
+		const auto& frames = myController->getFrameStatistics();
+		double inFlight = frames.started ? static_cast<double>(frames.inFlightSum) / frames.started : 0.0;
+		double latency = frames.finished ? std::chrono::duration<double, std::milli>(frames.latencySum).count() / frames.finished : 0.0;
+		myStatisticsOutput << myLabel << ": frames " << frames.started << " started, " << frames.finished << " finished, " << frames.unmatched << " unmatched, "
+			<< "in flight mean " << inFlight << " already at each start, max " << frames.maxInFlight << ", latency mean " << latency << "ms\n";
+		for (const auto& analyzer : myAnalyzers)
 		{
-			int textureCount = 0;
-			for (int32_t i = 0; i < groups->count; i++)
+			auto snapshot = analyzer.second->getSnapshot();
+			if (snapshot && !snapshot->channels.empty())
 			{
-				TouchObject<TEStringArray> children;
-				result = TEInstanceLinkGetChildren(myInstance, groups->strings[i], children.take());
-				if (result == TEResultSuccess)
-				{
-					for (int32_t j = 0; j < children->count; j++)
-					{
-						TouchObject<TELinkInfo> info;
-						result = TEInstanceLinkGetInfo(myInstance, children->strings[j], info.take());
-						if (result == TEResultSuccess)
-						{
-							switch (info->type)
-							{
-							case TELinkTypeDouble:
-							{
-								double d = fmod(myLastFloatValue, 1.0);
-								result = TEInstanceLinkSetDoubleValue(myInstance, info->identifier, &d, 1);
-								break;
-							}
-							case TELinkTypeInt:
-							{
-								int v = static_cast<int>(myLastFloatValue * 100) % 100;
-								result = TEInstanceLinkSetIntValue(myInstance, info->identifier, &v, 1);
-								break;
-							}
-							case TELinkTypeString:
-								result = TEInstanceLinkSetStringValue(myInstance, info->identifier, "test input");
-								break;
-							case TELinkTypeTexture:
-							{
-								TouchObject<TETexture> texture;
-								TouchObject<TESemaphore> semaphore;
-								uint64_t waitValue = 0;
-								// Our OpenGL and D3D11 renderers use their TEGraphicsContexts to handle setting inputs, meaning they needn't do any sync themselves
-								// - but at the cost of a texture copy by the TEGraphicsContext
-								// Our D3D12 renderer creates shareable textures, so it must handle sync itself - when setting a texture we uses a texture transfer
-								// to supply a fence and wait-value to the instance - the instance will insert a wait for the fence prior to consuming the input texture
-								if (myRenderer->getInputImage(textureCount, texture, semaphore, waitValue))
-								{
-									result = TEInstanceLinkSetTextureValue(myInstance, info->identifier, texture, myRenderer->getTEContext());
-									if (result == TEResultSuccess && myRenderer->doesInputTextureTransfer())
-									{
-										result = TEInstanceAddTextureTransfer(myInstance, texture, semaphore, waitValue);
-									}
-								}
-								textureCount++;
-								break;
-							}
-							case TELinkTypeFloatBuffer:
-							{
-								TouchObject<TEFloatBuffer> buffer;
-								// Creating a copy of an existing buffer is more efficient than creating a new one every time
-								result = TEInstanceLinkGetFloatBufferValue(myInstance, info->identifier, TELinkValueCurrent, buffer.take());
-								if (result == TEResultSuccess)
-								{
-									// You might want to check more properties of the buffer than this
-									if (buffer && TEFloatBufferGetCapacity(buffer) < 1 || TEFloatBufferGetChannelCount(buffer) != 2)
-									{
-										buffer.reset();
-									}
-									if (buffer)
-									{
-										TouchObject<TEFloatBuffer> copied;
-										copied.take(TEFloatBufferCreateCopy(buffer));
-										buffer = copied;
-									}
-									else
-									{
-										// Two channels, capacity of one sample per channel, no channel names
-										// This buffer is not time-dependent, see TEFloatBuffer.h for handling time-dependent samples such
-										// as audio.
-										buffer.take(TEFloatBufferCreate(-1, 2, 1, nullptr));
-									}
-									float value = static_cast<float>(fmod(myLastFloatValue, 1.0));
-									std::array<const float*, 2> channels{ &value, &value };
-									TEFloatBufferSetValues(buffer, channels.data(), 1);
-
-									result = TEInstanceLinkSetFloatBufferValue(myInstance, info->identifier, buffer);
-								}
-								break;
-							}
-							case TELinkTypeStringData:
-							{
-								// String data can be either tabular, in which case set a TETable, or a single string - here we set a table
-								// (use TEInstanceLinkSetStringValue() to set a string value)
-
-								// It is more efficient to create a copy of an existing table than to create a new one, so check
-								// for an existing table to re-use first.
-								TouchObject<TEObject> value;
-								result = TEInstanceLinkGetObjectValue(myInstance, info->identifier, TELinkValueCurrent, value.take());
-
-								if (result == TEResultSuccess)
-								{
-									TouchObject<TETable> table ;
-									if (value && TEGetType(value) == TEObjectTypeTable)
-									{
-										table.take(TETableCreateCopy(static_cast<TETable*>(value.get())));
-									}
-									else
-									{
-										table.take(TETableCreate());
-									}
-									TETableResize(table, 3, 2);
-									for (int column = 0; column < 2; column++)
-									{
-										for (int row = 0; row < 3; row++)
-										{
-											TETableSetStringValue(table, row, column, "test");
-										}
-									}
-									result = TEInstanceLinkSetTableValue(myInstance, info->identifier, table);
-								}
-								break;
-							}
-							default:
-								break;
-							}
-						}
-					}
-				}
+				auto loudest = std::max_element(snapshot->channels.begin(), snapshot->channels.end(), [](const auto& a, const auto& b) { return a.peakHold < b.peakHold; });
+				myStatisticsOutput << myLabel << ": " << analyzer.first << " " << snapshot->channels.size() << " channels, held peak " << loudest->peakHold << "\n";
 			}
 		}
-
-		setInFrame(true);
-
-		int64_t time = getRenderTime();
-		myLastResult = TEInstanceStartFrameAtTime(myInstance, time, TimeRate, false);
-		if (myLastResult == TEResultSuccess)
-		{
-			myLastFloatValue += 1.0 / (60.0 * 8.0);
-		}
-		else
-		{
-			setInFrame(false);
-		}
-	}
-	if (changed)
-	{
-		render(loaded);
+		OutputDebugStringA(myStatisticsOutput.str().c_str());
+		myStatisticsOutput.str("");
 	}
 }
 
 void
 DocumentWindow::render(bool loaded)
 {
+	TRACE_SCOPE("DocumentWindow::render");
 	float color[4] = { loaded ? 0.6f : 0.6f, loaded ? 0.6f : 0.6f, loaded ? 1.0f : 0.6f, 1.0f };
 
-	if (myLastResult != TEResultSuccess)
+	if (myController->getLastResult() != TEResultSuccess)
 	{
 		color[0] = 1.0f;
 		color[1] = color[2] = 0.2f;
 	}
 
+	StatisticsCollector::Timer timer(&myController->getStatistics(), StatisticsCollector::Metric::Render);
 	myRenderer->setBackgroundColor(color[0], color[1], color[2]);
 	myRenderer->render();
 }
 
-void
-DocumentWindow::applyLayoutChange()
-{
-	myRenderer->beginImageLayout();
-
-	myRenderer->clearInputImages();
-	myRenderer->clearOutputImages();
-	myOutputLinkTextureMap.clear();
-
-	for (auto scope : { TEScopeInput, TEScopeOutput })
-	{
-		TouchObject<TEStringArray> groups;
-		TEResult result = TEInstanceGetLinkGroups(myInstance, scope, groups.take());
-		if (result == TEResultSuccess)
-		{
-			for (int32_t i = 0; i < groups->count; i++)
-			{
-				TouchObject<TELinkInfo> group;
-				result = TEInstanceLinkGetInfo(myInstance, groups->strings[i], group.take());
-				if (result == TEResultSuccess)
-				{
-					// Use group info here
-				}
-				TouchObject<TEStringArray> children;
-				if (result == TEResultSuccess)
-				{
-					result = TEInstanceLinkGetChildren(myInstance, groups->strings[i], children.take());
-				}
-				if (result == TEResultSuccess)
-				{
-					for (int32_t j = 0; j < children->count; j++)
-					{
-						TouchObject<TELinkInfo> info;
-						result = TEInstanceLinkGetInfo(myInstance, children->strings[j], info.take());
-						if (result == TEResultSuccess)
-						{
-							if (result == TEResultSuccess && info->type == TELinkTypeTexture)
-							{
-								if (scope == TEScopeInput)
-								{
-									std::vector<unsigned char> tex( ImageWidth * ImageHeight * 4 );
-
-									std::array<Gradient, 4> gradients{
-										Gradient{{0, 0, 0}, {255,0,255}},
-										Gradient{{100, 100, 100}, {255, 255, 0}},
-										Gradient{{40, 40, 40}, {255, 255, 255}},
-										Gradient{{255, 0, 0}, {255, 0, 255}}
-									};
-
-									const auto &gradient = gradients[myRenderer->getInputImageCount() % gradients.size()];
-									auto& start = gradient.start;
-									auto& end = gradient.end;
-									for (size_t y = 0; y < ImageHeight; y++)
-									{
-										for (size_t x = 0; x < ImageWidth; x++)
-										{
-											double xColor = static_cast<double>(x) / (ImageWidth-1);
-											double yColor = static_cast<double>(y) / (ImageHeight-1);
-											if (getMode() == Mode::OpenGL)
-												yColor = 1.0 - yColor;
-											Color xColor1 = {
-												start.red + static_cast<int>(yColor * (static_cast<double>(end.red) - start.red)),
-												start.green + static_cast<int>(xColor * (static_cast<double>(end.green) - start.green)),
-												start.blue + static_cast<int>(xColor * (static_cast<double>(end.blue) - start.blue))
-											};
-											tex[(y * ImageWidth * 4) + (x * 4) + 0] = xColor1.blue;
-											tex[(y * ImageWidth * 4) + (x * 4) + 1] = xColor1.green;
-											tex[(y * ImageWidth * 4) + (x * 4) + 2] = xColor1.red;
-											tex[(y * ImageWidth * 4) + (x * 4) + 3] = 255;
-										}
-									}
-									myRenderer->addInputImage(tex.data(), ImageWidth * 4, ImageWidth, ImageHeight);
-								}
-								else
-								{
-									myRenderer->addOutputImage();
-									myOutputLinkTextureMap[info->identifier] = myRenderer->getRightSideImageCount() - 1;
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	myRenderer->endImageLayout();
-}
-
-bool
-DocumentWindow::applyOutputTextureChange()
-{
-	// Only hold the lock briefly
-	std::vector<std::string> changes;
-	{
-		std::lock_guard<std::mutex> guard(myMutex);
-		std::swap(myPendingOutputTextures, changes);
-	}
-
-	for (const auto & identifier : changes)
-	{
-		size_t imageIndex = myOutputLinkTextureMap[identifier];
-
-		myRenderer->updateOutputImage(myInstance, imageIndex, identifier);
-	}
-
-	return !changes.empty();
-}
-
-int64_t
-DocumentWindow::getRenderTime()
-{
-	LARGE_INTEGER now{ 0 };
-
-	if (myStartTime.QuadPart == 0)
-	{
-		QueryPerformanceFrequency(&myPerformanceCounterFrequency);
-		QueryPerformanceCounter(&myStartTime);
-		now.QuadPart = 0;
-	}
-	else
-	{
-		QueryPerformanceCounter(&now);
-		now.QuadPart -= myStartTime.QuadPart;
-	}
-
-	now.QuadPart *= TimeRate;
-	now.QuadPart /= myPerformanceCounterFrequency.QuadPart;
-
-	return now.QuadPart;
-}
@@ -17,10 +17,17 @@
 #include <string>
 #include <map>
 #include <memory>
-#include <vector>
 #include <mutex>
+#include <vector>
+#include <sstream>
 #include <TouchEngine/TouchEngine.h>
 #include "Renderer.h"
+#include "InstanceController.h"
+#include "RunLoop.h"
+#include "StatisticsCollector.h"
+#include "FloatBufferAnalyzer.h"
+#include "TableSnapshot.h"
+#include "WorkerPool.h"
 
 class DocumentWindow
 {
@@ -28,17 +35,22 @@ public:
 	enum class Mode {
 		DirectX11,
 		DirectX12,
-		OpenGL
+		OpenGL,
+		Headless
 	};
 	static HRESULT registerClass(HINSTANCE hInstance);
 	static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
-	DocumentWindow(std::wstring path, Mode mode);
+	// runLoop, if not null, is woken whenever the instance has something for us to handle
+	DocumentWindow(std::wstring path, Mode mode, RunLoop* runLoop = nullptr);
 	~DocumentWindow();
 
 	const std::wstring		getPath() const;
 	void					openWindow(HWND parent);
-	void					linkLayoutDidChange();
 	void					update();
+	// Waits briefly for the next frame deadline, and calls update() if it has been reached
+	void					pace();
+	// How long the host may block before it should call pace() (nanoseconds)
+	int64_t					getWaitTime() const;
 	void					render(bool loaded);
 
 	Mode
@@ -52,77 +64,56 @@ public:
 	{
 		return myWindow;
 	}
-	void didConfigure(TEResult result);
-	void
-	didLoad()
+
+	const InstanceController&
+	getController() const
 	{
-		std::lock_guard<std::mutex> guard(myMutex);
-		myDidLoad = true;
+		return *myController;
 	}
 private:
 	static const wchar_t* WindowClassName;
-	static void		eventCallback(TEInstance * instance,
-								TEEvent event,
-								TEResult result,
-								int64_t start_time_value,
-								int32_t start_time_scale,
-								int64_t end_time_value,
-								int32_t end_time_scale,
-								void * info);
-
-	static void		linkEventCallback(TEInstance *instance, TELinkEvent event, const char *identifier, void *info);
+	// Consumes string data outputs, decoding tables into their TableSnapshot
+	void			readOutputValue(TEInstance* instance, const LinkLayout::Link& link);
+	// Hands float buffer outputs to their FloatBufferAnalyzer
+	void			analyzeOutput(TEInstance* instance, const LinkLayout::Link& link);
+	// Loads a CSV or TSV file for the string data inputs on myTableWorkers
+	void			loadTable(const std::wstring& path);
+	// Passes a table loadTable() has finished to myController, on the thread which updates it
+	void			takeLoadedTable();
 
 	static const double		 InputSampleRate;
 	static const int32_t	 InputChannelCount;
 	static const int64_t	 InputSampleLimit;
 	static const int64_t	 InputSamplesPerFrame;
-	static const UINT_PTR	 UpdateTimerID;
 	static constexpr int32_t FramesPerSecond{ 60 };
-	static constexpr int32_t TimeRate{ 6000 };
 	static constexpr UINT	 InitialWindowWidth{ 640 };
 	static constexpr UINT	 InitialWindowHeight{ 480 };
-
-	static constexpr size_t ImageWidth{ 256 };
-	static constexpr size_t ImageHeight{ 256 };
-
-	void	linkValueChange(const char* identifier);
-	void	endFrame(int64_t time_value, int32_t time_scale, TEResult result);
-	void	getState(bool& configured, bool& loaded, bool& linksChanged, bool& inFrame);
-	void	setInFrame(bool inFrame);
-	void	applyLayoutChange();
-	bool	applyOutputTextureChange();
-	int64_t	getRenderTime();
+	// How often statistics are written to the debugger output (nanoseconds)
+	static constexpr int64_t StatisticsInterval{ 10000000000 };
 
 	std::wstring				myPath;
 	Mode						myMode;
-	TouchObject<TEInstance>		myInstance;
 	HWND						myWindow{ 0 };
 
+	// Outlives myAnalyzers, which wait for their work to finish
+	WorkerPool					myAnalysisWorkers{ 1 };
+	// By output identifier
+	std::map<std::string, std::unique_ptr<FloatBufferAnalyzer>>	myAnalyzers;
+	// String data outputs holding tables, by output identifier
+	std::map<std::string, TableSnapshot>	myTableOutputs;
+
 	std::unique_ptr<Renderer>	myRenderer;
-	struct Color {
-		int red;
-		int green;
-		int blue;
-	};
-	struct Gradient {
-		Color start;
-		Color end;
-	};
+	// Holds a reference to myRenderer, so must be destroyed first
+	std::unique_ptr<InstanceController>	myController;
 
-	bool			myDidLoad{ false };
-	bool			myInFrame{ false };
-	bool			myConfigureRenderer{ false };
-	bool			myConfigureError{ false };
-	double			myLastFloatValue{ 0.0 };
-	TEResult		myLastResult{ TEResultSuccess };
-	std::mutex		myMutex;
-	LARGE_INTEGER	myStartTime{ 0 };
-	LARGE_INTEGER	myPerformanceCounterFrequency{ 1 };
+	std::mutex					myTableMutex;
+	std::shared_ptr<TableModel>	myLoadedTable;
+	// Destroyed before the members its task uses, waiting for the task to finish
+	WorkerPool					myTableWorkers{ 1 };
 
-	// TE link identifier to renderer index
-	std::map<std::string, size_t>	myOutputLinkTextureMap;
-	std::vector<std::string>		myPendingOutputTextures;
-	bool							myPendingLayoutChange{ false };
-	TEResult						myConfigureResult{ TEResultSuccess };
+	// Component path, to label statistics
+	std::string					myLabel;
+	std::ostringstream			myStatisticsOutput;
+	StatisticsExporter			myStatisticsExporter{ myStatisticsOutput, StatisticsExporter::Format::JSONLines, StatisticsInterval };
 };
 
@@ -0,0 +1,137 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* A bounded lock-free queue for many producer threads and a single consumer thread.
+*
+* Each slot carries a sequence number which tells producers and the consumer whose turn it is
+* (after Dmitry Vyukov's bounded MPMC queue). push() never blocks: when the queue is full it
+* fails and counts an overflow, and the caller must recover the lost event some other way.
+*/
+template <typename T, size_t Capacity>
+class EventQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+	EventQueue()
+	{
+		for (size_t i = 0; i < Capacity; i++)
+		{
+			myCells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	EventQueue(const EventQueue& o) = delete;
+	EventQueue& operator=(const EventQueue& o) = delete;
+
+	// May be called from any thread
+	bool
+	push(const T& value)
+	{
+		size_t position = myEnqueuePosition.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &myCells[position & (Capacity - 1)];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				if (myEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				myOverflowCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				position = myEnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		cell->value = value;
+		cell->sequence.store(position + 1, std::memory_order_release);
+
+		size_t depth = position + 1 - myDequeuePosition.load(std::memory_order_relaxed);
+		size_t highest = myHighWaterMark.load(std::memory_order_relaxed);
+		while (depth > highest && !myHighWaterMark.compare_exchange_weak(highest, depth, std::memory_order_relaxed))
+		{
+		}
+		return true;
+	}
+
+	// Must only be called from the consumer thread
+	bool
+	pop(T& value)
+	{
+		size_t position = myDequeuePosition.load(std::memory_order_relaxed);
+		Cell& cell = myCells[position & (Capacity - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+		{
+			return false;
+		}
+		value = cell.value;
+		cell.sequence.store(position + Capacity, std::memory_order_release);
+		myDequeuePosition.store(position + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Approximate while producers are active
+	size_t
+	getDepth() const
+	{
+		return myEnqueuePosition.load(std::memory_order_relaxed) - myDequeuePosition.load(std::memory_order_relaxed);
+	}
+
+	size_t
+	getHighWaterMark() const
+	{
+		return myHighWaterMark.load(std::memory_order_relaxed);
+	}
+
+	uint64_t
+	getOverflowCount() const
+	{
+		return myOverflowCount.load(std::memory_order_relaxed);
+	}
+
+	static constexpr size_t
+	getCapacity()
+	{
+		return Capacity;
+	}
+private:
+	struct Cell
+	{
+		std::atomic<size_t>	sequence;
+		T					value;
+	};
+
+	// Producer and consumer positions are kept on separate cache lines
+	alignas(64) std::atomic<size_t>	myEnqueuePosition{ 0 };
+	alignas(64) std::atomic<size_t>	myDequeuePosition{ 0 };
+	std::atomic<size_t>				myHighWaterMark{ 0 };
+	std::atomic<uint64_t>			myOverflowCount{ 0 };
+	alignas(64) std::array<Cell, Capacity>	myCells;
+};
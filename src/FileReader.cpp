@@ -12,9 +12,21 @@
 * prior written permission from Derivative.
 */
 
-#include "stdafx.h"
 #include "FileReader.h"
+#include <algorithm>
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Strings.h"
+#endif
 
+// Reads larger than this are split, as the platforms limit the size of a single read
+static constexpr size_t MaximumReadLength = 1 << 30;
+
+#ifdef _WIN32
 
 FileReader::FileReader(const std::wstring &path)
 	: myFile(INVALID_HANDLE_VALUE)
@@ -30,19 +42,35 @@ FileReader::FileReader(const std::wstring &path)
 	myFile = CreateFile2(path.data(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, &extended);
 }
 
+bool
+FileReader::isOpen() const
+{
+	return myFile != INVALID_HANDLE_VALUE;
+}
 
-FileReader::~FileReader()
+void
+FileReader::close()
 {
+	unmap();
+	if (myMapping)
+	{
+		CloseHandle(myMapping);
+		myMapping = nullptr;
+	}
 	if (myFile != INVALID_HANDLE_VALUE)
 	{
 		CloseHandle(myFile);
+		myFile = INVALID_HANDLE_VALUE;
 	}
 }
 
 FileReader::FileReader(FileReader && o)
-	: myFile(o.myFile)
+	: myFile(o.myFile), myMapping(o.myMapping), myView(o.myView), myViewLength(o.myViewLength)
 {
 	o.myFile = INVALID_HANDLE_VALUE;
+	o.myMapping = nullptr;
+	o.myView = nullptr;
+	o.myViewLength = 0;
 }
 
 FileReader&
@@ -50,32 +78,239 @@ FileReader::operator=(FileReader && o)
 {
 	if (&o != this)
 	{
-		if (myFile != INVALID_HANDLE_VALUE)
+		close();
+		myFile = o.myFile;
+		myMapping = o.myMapping;
+		myView = o.myView;
+		myViewLength = o.myViewLength;
+		o.myFile = INVALID_HANDLE_VALUE;
+		o.myMapping = nullptr;
+		o.myView = nullptr;
+		o.myViewLength = 0;
+	}
+	return *this;
+}
+
+bool
+FileReader::read(uint64_t offset, void *destination, size_t length) const
+{
+	unsigned char *position = static_cast<unsigned char *>(destination);
+	while (length > 0)
+	{
+		// An offset makes the read independent of the file pointer, so reads can overlap
+		OVERLAPPED overlapped = { 0 };
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD count = 0;
+		if (!ReadFile(myFile, position, static_cast<DWORD>((std::min)(length, MaximumReadLength)), &count, &overlapped) || count == 0)
+		{
+			return false;
+		}
+		position += count;
+		offset += count;
+		length -= count;
+	}
+	return true;
+}
+
+uint64_t
+FileReader::getSize() const
+{
+	LARGE_INTEGER size = { 0 };
+	if (!GetFileSizeEx(myFile, &size))
+	{
+		return 0;
+	}
+	return static_cast<uint64_t>(size.QuadPart);
+}
+
+const unsigned char *
+FileReader::map(uint64_t offset, size_t length)
+{
+	unmap();
+	if (length == 0 || offset + length > getSize())
+	{
+		return nullptr;
+	}
+	if (!myMapping)
+	{
+		myMapping = CreateFileMapping(myFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!myMapping)
 		{
-			CloseHandle(myFile);
+			return nullptr;
 		}
+	}
+
+	// Views must start at a multiple of the allocation granularity
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	uint64_t start = offset - offset % info.dwAllocationGranularity;
+	size_t lead = static_cast<size_t>(offset - start);
+	myView = MapViewOfFile(myMapping, FILE_MAP_READ, static_cast<DWORD>(start >> 32), static_cast<DWORD>(start & 0xFFFFFFFF), lead + length);
+	if (!myView)
+	{
+		return nullptr;
+	}
+	myViewLength = lead + length;
+	return static_cast<const unsigned char *>(myView) + lead;
+}
+
+void
+FileReader::unmap()
+{
+	if (myView)
+	{
+		UnmapViewOfFile(myView);
+		myView = nullptr;
+		myViewLength = 0;
+	}
+}
+
+#else
+
+FileReader::FileReader(const std::wstring &path)
+	: myFile(open(ConvertToMultiByte(path).c_str(), O_RDONLY | O_CLOEXEC))
+{
+	if (myFile >= 0)
+	{
+		posix_fadvise(myFile, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+}
+
+bool
+FileReader::isOpen() const
+{
+	return myFile >= 0;
+}
+
+void
+FileReader::close()
+{
+	unmap();
+	if (myFile >= 0)
+	{
+		::close(myFile);
+		myFile = -1;
+	}
+}
+
+FileReader::FileReader(FileReader && o)
+	: myFile(o.myFile), myView(o.myView), myViewLength(o.myViewLength)
+{
+	o.myFile = -1;
+	o.myView = nullptr;
+	o.myViewLength = 0;
+}
+
+FileReader&
+FileReader::operator=(FileReader && o)
+{
+	if (&o != this)
+	{
+		close();
 		myFile = o.myFile;
-		o.myFile = INVALID_HANDLE_VALUE;
+		myView = o.myView;
+		myViewLength = o.myViewLength;
+		o.myFile = -1;
+		o.myView = nullptr;
+		o.myViewLength = 0;
 	}
 	return *this;
 }
 
 bool
-FileReader::read(std::vector<unsigned char>& destination)
+FileReader::read(uint64_t offset, void *destination, size_t length) const
 {
-	FILE_STANDARD_INFO info = { 0 };
-	if (!GetFileInformationByHandleEx(myFile, FileStandardInfo, &info, sizeof(info)))
+	unsigned char *position = static_cast<unsigned char *>(destination);
+	while (length > 0)
 	{
-		return false;
+		ssize_t count = pread(myFile, position, (std::min)(length, MaximumReadLength), static_cast<off_t>(offset));
+		if (count < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (count <= 0)
+		{
+			return false;
+		}
+		position += count;
+		offset += count;
+		length -= count;
 	}
-	if (info.EndOfFile.HighPart != 0)
+	return true;
+}
+
+uint64_t
+FileReader::getSize() const
+{
+	struct stat status;
+	if (fstat(myFile, &status) != 0)
 	{
-		return false;
+		return 0;
+	}
+	return static_cast<uint64_t>(status.st_size);
+}
+
+const unsigned char *
+FileReader::map(uint64_t offset, size_t length)
+{
+	unmap();
+	if (length == 0 || offset + length > getSize())
+	{
+		return nullptr;
 	}
-	destination.resize(info.EndOfFile.LowPart);
-	if (!ReadFile(myFile, destination.data(), static_cast<DWORD>(destination.size()), nullptr, nullptr))
+
+	// Views must start at a multiple of the page size
+	uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+	uint64_t start = offset - offset % page;
+	size_t lead = static_cast<size_t>(offset - start);
+	void *view = mmap(nullptr, lead + length, PROT_READ, MAP_PRIVATE, myFile, static_cast<off_t>(start));
+	if (view == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	myView = view;
+	myViewLength = lead + length;
+	return static_cast<const unsigned char *>(myView) + lead;
+}
+
+void
+FileReader::unmap()
+{
+	if (myView)
+	{
+		munmap(myView, myViewLength);
+		myView = nullptr;
+		myViewLength = 0;
+	}
+}
+
+#endif
+
+FileReader::~FileReader()
+{
+	close();
+}
+
+bool
+FileReader::read(std::vector<unsigned char>& destination)
+{
+	uint64_t size = getSize();
+	if (size > SIZE_MAX)
 	{
 		return false;
 	}
-	return true;
+	destination.resize(static_cast<size_t>(size));
+	return read(0, destination.data(), destination.size());
+}
+
+const unsigned char *
+FileReader::map()
+{
+	uint64_t size = getSize();
+	if (size > SIZE_MAX)
+	{
+		return nullptr;
+	}
+	return map(0, static_cast<size_t>(size));
 }
@@ -12,11 +12,21 @@
 * prior written permission from Derivative.
 */
 
+
+
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
+/*
+* Reads files through Win32, or POSIX elsewhere. Files of any size can be read whole, read at an offset, or
+* mapped into memory without copying.
+*/
 class FileReader
 {
 public:
@@ -27,8 +37,34 @@ public:
 	FileReader &operator=(FileReader &&o);
 	~FileReader();
 
+	bool	isOpen() const;
+
 	bool	read(std::vector<unsigned char> &destination);
+
+	// Reads length bytes from offset, failing if there are fewer. May be called from several threads at once.
+	bool	read(uint64_t offset, void *destination, size_t length) const;
+
+	// The size of the file in bytes, or 0 if it can't be determined
+	uint64_t	getSize() const;
+
+	/*
+	* Maps length bytes from offset into memory, replacing any previous view, and returns null on failure.
+	* Pages are read as they are touched, so only views - not whole files - need fit in memory.
+	* The view remains valid until the next call to map() or unmap(), or destruction.
+	*/
+	const unsigned char	*map(uint64_t offset, size_t length);
+	// Maps the whole file, of getSize() bytes
+	const unsigned char	*map();
+	void	unmap();
 private:
+	void	close();
+
+#ifdef _WIN32
 	HANDLE	myFile;
+	HANDLE	myMapping{ nullptr };
+#else
+	int		myFile;
+#endif
+	void	*myView{ nullptr };
+	size_t	myViewLength{ 0 };
 };
-
@@ -0,0 +1,87 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "FileStream.h"
+#include "Trace.h"
+#include <algorithm>
+
+FileStream::FileStream(const FileReader& file, WorkerPool& workers, size_t chunkSize, size_t readAhead)
+	: myFile(file), myWorkers(workers), mySize(file.getSize()), myChunkSize((std::max<size_t>)(chunkSize, 1)), myBuffers(readAhead + 1)
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	for (auto& buffer : myBuffers)
+	{
+		startRead(buffer);
+	}
+}
+
+FileStream::~FileStream()
+{
+	std::unique_lock<std::mutex> lock(myMutex);
+	myCondition.wait(lock, [this] { return myReadsInProgress == 0; });
+}
+
+bool
+FileStream::next(Chunk& chunk)
+{
+	TRACE_SCOPE("FileStream::next");
+	std::unique_lock<std::mutex> lock(myMutex);
+	if (myHolding)
+	{
+		// The consumer is done with the previous chunk, so its buffer reads furthest ahead
+		myHolding = false;
+		startRead(myBuffers[(myNext + myBuffers.size() - 1) % myBuffers.size()]);
+	}
+
+	Buffer& buffer = myBuffers[myNext];
+	myCondition.wait(lock, [&buffer] { return buffer.state != State::Reading; });
+	if (buffer.state != State::Ready)
+	{
+		return false;
+	}
+	chunk.data = buffer.data.data();
+	chunk.size = buffer.size;
+	chunk.offset = buffer.offset;
+	myHolding = true;
+	myNext = (myNext + 1) % myBuffers.size();
+	return true;
+}
+
+void
+FileStream::startRead(Buffer& buffer)
+{
+	if (myFailed || myReadOffset >= mySize)
+	{
+		buffer.state = myFailed ? State::Failed : State::End;
+		return;
+	}
+	// Allocated on first use, so small files don't allocate every buffer
+	buffer.data.resize(myChunkSize);
+	buffer.offset = myReadOffset;
+	buffer.size = static_cast<size_t>((std::min<uint64_t>)(myChunkSize, mySize - myReadOffset));
+	buffer.state = State::Reading;
+	myReadOffset += buffer.size;
+	myReadsInProgress++;
+
+	myWorkers.submit([this, &buffer]
+		{
+			bool read = myFile.read(buffer.offset, buffer.data.data(), buffer.size);
+			// Notified under the lock, as the destructor may run as soon as it's released
+			std::lock_guard<std::mutex> guard(myMutex);
+			buffer.state = read ? State::Ready : State::Failed;
+			myFailed = myFailed || !read;
+			myReadsInProgress--;
+			myCondition.notify_all();
+		});
+}
@@ -0,0 +1,100 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "FileReader.h"
+#include "WorkerPool.h"
+
+/*
+* Reads a file in order, a chunk at a time, with reads ahead of the consumer running on a WorkerPool.
+*
+* A fixed set of buffers is allocated up front and reused, so streaming a file of any size allocates
+* nothing after construction. While the consumer works on one chunk, up to readAhead further chunks are
+* read in the background.
+*/
+class FileStream
+{
+public:
+	struct Chunk
+	{
+		const unsigned char*	data;
+		size_t					size;
+		// Of data in the file
+		uint64_t				offset;
+	};
+
+	static constexpr size_t	 DefaultChunkSize{ 4 * 1024 * 1024 };
+	static constexpr size_t	 DefaultReadAhead{ 3 };
+
+	// file and workers must outlive the stream. Reading begins immediately.
+	FileStream(const FileReader& file, WorkerPool& workers, size_t chunkSize = DefaultChunkSize, size_t readAhead = DefaultReadAhead);
+	FileStream(const FileStream& o) = delete;
+	FileStream& operator=(const FileStream& o) = delete;
+	// Waits for reads in progress
+	~FileStream();
+
+	/*
+	* Waits for the next chunk, and returns false at the end of the file or if a read failed.
+	* The chunk remains valid until the next call.
+	*/
+	bool	next(Chunk& chunk);
+
+	// Whether next() returned false because a read failed
+	bool
+	hasFailed() const
+	{
+		return myFailed;
+	}
+private:
+	enum class State
+	{
+		Reading,
+		Ready,
+		Failed,
+		End
+	};
+
+	struct Buffer
+	{
+		std::vector<unsigned char>	data;
+		uint64_t					offset = 0;
+		size_t						size = 0;
+		State						state = State::End;
+	};
+
+	// Must be called with myMutex locked
+	void	startRead(Buffer& buffer);
+
+	const FileReader&		myFile;
+	WorkerPool&				myWorkers;
+	uint64_t				mySize;
+	size_t					myChunkSize;
+	std::mutex				myMutex;
+	std::condition_variable	myCondition;
+	std::vector<Buffer>		myBuffers;
+	// The buffer next() returns next, the one before it is the consumer's
+	size_t					myNext{ 0 };
+	bool					myHolding{ false };
+	uint64_t				myReadOffset{ 0 };
+	size_t					myReadsInProgress{ 0 };
+	bool					myFailed{ false };
+};
@@ -0,0 +1,255 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "FloatBufferAnalyzer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FLOAT_BUFFER_ANALYZER_SSE
+#endif
+
+namespace
+{
+	struct Sums
+	{
+		float	minimum = std::numeric_limits<float>::max();
+		float	maximum = std::numeric_limits<float>::lowest();
+		double	sum = 0.0;
+		double	sumOfSquares = 0.0;
+	};
+
+	// Values summed in float lanes before adding to the double totals, to bound rounding error
+	constexpr uint32_t BlockSize{ 1024 };
+
+	void
+	accumulate(const float* values, uint32_t count, Sums& sums)
+	{
+		uint32_t i = 0;
+#ifdef FLOAT_BUFFER_ANALYZER_SSE
+		if (count >= 4)
+		{
+			__m128 minimum = _mm_set1_ps(sums.minimum);
+			__m128 maximum = _mm_set1_ps(sums.maximum);
+			while (i + 4 <= count)
+			{
+				uint32_t end = std::min(count & ~3u, i + BlockSize);
+				__m128 sum = _mm_setzero_ps();
+				__m128 squares = _mm_setzero_ps();
+				for (; i < end; i += 4)
+				{
+					__m128 v = _mm_loadu_ps(values + i);
+					minimum = _mm_min_ps(minimum, v);
+					maximum = _mm_max_ps(maximum, v);
+					sum = _mm_add_ps(sum, v);
+					squares = _mm_add_ps(squares, _mm_mul_ps(v, v));
+				}
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, sum);
+				sums.sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+				_mm_store_ps(lanes, squares);
+				sums.sumOfSquares += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+			}
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, minimum);
+			sums.minimum = std::min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			_mm_store_ps(lanes, maximum);
+			sums.maximum = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float v = values[i];
+			sums.minimum = std::min(sums.minimum, v);
+			sums.maximum = std::max(sums.maximum, v);
+			sums.sum += v;
+			sums.sumOfSquares += static_cast<double>(v) * v;
+		}
+	}
+
+	int64_t
+	now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+FloatBufferAnalyzer::FloatBufferAnalyzer(WorkerPool& workers)
+	: myWorkers(workers)
+{
+}
+
+FloatBufferAnalyzer::~FloatBufferAnalyzer()
+{
+	std::unique_lock<std::mutex> lock(myMutex);
+	myCondition.wait(lock, [this] { return !myScheduled; });
+}
+
+void
+FloatBufferAnalyzer::setPeakHoldTime(int64_t nanoseconds)
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	myPeakHoldTime = nanoseconds;
+}
+
+void
+FloatBufferAnalyzer::submit(const TEFloatBuffer* buffer)
+{
+	TRACE_SCOPE("FloatBufferAnalyzer::submit");
+
+	int32_t channelCount = TEFloatBufferGetChannelCount(buffer);
+	uint32_t valueCount = TEFloatBufferGetValueCount(buffer);
+	const float* const* values = TEFloatBufferGetValues(buffer);
+	if (channelCount <= 0 || values == nullptr)
+	{
+		return;
+	}
+
+	std::unique_ptr<Frame> frame;
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		if (!myFreeFrames.empty())
+		{
+			frame = std::move(myFreeFrames.back());
+			myFreeFrames.pop_back();
+		}
+	}
+	if (!frame)
+	{
+		frame = std::make_unique<Frame>();
+	}
+
+	// The one copy out of the buffer, so the instance is free to replace it
+	frame->channelCount = channelCount;
+	frame->valueCount = valueCount;
+	frame->values.resize(static_cast<size_t>(channelCount) * valueCount);
+	for (int32_t channel = 0; channel < channelCount; channel++)
+	{
+		std::copy(values[channel], values[channel] + valueCount, frame->values.begin() + static_cast<size_t>(channel) * valueCount);
+	}
+
+	std::lock_guard<std::mutex> guard(myMutex);
+	myStatistics.submitted++;
+	if (myPending)
+	{
+		myStatistics.skipped++;
+		myFreeFrames.push_back(std::move(myPending));
+	}
+	myPending = std::move(frame);
+	if (!myScheduled)
+	{
+		myScheduled = true;
+		myWorkers.submit([this] { run(); });
+	}
+}
+
+void
+FloatBufferAnalyzer::run()
+{
+	std::unique_lock<std::mutex> lock(myMutex);
+	while (myPending)
+	{
+		std::unique_ptr<Frame> frame = std::move(myPending);
+		lock.unlock();
+
+		analyze(*frame);
+
+		lock.lock();
+		myStatistics.analyzed++;
+		myFreeFrames.push_back(std::move(frame));
+	}
+	myScheduled = false;
+	// Notify while locked, as the destructor may return as soon as it sees myScheduled clear
+	myCondition.notify_all();
+}
+
+std::shared_ptr<FloatBufferAnalyzer::Snapshot>
+FloatBufferAnalyzer::getSpareSnapshot()
+{
+	// A snapshot only we hold is neither published nor being read
+	for (const auto& snapshot : mySnapshots)
+	{
+		if (snapshot.use_count() == 1)
+		{
+			// Pairs with the release by the last reader to let go of it
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return snapshot;
+		}
+	}
+	mySnapshots.push_back(std::make_shared<Snapshot>());
+	return mySnapshots.back();
+}
+
+void
+FloatBufferAnalyzer::analyze(const Frame& frame)
+{
+	TRACE_SCOPE("FloatBufferAnalyzer::analyze");
+
+	int64_t holdTime;
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		holdTime = myPeakHoldTime;
+	}
+	int64_t time = now();
+
+	// A change in channel count restarts peak holds
+	if (myHeldPeaks.size() != static_cast<size_t>(frame.channelCount))
+	{
+		myHeldPeaks.assign(frame.channelCount, 0.0f);
+		myHeldTimes.assign(frame.channelCount, time);
+	}
+
+	std::shared_ptr<Snapshot> snapshot = getSpareSnapshot();
+	snapshot->sequence = ++mySequence;
+	snapshot->valueCount = frame.valueCount;
+	snapshot->channels.resize(frame.channelCount);
+	for (int32_t i = 0; i < frame.channelCount; i++)
+	{
+		Channel& channel = snapshot->channels[i];
+		if (frame.valueCount == 0)
+		{
+			channel = Channel();
+		}
+		else
+		{
+			Sums sums;
+			accumulate(frame.values.data() + static_cast<size_t>(i) * frame.valueCount, frame.valueCount, sums);
+			channel.minimum = sums.minimum;
+			channel.maximum = sums.maximum;
+			channel.mean = static_cast<float>(sums.sum / frame.valueCount);
+			channel.rms = static_cast<float>(std::sqrt(sums.sumOfSquares / frame.valueCount));
+			channel.peak = std::max(std::fabs(sums.minimum), std::fabs(sums.maximum));
+		}
+		if (channel.peak >= myHeldPeaks[i] || time - myHeldTimes[i] > holdTime)
+		{
+			myHeldPeaks[i] = channel.peak;
+			myHeldTimes[i] = time;
+		}
+		channel.peakHold = myHeldPeaks[i];
+	}
+
+	std::atomic_store(&mySnapshot, std::shared_ptr<const Snapshot>(snapshot));
+}
+
+FloatBufferAnalyzer::Statistics
+FloatBufferAnalyzer::getStatistics() const
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	return myStatistics;
+}
@@ -0,0 +1,118 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "WorkerPool.h"
+
+/*
+* Measures each channel of a float buffer output - minimum, maximum, mean, RMS, peak and held peak - on a
+* worker thread, so large buffers don't hold up the thread reading outputs.
+*
+* submit() copies the buffer's values once into a pooled frame and schedules analysis. Only the latest
+* frame is kept while analysis is running, so a slow worker skips frames rather than falling behind.
+* Results are published as immutable snapshots with std::atomic_store(), which any thread may read with
+* getSnapshot().
+*/
+class FloatBufferAnalyzer
+{
+public:
+	struct Channel
+	{
+		float	minimum = 0.0f;
+		float	maximum = 0.0f;
+		float	mean = 0.0f;
+		float	rms = 0.0f;
+		// The largest absolute value
+		float	peak = 0.0f;
+		// The largest peak within the hold time
+		float	peakHold = 0.0f;
+	};
+
+	struct Snapshot
+	{
+		// Counts the snapshots published
+		uint64_t				sequence = 0;
+		uint32_t				valueCount = 0;
+		std::vector<Channel>	channels;
+	};
+
+	struct Statistics
+	{
+		uint64_t	submitted = 0;
+		uint64_t	analyzed = 0;
+		// Frames replaced by a later frame before analysis began
+		uint64_t	skipped = 0;
+	};
+
+	explicit FloatBufferAnalyzer(WorkerPool& workers);
+	FloatBufferAnalyzer(const FloatBufferAnalyzer& o) = delete;
+	FloatBufferAnalyzer& operator=(const FloatBufferAnalyzer& o) = delete;
+	// Waits for any analysis in progress
+	~FloatBufferAnalyzer();
+
+	// How long a peak is held before peakHold falls to a lower peak (nanoseconds)
+	void	setPeakHoldTime(int64_t nanoseconds);
+
+	// Copies the buffer's values and schedules analysis, from a single thread
+	void	submit(const TEFloatBuffer* buffer);
+
+	// Null until the first analysis completes, may be called from any thread
+	std::shared_ptr<const Snapshot>
+	getSnapshot() const
+	{
+		return std::atomic_load(&mySnapshot);
+	}
+
+	Statistics	getStatistics() const;
+private:
+	// Planar values, each channel's valueCount values following the last
+	struct Frame
+	{
+		int32_t				channelCount = 0;
+		uint32_t			valueCount = 0;
+		std::vector<float>	values;
+	};
+
+	void	run();
+	void	analyze(const Frame& frame);
+	std::shared_ptr<Snapshot>	getSpareSnapshot();
+
+	WorkerPool&				myWorkers;
+	mutable std::mutex		myMutex;
+	std::condition_variable	myCondition;
+	// Set while a task is scheduled on myWorkers
+	bool					myScheduled{ false };
+	std::unique_ptr<Frame>	myPending;
+	std::vector<std::unique_ptr<Frame>>	myFreeFrames;
+	Statistics				myStatistics;
+
+	// Worker state, only touched by the one task scheduled at a time
+	int64_t					myPeakHoldTime{ 1000000000 };
+	std::vector<float>		myHeldPeaks;
+	std::vector<int64_t>	myHeldTimes;
+	uint64_t				mySequence{ 0 };
+	// Snapshots we may reuse once no reader holds them
+	std::vector<std::shared_ptr<Snapshot>>	mySnapshots;
+
+	std::shared_ptr<const Snapshot>	mySnapshot;
+};
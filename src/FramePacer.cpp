@@ -0,0 +1,142 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+int64_t
+SteadyFrameClock::now() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void
+SteadyFrameClock::sleepFor(int64_t nanoseconds)
+{
+	std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds));
+}
+
+void
+SteadyFrameClock::relax()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+FramePacer::FramePacer(FrameClock& clock, int64_t rateNumerator, int32_t rateDenominator)
+	: myClock(clock), myRateNumerator(rateNumerator), myRateDenominator(rateDenominator)
+{
+	start();
+}
+
+void
+FramePacer::setRate(int64_t numerator, int32_t denominator)
+{
+	myRateNumerator = numerator;
+	myRateDenominator = denominator;
+	start();
+}
+
+void
+FramePacer::setSpinThreshold(int64_t nanoseconds)
+{
+	mySpinThreshold = nanoseconds;
+}
+
+void
+FramePacer::setLateThreshold(int64_t nanoseconds)
+{
+	myLateThreshold = nanoseconds;
+}
+
+void
+FramePacer::start()
+{
+	myStart = myClock.now();
+	myNextIndex = 0;
+}
+
+int64_t
+FramePacer::getDeadline(uint64_t index) const
+{
+	// Computed from the start for each frame so rounding never accumulates
+	return myStart + static_cast<int64_t>((static_cast<double>(index) * myRateDenominator * 1000000000.0) / myRateNumerator);
+}
+
+int64_t
+FramePacer::getTimeUntilDeadline() const
+{
+	return getDeadline(myNextIndex) - myClock.now();
+}
+
+bool
+FramePacer::waitForDeadline(int64_t limit)
+{
+	int64_t now = myClock.now();
+	const int64_t end = now + limit;
+	const int64_t deadline = getDeadline(myNextIndex);
+	if (deadline - now > mySpinThreshold)
+	{
+		myClock.sleepFor(std::min(deadline - now - mySpinThreshold, limit));
+		now = myClock.now();
+	}
+	while (now < deadline && now < end)
+	{
+		myClock.relax();
+		now = myClock.now();
+	}
+	return now >= deadline;
+}
+
+FramePacer::Frame
+FramePacer::beginFrame(int32_t timeScale)
+{
+	int64_t now = myClock.now();
+	uint64_t index = myNextIndex;
+	// Move to the latest deadline which has passed
+	while (getDeadline(index + 1) <= now)
+	{
+		index++;
+	}
+	myStatistics.skipped += index - myNextIndex;
+	myNextIndex = index + 1;
+
+	Frame frame;
+	frame.index = index;
+	frame.timeValue = static_cast<int64_t>((static_cast<double>(index) * myRateDenominator * timeScale) / myRateNumerator);
+	frame.lateness = std::max<int64_t>(now - getDeadline(index), 0);
+
+	myStatistics.frames++;
+	myStatistics.latenessSum += frame.lateness;
+	myStatistics.latenessMax = std::max(myStatistics.latenessMax, frame.lateness);
+	if (frame.lateness > myLateThreshold)
+	{
+		myStatistics.late++;
+	}
+	return frame;
+}
+
+void
+FramePacer::resetStatistics()
+{
+	myStatistics = Statistics();
+}
@@ -0,0 +1,127 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+/*
+* Source of time for FramePacer, in nanoseconds from an arbitrary epoch.
+* Implement this with a simulated clock to test pacing.
+*/
+class FrameClock
+{
+public:
+	virtual ~FrameClock() = default;
+
+	virtual int64_t	now() const = 0;
+	virtual void	sleepFor(int64_t nanoseconds) = 0;
+	// Called between checks of now() while spinning
+	virtual void	relax() = 0;
+};
+
+class SteadyFrameClock : public FrameClock
+{
+public:
+	virtual int64_t	now() const override;
+	virtual void	sleepFor(int64_t nanoseconds) override;
+	virtual void	relax() override;
+};
+
+/*
+* Schedules frames against absolute deadlines at a fixed rate, so scheduling error in one frame
+* does not accumulate into the next.
+*
+* Waits sleep until shortly before a deadline and spin for the remainder, as sleeps are only
+* accurate to the system timer resolution.
+*/
+class FramePacer
+{
+public:
+	struct Frame
+	{
+		uint64_t	index;
+		// Frame time in the time scale passed to beginFrame()
+		int64_t		timeValue;
+		// How long after its deadline the frame began, in nanoseconds
+		int64_t		lateness;
+	};
+
+	struct Statistics
+	{
+		uint64_t	frames = 0;
+		// Deadlines passed without a frame beginning
+		uint64_t	skipped = 0;
+		// Frames which began more than the late threshold after their deadline
+		uint64_t	late = 0;
+		int64_t		latenessSum = 0;
+		int64_t		latenessMax = 0;
+	};
+
+	FramePacer(FrameClock& clock, int64_t rateNumerator, int32_t rateDenominator);
+
+	void	setRate(int64_t numerator, int32_t denominator);
+
+	// Sleeping stops this long before a deadline, and the wait spins instead
+	void	setSpinThreshold(int64_t nanoseconds);
+	int64_t
+	getSpinThreshold() const
+	{
+		return mySpinThreshold;
+	}
+	void	setLateThreshold(int64_t nanoseconds);
+
+	// Makes the next deadline now, restarting frame times from zero
+	void	start();
+
+	// Negative if the deadline has passed
+	int64_t	getTimeUntilDeadline() const;
+
+	/*
+	* Waits for the next deadline, but for no longer than 'limit' nanoseconds.
+	* Returns true if the deadline has been reached.
+	*/
+	bool	waitForDeadline(int64_t limit);
+
+	/*
+	* Begins the frame for the most recent deadline, skipping any deadlines missed entirely.
+	* The next deadline is the one following.
+	*/
+	Frame	beginFrame(int32_t timeScale);
+
+	const Statistics&
+	getStatistics() const
+	{
+		return myStatistics;
+	}
+	void	resetStatistics();
+
+	FrameClock&
+	getClock() const
+	{
+		return myClock;
+	}
+private:
+	int64_t	getDeadline(uint64_t index) const;
+
+	FrameClock&	myClock;
+	int64_t		myRateNumerator;
+	int32_t		myRateDenominator;
+	int64_t		mySpinThreshold{ 2000000 };
+	int64_t		myLateThreshold{ 1000000 };
+	int64_t		myStart{ 0 };
+	uint64_t	myNextIndex{ 0 };
+	Statistics	myStatistics;
+};
@@ -0,0 +1,138 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "FramePipeline.h"
+
+FramePipeline::FramePipeline(size_t depth)
+	: myDepth(0)
+{
+	setDepth(depth);
+}
+
+void
+FramePipeline::setDepth(size_t depth)
+{
+	myDepth = depth < 1 ? 1 : depth;
+	// Slots are never removed while they may be in use, a smaller depth just stops new frames starting
+	if (mySlots.size() < myDepth)
+	{
+		mySlots.resize(myDepth);
+	}
+}
+
+size_t
+FramePipeline::begin(int64_t timeValue, int32_t timeScale)
+{
+	if (!canStart())
+	{
+		return NoSlot;
+	}
+	for (size_t i = 0; i < mySlots.size(); i++)
+	{
+		Slot& slot = mySlots[i];
+		if (!slot.active)
+		{
+			slot.active = true;
+			slot.timeValue = timeValue;
+			slot.timeScale = timeScale;
+			slot.sequence = mySequence++;
+			slot.started = std::chrono::steady_clock::now();
+
+			myStatistics.inFlightSum += myInFlight;
+			myInFlight++;
+			myStatistics.started++;
+			if (myInFlight > myStatistics.maxInFlight)
+			{
+				myStatistics.maxInFlight = myInFlight;
+			}
+			return i;
+		}
+	}
+	return NoSlot;
+}
+
+void
+FramePipeline::abort(size_t slot)
+{
+	if (slot < mySlots.size() && mySlots[slot].active)
+	{
+		release(mySlots[slot]);
+		myStatistics.started--;
+		myStatistics.inFlightSum -= myInFlight;
+	}
+}
+
+size_t
+FramePipeline::finish(int64_t timeValue, int32_t timeScale)
+{
+	// Prefer the oldest frame with a matching time, otherwise assume frames finish in order
+	size_t matched = NoSlot;
+	size_t oldest = NoSlot;
+	for (size_t i = 0; i < mySlots.size(); i++)
+	{
+		const Slot& slot = mySlots[i];
+		if (!slot.active)
+		{
+			continue;
+		}
+		if (oldest == NoSlot || slot.sequence < mySlots[oldest].sequence)
+		{
+			oldest = i;
+		}
+		// Compare times across scales without overflow for any plausible time
+		bool sameTime = slot.timeScale == timeScale ? slot.timeValue == timeValue :
+			static_cast<double>(slot.timeValue) / slot.timeScale == static_cast<double>(timeValue) / timeScale;
+		if (sameTime && (matched == NoSlot || slot.sequence < mySlots[matched].sequence))
+		{
+			matched = i;
+		}
+	}
+	if (matched == NoSlot && oldest != NoSlot)
+	{
+		matched = oldest;
+		myStatistics.unmatched++;
+	}
+	if (matched != NoSlot)
+	{
+		myStatistics.finished++;
+		myStatistics.latencySum += std::chrono::steady_clock::now() - mySlots[matched].started;
+		release(mySlots[matched]);
+	}
+	return matched;
+}
+
+void
+FramePipeline::reset()
+{
+	for (auto& slot : mySlots)
+	{
+		if (slot.active)
+		{
+			release(slot);
+		}
+	}
+}
+
+void
+FramePipeline::resetStatistics()
+{
+	myStatistics = Statistics();
+}
+
+void
+FramePipeline::release(Slot& slot)
+{
+	slot.active = false;
+	myInFlight--;
+}
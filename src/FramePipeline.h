@@ -0,0 +1,99 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/*
+* Tracks the frames started on an instance but not yet finished, up to a configurable depth.
+*
+* Each frame in flight occupies a slot, whose index callers use to hold that frame's inputs until it
+* finishes - see InputObjectPool and AudioInput. Finished frames are matched to their slot by the time
+* passed to TEInstanceStartFrameAtTime() and returned in TEEventFrameDidFinish.
+*/
+class FramePipeline
+{
+public:
+	static constexpr size_t NoSlot = SIZE_MAX;
+
+	struct Statistics
+	{
+		uint64_t	started = 0;
+		uint64_t	finished = 0;
+		// Frames which finished with a time matching no frame in flight, and were matched to the oldest
+		uint64_t	unmatched = 0;
+		size_t		maxInFlight = 0;
+		// The sum of the number of frames in flight as each frame started, for the average
+		uint64_t	inFlightSum = 0;
+		std::chrono::steady_clock::duration	latencySum{ 0 };
+	};
+
+	explicit FramePipeline(size_t depth = 1);
+
+	void	setDepth(size_t depth);
+	size_t
+	getDepth() const
+	{
+		return myDepth;
+	}
+
+	size_t
+	getInFlight() const
+	{
+		return myInFlight;
+	}
+
+	bool
+	canStart() const
+	{
+		return myInFlight < myDepth;
+	}
+
+	// Reserves a slot for a frame, returning NoSlot if the pipeline is full
+	size_t	begin(int64_t timeValue, int32_t timeScale);
+	// Releases a slot for a frame which failed to start
+	void	abort(size_t slot);
+	// Releases the slot of a finished frame, returning it or NoSlot if no frames were in flight
+	size_t	finish(int64_t timeValue, int32_t timeScale);
+	// Forgets all frames in flight
+	void	reset();
+
+	const Statistics&
+	getStatistics() const
+	{
+		return myStatistics;
+	}
+	void	resetStatistics();
+private:
+	struct Slot
+	{
+		bool									active = false;
+		int64_t									timeValue = 0;
+		int32_t									timeScale = 0;
+		uint64_t								sequence = 0;
+		std::chrono::steady_clock::time_point	started;
+	};
+
+	void	release(Slot& slot);
+
+	std::vector<Slot>	mySlots;
+	size_t				myDepth;
+	size_t				myInFlight{ 0 };
+	uint64_t			mySequence{ 0 };
+	Statistics			myStatistics;
+};
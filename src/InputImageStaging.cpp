@@ -0,0 +1,110 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "InputImageStaging.h"
+#include "Trace.h"
+
+InputImageStaging::InputImageStaging()
+	: myInputs(std::make_shared<const Inputs>())
+{
+}
+
+void
+InputImageStaging::addInput(int width, int height, PixelFormat format)
+{
+	auto inputs = std::make_shared<Inputs>(*myInputs);
+	inputs->push_back(std::make_shared<Input>(width, height, format));
+	std::atomic_store(&myInputs, std::shared_ptr<const Inputs>(std::move(inputs)));
+}
+
+void
+InputImageStaging::clear()
+{
+	// Producers may still be submitting to the old inputs, whose images are dropped from now on
+	for (const auto& input : *myInputs)
+	{
+		if (input->pending.exchange(Input::Retired, std::memory_order_acq_rel) & Input::Fresh)
+		{
+			myDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	std::atomic_store(&myInputs, std::make_shared<const Inputs>());
+}
+
+bool
+InputImageStaging::submit(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	TRACE_SCOPE("InputImageStaging::submit");
+	mySubmitted.fetch_add(1, std::memory_order_relaxed);
+	auto inputs = std::atomic_load(&myInputs);
+	if (index >= inputs->size() || (*inputs)[index]->width != width || (*inputs)[index]->height != height ||
+		!CanConvertPixels(format, (*inputs)[index]->format))
+	{
+		myDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	Input& input = *(*inputs)[index];
+
+	std::lock_guard<std::mutex> guard(input.producer);
+	auto& buffer = input.buffers[input.back];
+	size_t rowSize = static_cast<size_t>(width) * GetBytesPerPixel(input.format);
+	// Each buffer is allocated when first filled, so inputs nobody submits to cost nothing
+	buffer.resize(rowSize * height);
+	// Converting while copying means the renderer's thread never converts
+	ConvertPixels(pixels, bytesPerRow, format, buffer.data(), rowSize, input.format, width, height);
+
+	uint32_t previous = input.pending.exchange(input.back | Input::Fresh, std::memory_order_acq_rel);
+	if (previous & Input::Retired)
+	{
+		input.pending.store(Input::Retired, std::memory_order_release);
+		myDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	if (previous & Input::Fresh)
+	{
+		myOverwritten.fetch_add(1, std::memory_order_relaxed);
+	}
+	input.back = previous & ~Input::Fresh;
+	return true;
+}
+
+const unsigned char*
+InputImageStaging::take(size_t index)
+{
+	const Inputs& inputs = *myInputs;
+	if (index >= inputs.size())
+	{
+		return nullptr;
+	}
+	Input& input = *inputs[index];
+	if ((input.pending.load(std::memory_order_relaxed) & Input::Fresh) == 0)
+	{
+		return nullptr;
+	}
+	uint32_t previous = input.pending.exchange(input.front, std::memory_order_acq_rel);
+	input.front = previous & ~Input::Fresh;
+	myUploaded.fetch_add(1, std::memory_order_relaxed);
+	return input.buffers[input.front].data();
+}
+
+InputImageStaging::Counters
+InputImageStaging::getCounters() const
+{
+	Counters counters;
+	counters.submitted = mySubmitted.load(std::memory_order_relaxed);
+	counters.uploaded = myUploaded.load(std::memory_order_relaxed);
+	counters.overwritten = myOverwritten.load(std::memory_order_relaxed);
+	counters.dropped = myDropped.load(std::memory_order_relaxed);
+	return counters;
+}
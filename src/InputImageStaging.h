@@ -0,0 +1,103 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include "PixelFormat.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+* The latest image submitted for each input image, staged in three buffers per input so producers on any thread
+* never wait for the renderer, and the renderer never waits for a producer.
+*
+* A producer fills its own buffer and swaps it with the pending one. The renderer swaps the pending buffer with the
+* one it last uploaded, if the pending buffer holds an image it hasn't taken. Images submitted faster than the
+* renderer takes them replace one another, so only the latest is uploaded. Images are converted to the input's
+* format as they are copied in, so the renderer only ever sees one format per input.
+*/
+class InputImageStaging
+{
+public:
+	struct Counters
+	{
+		uint64_t	submitted = 0;
+		// Taken by the renderer to upload
+		uint64_t	uploaded = 0;
+		// Replaced by a later image before being taken
+		uint64_t	overwritten = 0;
+		// Refused as there was no such input, the image was a different size or couldn't be converted, or
+		// discarded by a layout change
+		uint64_t	dropped = 0;
+	};
+
+	InputImageStaging();
+	InputImageStaging(const InputImageStaging& o) = delete;
+	InputImageStaging& operator=(const InputImageStaging& o) = delete;
+
+	// Called on the renderer's thread as its input images are added and cleared
+	void		addInput(int width, int height, PixelFormat format);
+	void		clear();
+
+	// May be called from any thread, returns false if the image was dropped
+	bool		submit(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format);
+
+	/*
+	* Called on the renderer's thread. Returns the latest image submitted for the input since the last call, or
+	* null if there is none. Pixels are in the input's format, in rows of its width * GetBytesPerPixel() bytes, and
+	* remain valid until the next call for the same input or clear().
+	*/
+	const unsigned char*	take(size_t index);
+
+	Counters	getCounters() const;
+private:
+	struct Input
+	{
+		Input(int w, int h, PixelFormat f)
+			: width(w), height(h), format(f)
+		{
+		}
+
+		// Index of the buffer between producers and the renderer, with Fresh set until the renderer takes it
+		static constexpr uint32_t Fresh{ 4 };
+		// Set instead once clear() has discarded the input
+		static constexpr uint32_t Retired{ 8 };
+
+		int				width;
+		int				height;
+		PixelFormat		format;
+		std::array<std::vector<unsigned char>, 3>	buffers;
+		std::atomic<uint32_t>	pending{ 0 };
+		// Producers of the same input take turns with their buffer
+		std::mutex		producer;
+		uint32_t		back{ 1 };
+		// Only used by the renderer
+		uint32_t		front{ 2 };
+	};
+
+	using Inputs = std::vector<std::shared_ptr<Input>>;
+
+	// Replaced on the renderer's thread and published with std::atomic_store(), so producers needn't lock
+	std::shared_ptr<const Inputs>	myInputs;
+	std::atomic<uint64_t>	mySubmitted{ 0 };
+	std::atomic<uint64_t>	myUploaded{ 0 };
+	std::atomic<uint64_t>	myOverwritten{ 0 };
+	std::atomic<uint64_t>	myDropped{ 0 };
+};
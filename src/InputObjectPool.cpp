@@ -0,0 +1,205 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "InputObjectPool.h"
+#include "Trace.h"
+#include <tuple>
+
+bool
+InputObjectPool::Key::operator<(const Key& o) const
+{
+	return std::tie(index, type, rate, first, second, timeDependent) < std::tie(o.index, o.type, o.rate, o.first, o.second, o.timeDependent);
+}
+
+InputObjectPool::Key
+InputObjectPool::getKey(size_t index, TEObject* object)
+{
+	Key key{ index, TEGetType(object), 0.0, 0, 0, false };
+	if (key.type == TEObjectTypeFloatBuffer)
+	{
+		TEFloatBuffer* buffer = static_cast<TEFloatBuffer*>(object);
+		key.rate = TEFloatBufferGetRate(buffer);
+		key.first = TEFloatBufferGetChannelCount(buffer);
+		key.second = TEFloatBufferGetCapacity(buffer);
+		key.timeDependent = TEFloatBufferIsTimeDependent(buffer);
+	}
+	else if (key.type == TEObjectTypeTable)
+	{
+		TETable* table = static_cast<TETable*>(object);
+		key.first = TETableGetRowCount(table);
+		key.second = static_cast<uint32_t>(TETableGetColumnCount(table));
+	}
+	return key;
+}
+
+InputObjectPool::Statistics&
+InputObjectPool::getStatistics(TEObjectType type)
+{
+	return type == TEObjectTypeTable ? myTableStatistics : myFloatBufferStatistics;
+}
+
+TouchObject<TEObject>
+InputObjectPool::acquire(const Key& key)
+{
+	Statistics& statistics = getStatistics(key.type);
+	statistics.requests++;
+	statistics.live++;
+
+	TouchObject<TEObject> object;
+	auto it = myIdle.find(key);
+	if (it != myIdle.end() && !it->second.empty())
+	{
+		object = std::move(it->second.back());
+		it->second.pop_back();
+		statistics.hits++;
+		statistics.idle--;
+	}
+	return object;
+}
+
+TouchObject<TEFloatBuffer>
+InputObjectPool::acquireFloatBuffer(size_t index, double rate, int32_t channels, uint32_t capacity, bool timeDependent)
+{
+	TouchObject<TEObject> object = acquire({ index, TEObjectTypeFloatBuffer, rate, channels, capacity, timeDependent });
+	TouchObject<TEFloatBuffer> buffer;
+	if (object)
+	{
+		buffer.set(static_cast<TEFloatBuffer*>(object.get()));
+	}
+	else if (timeDependent)
+	{
+		buffer.take(TRACE_TE(TEFloatBufferCreateTimeDependent, rate, channels, capacity, nullptr));
+	}
+	else
+	{
+		buffer.take(TRACE_TE(TEFloatBufferCreate, rate, channels, capacity, nullptr));
+	}
+	return buffer;
+}
+
+TouchObject<TETable>
+InputObjectPool::acquireTable(size_t index, int32_t rows, int32_t columns)
+{
+	TouchObject<TEObject> object = acquire({ index, TEObjectTypeTable, 0.0, rows, static_cast<uint32_t>(columns), false });
+	TouchObject<TETable> table;
+	if (object)
+	{
+		table.set(static_cast<TETable*>(object.get()));
+	}
+	else
+	{
+		table.take(TETableCreate());
+		TRACE_TE(TETableResize, table, rows, columns);
+	}
+	return table;
+}
+
+void
+InputObjectPool::recycle(size_t index, const TouchObject<TEObject>& object)
+{
+	if (object)
+	{
+		// Keyed by what the object is now, in case it was changed after it was acquired
+		Key key = getKey(index, object);
+		Statistics& statistics = getStatistics(key.type);
+		statistics.live--;
+		statistics.idle++;
+		myIdle[key].push_back(object);
+	}
+}
+
+void
+InputObjectPool::forget(const TouchObject<TEObject>& object)
+{
+	if (object)
+	{
+		getStatistics(TEGetType(object)).live--;
+	}
+}
+
+void
+InputObjectPool::setValue(size_t index, size_t slot, const TouchObject<TEObject>& value)
+{
+	if (index >= myValues.size())
+	{
+		myValues.resize(index + 1);
+	}
+	if (myValues[index].get() == value.get())
+	{
+		return;
+	}
+	if (myValues[index])
+	{
+		if (myRetired.size() <= slot)
+		{
+			myRetired.resize(slot + 1);
+		}
+		myRetired[slot].emplace_back(index, std::move(myValues[index]));
+	}
+	myValues[index] = value;
+}
+
+void
+InputObjectPool::finish(size_t slot)
+{
+	if (slot < myRetired.size())
+	{
+		for (const auto& retired : myRetired[slot])
+		{
+			recycle(retired.first, retired.second);
+		}
+		myRetired[slot].clear();
+	}
+}
+
+void
+InputObjectPool::abandon(size_t slot)
+{
+	if (slot < myRetired.size())
+	{
+		for (const auto& retired : myRetired[slot])
+		{
+			forget(retired.second);
+		}
+		myRetired[slot].clear();
+	}
+}
+
+void
+InputObjectPool::abandonAll()
+{
+	for (size_t slot = 0; slot < myRetired.size(); slot++)
+	{
+		abandon(slot);
+	}
+}
+
+void
+InputObjectPool::reset(size_t count)
+{
+	// Link indices change meaning, so objects retired or pooled for the old links mustn't reach the new ones
+	abandonAll();
+	for (const auto& object : myValues)
+	{
+		forget(object);
+	}
+	myValues.clear();
+	myValues.resize(count);
+
+	for (const auto& idle : myIdle)
+	{
+		getStatistics(idle.first.type).idle -= idle.second.size();
+	}
+	myIdle.clear();
+}
@@ -0,0 +1,111 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <TouchEngine/TouchObject.h>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/*
+* Recycles the TEFloatBuffers and TETables set on input links, so frames needn't create them.
+*
+* Float buffers are pooled by rate, channel count, capacity and time-dependence, and tables by shape. Objects
+* are pooled for each input link, so an object only returns to the link which last set it - letting the
+* link's TableModel know what a table already holds.
+*
+* TouchEngine doesn't expose an object's reference count, so we infer when the instance has released
+* one: it holds the value of a link until the link is set again, and may use it until the frame which
+* replaced it has finished. setValue() records the object set on a link for a frame, retiring the link's
+* previous object with that frame's slot, and finish() recycles the objects retired with a slot.
+*/
+class InputObjectPool
+{
+public:
+	struct Statistics
+	{
+		uint64_t	requests = 0;
+		// Requests met from the pool rather than by creating an object
+		uint64_t	hits = 0;
+		// Objects given out and not yet recycled, including those held as link values
+		size_t		live = 0;
+		// Objects waiting in the pool
+		size_t		idle = 0;
+	};
+
+	InputObjectPool() = default;
+	InputObjectPool(const InputObjectPool& o) = delete;
+	InputObjectPool& operator=(const InputObjectPool& o) = delete;
+
+	// For the input link at index
+	TouchObject<TEFloatBuffer>	acquireFloatBuffer(size_t index, double rate, int32_t channels, uint32_t capacity, bool timeDependent);
+	TouchObject<TETable>		acquireTable(size_t index, int32_t rows, int32_t columns);
+	// Returns an object acquired for the link at index which was never given to the instance
+	void	recycle(size_t index, const TouchObject<TEObject>& object);
+
+	// Records the object set on the input link at index for the frame in slot
+	void	setValue(size_t index, size_t slot, const TouchObject<TEObject>& value);
+	// Recycles the objects retired with a finished frame's slot
+	void	finish(size_t slot);
+	// Forgets the objects retired with a slot without reusing them, as for a frame which failed to start
+	void	abandon(size_t slot);
+	// Abandons every slot, as when we lose track of which frames finished
+	void	abandonAll();
+	/*
+	* Forgets link values, retired and pooled objects and sizes for count links, as when the link layout
+	* changes. The instance may still hold the old values, so they are not reused.
+	*/
+	void	reset(size_t count);
+
+	const Statistics&
+	getFloatBufferStatistics() const
+	{
+		return myFloatBufferStatistics;
+	}
+
+	const Statistics&
+	getTableStatistics() const
+	{
+		return myTableStatistics;
+	}
+private:
+	struct Key
+	{
+		size_t			index;
+		TEObjectType	type;
+		double			rate;
+		int32_t			first;
+		uint32_t		second;
+		bool			timeDependent;
+
+		bool	operator<(const Key& o) const;
+	};
+
+	static Key	getKey(size_t index, TEObject* object);
+	Statistics&	getStatistics(TEObjectType type);
+	TouchObject<TEObject>	acquire(const Key& key);
+	void	forget(const TouchObject<TEObject>& object);
+
+	std::map<Key, std::vector<TouchObject<TEObject>>>	myIdle;
+	// The value set on each input link, by index
+	std::vector<TouchObject<TEObject>>					myValues;
+	// Objects replaced as link values with their link index, by the slot of the frame which replaced them
+	std::vector<std::vector<std::pair<size_t, TouchObject<TEObject>>>>	myRetired;
+	Statistics		myFloatBufferStatistics;
+	Statistics		myTableStatistics;
+};
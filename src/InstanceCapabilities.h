@@ -0,0 +1,37 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstdint>
+#include <vector>
+
+/*
+* What an instance supports, as a Renderer needs to know to configure itself. Each renderer queries only what
+* it needs. These don't change while the component and device stay the same, so ComponentCache keeps them
+* for the next load.
+*/
+struct InstanceCapabilities
+{
+	std::vector<TETextureType>		textureTypes;
+	// TED3DHandleType, which is only declared on Windows
+	std::vector<int32_t>			d3dHandleTypes;
+	std::vector<TESemaphoreType>	semaphoreTypes;
+	std::vector<TETextureFormat>	textureFormats;
+	bool							keyedMutexReleaseToZero = false;
+	bool							openGLTextures = false;
+};
@@ -0,0 +1,1000 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "InstanceController.h"
+#include "Strings.h"
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+
+InstanceController::InstanceController(Renderer& renderer, RunLoop* runLoop, bool flipInputImages)
+	: myRenderer(renderer), myRunLoop(runLoop), myFlipInputImages(flipInputImages)
+{
+	// The renderer draws every output texture, so reads each new one
+	myLinkInterests.subscribe(TELinkTypeTexture, 1, [this](TEInstance*, const LinkLayout::Link& link)
+	{
+		StatisticsCollector::Timer timer(&myStatistics, StatisticsCollector::Metric::OutputImage);
+		myRenderer.updateOutputImage(myInstance, link.textureIndex, link.identifier);
+	});
+}
+
+InstanceController::~InstanceController()
+{
+	// Do this first so no more callbacks arrive, and related resources our Renderer may be interested in are released
+	myInstance.reset();
+}
+
+void
+InstanceController::setFrameRate(int32_t numerator, int32_t denominator)
+{
+	myRateNumerator = numerator;
+	myRateDenominator = denominator;
+	myPacer.setRate(numerator, denominator);
+}
+
+void
+InstanceController::setSpinThreshold(int64_t nanoseconds)
+{
+	myPacer.setSpinThreshold(nanoseconds);
+}
+
+void
+InstanceController::setTableInput(const std::string& identifier, std::shared_ptr<TableModel> table)
+{
+	if (table)
+	{
+		myTableInputs[identifier] = std::move(table);
+	}
+	else
+	{
+		myTableInputs.erase(identifier);
+	}
+	for (size_t i = 0; i < myInputLinks.size(); i++)
+	{
+		auto& link = myInputLinks[i];
+		if (link.type == TELinkTypeStringData &&
+			(link.identifier == identifier || (identifier.empty() && myTableInputs.count(link.identifier) == 0)))
+		{
+			link.table = getTableInput(identifier);
+			// Generations of different models aren't comparable
+			myInputValues.markDirty(i);
+		}
+	}
+}
+
+std::shared_ptr<TableModel>
+InstanceController::getTableInput(const std::string& identifier) const
+{
+	auto it = myTableInputs.find(identifier);
+	if (it == myTableInputs.end())
+	{
+		it = myTableInputs.find(std::string());
+	}
+	if (it != myTableInputs.end())
+	{
+		return it->second;
+	}
+	// Example values for links the host hasn't supplied a table for
+	auto table = std::make_shared<TableModel>(3, 2);
+	for (int32_t row = 0; row < 3; row++)
+	{
+		for (int32_t column = 0; column < 2; column++)
+		{
+			table->set(row, column, "test");
+		}
+	}
+	return table;
+}
+
+void
+InstanceController::setAudioInput(std::shared_ptr<AudioInput> audio)
+{
+	if (myAudioInput)
+	{
+		myAudioInput->reset();
+	}
+	myAudioInput = std::move(audio);
+}
+
+void
+InstanceController::setComponentCache(std::shared_ptr<ComponentCache> cache)
+{
+	myComponentCache = std::move(cache);
+}
+
+void
+InstanceController::setTestPatterns(std::shared_ptr<TestPatternCache> patterns)
+{
+	myTestPatterns = std::move(patterns);
+}
+
+void
+InstanceController::setInputPattern(TestPattern::Type type, uint32_t width, uint32_t height)
+{
+	myInputPattern = type;
+	myInputImageWidth = (std::max)(1u, (std::min)(width, TestPattern::MaxSize));
+	myInputImageHeight = (std::max)(1u, (std::min)(height, TestPattern::MaxSize));
+}
+
+TEResult
+InstanceController::load(const std::string& path)
+{
+	if (myComponentCache)
+	{
+		myHasComponentKey = ComponentCache::getKey(ConvertToWide(path), myComponentKey);
+		if (!myHasComponentKey || !myComponentCache->find(myComponentKey, myComponent))
+		{
+			myComponent = ComponentCache::Entry();
+		}
+	}
+
+	TEResult result = TRACE_TE(TEInstanceCreate, eventCallback, linkEventCallback, this, myInstance.take());
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceSetStatisticsCallback, myInstance, statisticsCallback);
+	}
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceAssociateGraphicsContext, myInstance, myRenderer.getTEContext());
+	}
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceConfigure, myInstance, path.c_str(), TETimeExternal);
+	}
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceSetFrameRate, myInstance, myRateNumerator, myRateDenominator);
+	}
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceLoad, myInstance);
+	}
+	if (result == TEResultSuccess)
+	{
+		result = TRACE_TE(TEInstanceResume, myInstance);
+	}
+	if (result == TEResultSuccess && !myComponent.links.empty())
+	{
+		// Rather than waiting for the instance to load and report its links, build the layout it had last time
+		buildLayout(myComponent.links);
+	}
+	if (result == TEResultSuccess)
+	{
+		myPacer.start();
+	}
+	return result;
+}
+
+LinkInterestManager::ConsumerID
+InstanceController::subscribe(const std::string& identifier, uint32_t decimation, LinkInterestManager::Consumer consumer)
+{
+	return myLinkInterests.subscribe(identifier, decimation, std::move(consumer));
+}
+
+LinkInterestManager::ConsumerID
+InstanceController::subscribe(TELinkType type, uint32_t decimation, LinkInterestManager::Consumer consumer)
+{
+	return myLinkInterests.subscribe(type, decimation, std::move(consumer));
+}
+
+void
+InstanceController::unsubscribe(LinkInterestManager::ConsumerID id)
+{
+	myLinkInterests.unsubscribe(id);
+}
+
+bool
+InstanceController::hasPendingEvents() const
+{
+	return myEvents.getDepth() > 0 || myLostEvents.load(std::memory_order_relaxed) != 0;
+}
+
+bool
+InstanceController::takeConfigureError(TEResult& result, std::wstring& message)
+{
+	if (myConfigureErrorPending)
+	{
+		myConfigureErrorPending = false;
+		result = myConfigureResult;
+		message = myConfigureMessage;
+		return true;
+	}
+	return false;
+}
+
+void
+InstanceController::didConfigure(TEResult result)
+{
+	// Configuration can be cancelled by a subsequent configuration or other action
+	// - we can ignore the event in that case and await a following one
+	if (result != TEResultCancelled)
+	{
+		postEvent({ InstanceEvent::Kind::Configured, result });
+	}
+}
+
+void
+InstanceController::didLoad()
+{
+	postEvent({ InstanceEvent::Kind::Loaded });
+}
+
+void
+InstanceController::eventCallback(TEInstance *,
+									TEEvent event,
+									TEResult result,
+									int64_t start_time_value,
+									int32_t start_time_scale,
+									int64_t,
+									int32_t,
+									void * info)
+{
+	InstanceController *controller = static_cast<InstanceController *>(info);
+
+	switch (event)
+	{
+	case TEEventInstanceReady:
+		controller->didConfigure(result);
+		break;
+	case TEEventInstanceDidLoad:
+		controller->didLoad();
+		break;
+	case TEEventInstanceDidUnload:
+		break;
+	case TEEventFrameDidFinish:
+		controller->endFrame(start_time_value, start_time_scale, result);
+		break;
+	case TEEventGeneral:
+		controller->myGeneralResult.store(result, std::memory_order_relaxed);
+		break;
+	default:
+		break;
+	}
+}
+
+void
+InstanceController::linkEventCallback(TEInstance *, TELinkEvent event, const char *identifier, void * info)
+{
+	InstanceController* controller = static_cast<InstanceController*>(info);
+	switch (event)
+	{
+	case TELinkEventAdded:
+	case TELinkEventRemoved:
+	case TELinkEventModified:
+	case TELinkEventChildChange:
+		controller->linkLayoutDidChange();
+		break;
+	case TELinkEventValueChange:
+		controller->linkValueChange(identifier);
+		break;
+	default:
+		break;
+	}
+}
+
+void
+InstanceController::statisticsCallback(TEInstance *, const TEInstanceStatistics * statistics, void * info)
+{
+	// The collector is safe to record to from any thread
+	static_cast<InstanceController*>(info)->myStatistics.record(*statistics);
+}
+
+void
+InstanceController::linkValueChange(const char* identifier)
+{
+	TRACE_SCOPE("InstanceController::linkValueChange");
+	// Changes to links not yet in our layout are picked up when the layout is applied, as new layouts start with every link pending
+	auto layout = std::atomic_load(&myLinkLayout);
+	LinkID id = layout ? layout->find(identifier) : InvalidLinkID;
+	if (id != InvalidLinkID && layout->get(id).scope == TEScopeOutput)
+	{
+		// Flag the change, values are read by their consumers from the update thread
+		layout->markPending(id);
+		if (myRunLoop)
+		{
+			myRunLoop->wake();
+		}
+	}
+}
+
+void
+InstanceController::endFrame(int64_t time_value, int32_t time_scale, TEResult result)
+{
+	postEvent({ InstanceEvent::Kind::FrameFinished, result, time_value, time_scale });
+}
+
+void
+InstanceController::postEvent(const InstanceEvent& event)
+{
+	if (!myEvents.push(event))
+	{
+		// The queue is full - note what was lost so drainEvents() can recover it
+		if (event.kind == InstanceEvent::Kind::Configured)
+		{
+			myLostConfigureResult.store(event.result, std::memory_order_relaxed);
+		}
+		myLostEvents.fetch_or(1u << static_cast<uint32_t>(event.kind), std::memory_order_release);
+	}
+	if (myRunLoop)
+	{
+		myRunLoop->wake();
+	}
+}
+
+void
+InstanceController::applyEvent(const InstanceEvent& event)
+{
+	switch (event.kind)
+	{
+	case InstanceEvent::Kind::Configured:
+		myConfigureRenderer = true;
+		myConfigureResult = event.result;
+		break;
+	case InstanceEvent::Kind::Loaded:
+		myDidLoad = true;
+		break;
+	case InstanceEvent::Kind::LayoutChanged:
+		// Rebuilding the layout also marks every output pending
+		myPendingLayoutChange = true;
+		break;
+	case InstanceEvent::Kind::FrameFinished:
+	{
+		size_t slot = myFrames.finish(event.timeValue, event.timeScale);
+		myOutputFrameTime = event.timeValue;
+		if (slot != FramePipeline::NoSlot)
+		{
+			myInputObjects.finish(slot);
+			if (myAudioInput)
+			{
+				myAudioInput->release(slot);
+			}
+		}
+		break;
+	}
+	}
+}
+
+void
+InstanceController::drainEvents()
+{
+	InstanceEvent event;
+	while (myEvents.pop(event))
+	{
+		applyEvent(event);
+	}
+
+	// Other than frame completions, each kind of event only sets state, so applying each lost kind once brings us back in sync
+	uint32_t lost = myLostEvents.exchange(0, std::memory_order_acquire);
+	for (auto kind : { InstanceEvent::Kind::Configured, InstanceEvent::Kind::Loaded, InstanceEvent::Kind::LayoutChanged })
+	{
+		if (lost & (1u << static_cast<uint32_t>(kind)))
+		{
+			applyEvent({ kind, kind == InstanceEvent::Kind::Configured ? myLostConfigureResult.load(std::memory_order_relaxed) : TEResultSuccess });
+		}
+	}
+	// We can't know which frames finished, so forget them all rather than stall
+	if (lost & (1u << static_cast<uint32_t>(InstanceEvent::Kind::FrameFinished)))
+	{
+		myFrames.reset();
+		myInputObjects.abandonAll();
+		if (myAudioInput)
+		{
+			myAudioInput->reset();
+		}
+	}
+}
+
+void
+InstanceController::getState(bool& configured, bool& loaded, bool& linksChanged, bool& canStartFrame)
+{
+	drainEvents();
+
+	configured = myConfigureRenderer;
+	myConfigureRenderer = false;
+	loaded = myDidLoad;
+	if (myDidLoad)
+	{
+		// For this example, we are only interested in links after load has completed
+		linksChanged = myPendingLayoutChange;
+		canStartFrame = myFrames.canStart();
+		myPendingLayoutChange = false;
+	}
+	else
+	{
+		linksChanged = false;
+		canStartFrame = false;
+	}
+}
+
+void
+InstanceController::linkLayoutDidChange()
+{
+	postEvent({ InstanceEvent::Kind::LayoutChanged });
+}
+
+bool
+InstanceController::pace()
+{
+	if (myPacer.waitForDeadline(MaxPaceWait))
+	{
+		return update();
+	}
+	return false;
+}
+
+int64_t
+InstanceController::getWaitTime() const
+{
+	if (myFrameBlocked)
+	{
+		// The event which unblocks the frame wakes the run loop
+		return BlockedWaitLimit;
+	}
+	// Leave the last stretch before the deadline to pace(), which spins for precision
+	int64_t wait = myPacer.getTimeUntilDeadline() - myPacer.getSpinThreshold();
+	return wait > 0 ? wait : 0;
+}
+
+bool
+InstanceController::update()
+{
+	TRACE_SCOPE("InstanceController::update");
+	StatisticsCollector::Timer timer(&myStatistics, StatisticsCollector::Metric::Update);
+	myStatistics.collect();
+
+	bool configured, loaded, linksChanged, canStartFrame;
+	getState(configured, loaded, linksChanged, canStartFrame);
+
+	if (configured)
+	{
+		myConfigureMessage.clear();
+		configureRenderer();
+		myConfigureErrorPending = myConfigureError;
+	}
+
+	if (myConfigureError)
+	{
+		return false;
+	}
+
+	bool changed = linksChanged;
+
+	// Make any pending renderer state updates
+	if (linksChanged)
+	{
+		applyLayoutChange();
+	}
+
+	if (loaded)
+	{
+		changed = applyOutputChange() || changed;
+	}
+
+	// Once loaded, the component's layout and capabilities are known
+	if (loaded && myComponentChanged)
+	{
+		if (myComponentCache && myHasComponentKey)
+		{
+			myComponentCache->store(myComponentKey, myComponent);
+		}
+		myComponentChanged = false;
+	}
+
+	// update() is also called for window and instance events, but frames only start at their deadlines
+	bool due = myPacer.getTimeUntilDeadline() <= 0;
+	myFrameBlocked = due && !(loaded && canStartFrame);
+
+	if (loaded && canStartFrame && due)
+	{
+		// Frame times are those of the deadline the frame was planned for, not when we got to it
+		FramePacer::Frame frame = myPacer.beginFrame(TimeRate);
+		int64_t time = frame.timeValue;
+		// Inputs we create for this frame are held for its slot until it finishes, see InputObjectPool
+		size_t slot = myFrames.begin(time, TimeRate);
+
+		// Audio continues from the last frame's, so is sliced every frame whether or not a link takes it
+		TEFloatBuffer* audio = nullptr;
+		if (myAudioInput)
+		{
+			int64_t duration = static_cast<int64_t>(TimeRate) * myRateDenominator / myRateNumerator;
+			audio = myAudioInput->prepare(slot, time, duration, TimeRate);
+		}
+
+		// Images submitted to the renderer since the last frame are uploaded now, and set below
+		if (TestPattern::isAnimated(myLayoutPattern.type))
+		{
+			drawInputImages(frame.index);
+		}
+		changed = myRenderer.updateInputImages() || changed;
+
+		// Examples of setting input links
+		// Values are only sent if they differ from those last sent, see LinkValueCache
+		for (size_t i = 0; i < myInputLinks.size(); i++)
+		{
+			const auto& link = myInputLinks[i];
+			TEResult result = TEResultSuccess;
+			switch (link.type)
+			{
+			case TELinkTypeDouble:
+			{
+				double d = fmod(myLastFloatValue, 1.0);
+				if (myInputValues.updateDoubles(i, &d, 1))
+				{
+					result = TRACE_TE(TEInstanceLinkSetDoubleValue, myInstance, link.identifier.c_str(), &d, 1);
+				}
+				break;
+			}
+			case TELinkTypeInt:
+			{
+				int v = static_cast<int>(myLastFloatValue * 100) % 100;
+				if (myInputValues.updateInts(i, &v, 1))
+				{
+					result = TRACE_TE(TEInstanceLinkSetIntValue, myInstance, link.identifier.c_str(), &v, 1);
+				}
+				break;
+			}
+			case TELinkTypeString:
+			{
+				const char* value = "test input";
+				if (myInputValues.updateString(i, value))
+				{
+					result = TRACE_TE(TEInstanceLinkSetStringValue, myInstance, link.identifier.c_str(), value);
+				}
+				break;
+			}
+			case TELinkTypeTexture:
+			{
+				TouchObject<TETexture> texture;
+				TouchObject<TESemaphore> semaphore;
+				uint64_t waitValue = 0;
+				// Our OpenGL and D3D11 renderers use their TEGraphicsContexts to handle setting inputs, meaning they needn't do any sync themselves
+				// - but at the cost of a texture copy by the TEGraphicsContext
+				// Our D3D12 renderer creates shareable textures, so it must handle sync itself - when setting a texture we uses a texture transfer
+				// to supply a fence and wait-value to the instance - the instance will insert a wait for the fence prior to consuming the input texture
+				if (myRenderer.getInputImage(link.textureIndex, texture, semaphore, waitValue))
+				{
+					result = TRACE_TE(TEInstanceLinkSetTextureValue, myInstance, link.identifier.c_str(), texture, myRenderer.getTEContext());
+					if (result == TEResultSuccess && myRenderer.doesInputTextureTransfer())
+					{
+						result = TRACE_TE(TEInstanceAddTextureTransfer, myInstance, texture, semaphore, waitValue);
+					}
+				}
+				break;
+			}
+			case TELinkTypeFloatBuffer:
+			{
+				if (myAudioInput)
+				{
+					// Time-dependent buffers are queued by the instance and matched to frames by their start times
+					if (audio)
+					{
+						result = TRACE_TE(TEInstanceLinkAddFloatBuffer, myInstance, link.identifier.c_str(), audio);
+					}
+					break;
+				}
+				float value = static_cast<float>(fmod(myLastFloatValue, 1.0));
+				std::array<const float*, 2> channels{ &value, &value };
+				if (!myInputValues.updateFloatBuffer(i, channels.data(), 2, 1))
+				{
+					break;
+				}
+				// Rather than creating a buffer every frame, reuse one the instance has finished with
+				// Two channels, capacity of one sample per channel - this buffer is not time-dependent, see AudioInput for
+				// handling time-dependent samples such as audio
+				TouchObject<TEFloatBuffer> buffer = myInputObjects.acquireFloatBuffer(i, -1, 2, 1, false);
+				if (!buffer)
+				{
+					result = TEResultBadUsage;
+					break;
+				}
+				result = TRACE_TE(TEFloatBufferSetValues, buffer, channels.data(), 1);
+				if (result == TEResultSuccess)
+				{
+					result = TRACE_TE(TEInstanceLinkSetFloatBufferValue, myInstance, link.identifier.c_str(), buffer);
+				}
+				if (result == TEResultSuccess)
+				{
+					myInputObjects.setValue(i, slot, buffer);
+				}
+				else
+				{
+					myInputObjects.recycle(i, buffer);
+				}
+				break;
+			}
+			case TELinkTypeStringData:
+			{
+				// String data can be either tabular, in which case set a TETable, or a single string - here we set a table
+				// (use TEInstanceLinkSetStringValue() to set a string value)
+				// The table is only set when its model has changed
+				if (!link.table || !myInputValues.updateHash(i, link.table->getGeneration()))
+				{
+					break;
+				}
+
+				// As for float buffers, reuse a table the instance has finished with - and only write the cells
+				// which have changed since the model last wrote to it
+				TouchObject<TETable> table = myInputObjects.acquireTable(i, link.table->getRowCount(), link.table->getColumnCount());
+				if (!table)
+				{
+					result = TEResultBadUsage;
+					break;
+				}
+				link.table->update(table);
+				result = TRACE_TE(TEInstanceLinkSetTableValue, myInstance, link.identifier.c_str(), table);
+				if (result == TEResultSuccess)
+				{
+					myInputObjects.setValue(i, slot, table);
+				}
+				else
+				{
+					myInputObjects.recycle(i, table);
+				}
+				break;
+			}
+			default:
+				break;
+			}
+			if (result == TEResultSuccess)
+			{
+				myInputValues.markClean(i);
+			}
+		}
+
+		// Outputs with no consumer due to read them this frame are set to TELinkInterestNoValues
+		myLinkInterests.beginFrame();
+
+		myLastResult = TRACE_TE(TEInstanceStartFrameAtTime, myInstance, time, TimeRate, false);
+		if (myLastResult == TEResultSuccess)
+		{
+			myLastFloatValue += 1.0 / (60.0 * 8.0);
+			if (myFrames.getDepth() < FramePipelineDepth && ++myFramesAtReducedDepth >= DepthProbeInterval)
+			{
+				myFrames.setDepth(myFrames.getDepth() + 1);
+				myFramesAtReducedDepth = 0;
+			}
+		}
+		else
+		{
+			myFrames.abort(slot);
+			myInputObjects.abandon(slot);
+			if (myAudioInput)
+			{
+				myAudioInput->abandon(slot);
+			}
+			if (myLastResult == TEResultBadUsage && myFrames.getInFlight() > 0)
+			{
+				// The instance won't accept another frame while others are in flight, so limit ourselves to what it does accept
+				myFrames.setDepth(myFrames.getInFlight());
+				myFramesAtReducedDepth = 0;
+				myLastResult = TEResultSuccess;
+			}
+		}
+	}
+	return changed;
+}
+
+void
+InstanceController::applyLayoutChange()
+{
+	TRACE_SCOPE("InstanceController::applyLayoutChange");
+	StatisticsCollector::Timer timer(&myStatistics, StatisticsCollector::Metric::LayoutChange);
+
+	std::vector<ComponentCache::Link> links = discoverLinks();
+	auto same = [](const ComponentCache::Link& a, const ComponentCache::Link& b) { return a.isSameLink(b); };
+	bool unchanged = links.size() == myComponent.links.size() && std::equal(links.begin(), links.end(), myComponent.links.begin(), same);
+
+	// Defaults only change with the component, so are only queried for links we haven't seen
+	for (auto& link : links)
+	{
+		auto known = std::find_if(myComponent.links.begin(), myComponent.links.end(), [&link](const ComponentCache::Link& l) { return l.isSameLink(link); });
+		if (known != myComponent.links.end())
+		{
+			link.defaults = known->defaults;
+			link.defaultString = known->defaultString;
+		}
+		else
+		{
+			queryDefaults(link);
+		}
+	}
+
+	if (unchanged && myLinkLayout)
+	{
+		// Most likely the layout we built from the cache - only bind it to the instance, and fetch and send every value
+		myLinkInterests.setLayout(myInstance, myLinkLayout);
+		myLinkLayout->markAllPending();
+		myInputValues.markAllDirty();
+	}
+	else
+	{
+		buildLayout(links);
+		myComponentChanged = true;
+	}
+	myComponent.links = std::move(links);
+}
+
+std::vector<ComponentCache::Link>
+InstanceController::discoverLinks()
+{
+	std::vector<ComponentCache::Link> links;
+	for (auto scope : { TEScopeInput, TEScopeOutput })
+	{
+		TouchObject<TEStringArray> groups;
+		TEResult result = TRACE_TE(TEInstanceGetLinkGroups, myInstance, scope, groups.take());
+		if (result == TEResultSuccess)
+		{
+			for (int32_t i = 0; i < groups->count; i++)
+			{
+				TouchObject<TELinkInfo> group;
+				result = TRACE_TE(TEInstanceLinkGetInfo, myInstance, groups->strings[i], group.take());
+				if (result == TEResultSuccess)
+				{
+					// Use group info here
+				}
+				TouchObject<TEStringArray> children;
+				if (result == TEResultSuccess)
+				{
+					result = TRACE_TE(TEInstanceLinkGetChildren, myInstance, groups->strings[i], children.take());
+				}
+				if (result == TEResultSuccess)
+				{
+					for (int32_t j = 0; j < children->count; j++)
+					{
+						TouchObject<TELinkInfo> info;
+						result = TRACE_TE(TEInstanceLinkGetInfo, myInstance, children->strings[j], info.take());
+						if (result == TEResultSuccess)
+						{
+							links.push_back({ info->identifier, groups->strings[i], info->type, scope, info->count, info->intent });
+						}
+					}
+				}
+			}
+		}
+	}
+	return links;
+}
+
+void
+InstanceController::queryDefaults(ComponentCache::Link& link)
+{
+	link.defaults.clear();
+	link.defaultString.clear();
+	if (link.scope != TEScopeInput || link.count <= 0)
+	{
+		return;
+	}
+	const char* identifier = link.identifier.c_str();
+	switch (link.type)
+	{
+	case TELinkTypeDouble:
+	{
+		std::vector<double> values(link.count);
+		if (TRACE_TE(TEInstanceLinkGetDoubleValue, myInstance, identifier, TELinkValueDefault, values.data(), link.count) == TEResultSuccess)
+		{
+			link.defaults = std::move(values);
+		}
+		break;
+	}
+	case TELinkTypeInt:
+	{
+		std::vector<int32_t> values(link.count);
+		if (TRACE_TE(TEInstanceLinkGetIntValue, myInstance, identifier, TELinkValueDefault, values.data(), link.count) == TEResultSuccess)
+		{
+			link.defaults.assign(values.begin(), values.end());
+		}
+		break;
+	}
+	case TELinkTypeBoolean:
+	{
+		bool value = false;
+		if (TRACE_TE(TEInstanceLinkGetBooleanValue, myInstance, identifier, TELinkValueDefault, &value) == TEResultSuccess)
+		{
+			link.defaults.assign(1, value ? 1.0 : 0.0);
+		}
+		break;
+	}
+	case TELinkTypeString:
+	{
+		TouchObject<TEString> value;
+		if (TRACE_TE(TEInstanceLinkGetStringValue, myInstance, identifier, TELinkValueDefault, value.take()) == TEResultSuccess && value)
+		{
+			link.defaultString = value->string;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void
+InstanceController::buildLayout(const std::vector<ComponentCache::Link>& links)
+{
+	if (!myTestPatterns)
+	{
+		myTestPatterns = std::make_shared<TestPatternCache>();
+	}
+
+	myRenderer.beginImageLayout();
+
+	myRenderer.clearInputImages();
+	myRenderer.clearOutputImages();
+	myInputLinks.clear();
+
+	myLayoutPattern = TestPattern::Key();
+	myLayoutPattern.type = myInputPattern;
+	myLayoutPattern.width = myInputImageWidth;
+	myLayoutPattern.height = myInputImageHeight;
+	myLayoutPattern.flipped = myFlipInputImages;
+	myPatternFrames.clear();
+
+	std::vector<LinkLayout::Link> layoutLinks;
+
+	for (const auto& link : links)
+	{
+		if (link.scope == TEScopeInput)
+		{
+			myInputLinks.push_back({ link.identifier, link.type, link.count, link.intent, myRenderer.getInputImageCount() });
+			if (link.type == TELinkTypeStringData)
+			{
+				myInputLinks.back().table = getTableInput(link.identifier);
+			}
+		}
+		size_t textureIndex = link.scope == TEScopeInput ? myRenderer.getInputImageCount() : myRenderer.getRightSideImageCount();
+		layoutLinks.push_back({ link.identifier, link.type, link.scope, textureIndex });
+		if (link.type == TELinkTypeTexture)
+		{
+			if (link.scope == TEScopeInput)
+			{
+				// Inputs cycle through the pattern's variants, each drawn once however many inputs use it
+				TestPattern::Key key = myLayoutPattern;
+				key.variant = static_cast<uint32_t>(myRenderer.getInputImageCount() % TestPattern::VariantCount);
+				if (TestPattern::isAnimated(key.type))
+				{
+					// Only static patterns are cached, animated ones are redrawn for every frame by drawInputImages()
+					size_t bytesPerRow = key.width * TestPattern::BytesPerPixel;
+					std::vector<unsigned char> pixels(bytesPerRow * key.height);
+					TestPattern::draw(key, 0, pixels.data(), bytesPerRow, myTestPatterns->getWorkers());
+					myRenderer.addInputImage(pixels.data(), bytesPerRow, key.width, key.height, PixelFormat::BGRA8);
+				}
+				else
+				{
+					auto image = myTestPatterns->get(key);
+					myRenderer.addInputImage(image->pixels.data(), image->bytesPerRow, key.width, key.height, PixelFormat::BGRA8);
+				}
+			}
+			else
+			{
+				myRenderer.addOutputImage();
+			}
+		}
+	}
+
+	myRenderer.endImageLayout();
+
+	myInputValues.reset(myInputLinks.size());
+	myInputObjects.reset(myInputLinks.size());
+
+	// Every link in the new layout starts pending, so values changed before this point are fetched
+	auto layout = std::make_shared<const LinkLayout>(std::move(layoutLinks));
+	myLinkInterests.setLayout(myInstance, layout);
+	std::atomic_store(&myLinkLayout, layout);
+}
+
+void
+InstanceController::configureRenderer()
+{
+	if (TEResultGetSeverity(myConfigureResult) == TESeverityError)
+	{
+		myConfigureError = true;
+		return;
+	}
+	// Capabilities only hold for the device and TouchEngine they were queried with
+	bool cached = myComponent.hasCapabilities &&
+		myComponent.deviceName == myRenderer.getDeviceName() &&
+		myComponent.engineVersion == getEngineVersion();
+	if (!cached)
+	{
+		queryCapabilities();
+	}
+	myConfigureError = !myRenderer.configure(myComponent.capabilities, myConfigureMessage);
+	if (myConfigureError && cached)
+	{
+		// The cached capabilities may be out of date in a way we can't tell, so ask the instance and try once more
+		queryCapabilities();
+		myConfigureMessage.clear();
+		myConfigureError = !myRenderer.configure(myComponent.capabilities, myConfigureMessage);
+	}
+}
+
+void
+InstanceController::drawInputImages(uint64_t frame)
+{
+	TRACE_SCOPE("InstanceController::drawInputImages");
+	size_t count = myRenderer.getInputImageCount();
+	if (count == 0)
+	{
+		return;
+	}
+	// As in buildLayout(), inputs sharing a variant share one drawing
+	TestPattern::Key key = myLayoutPattern;
+	size_t bytesPerRow = key.width * TestPattern::BytesPerPixel;
+	myPatternFrames.resize((std::min)(count, static_cast<size_t>(TestPattern::VariantCount)));
+	for (size_t variant = 0; variant < myPatternFrames.size(); variant++)
+	{
+		auto& pixels = myPatternFrames[variant];
+		pixels.resize(bytesPerRow * key.height);
+		key.variant = static_cast<uint32_t>(variant);
+		TestPattern::draw(key, frame, pixels.data(), bytesPerRow, myTestPatterns->getWorkers());
+		TestPattern::stamp(frame, pixels.data(), bytesPerRow, key.width, key.height, key.flipped);
+	}
+	for (size_t index = 0; index < count; index++)
+	{
+		const auto& pixels = myPatternFrames[index % TestPattern::VariantCount];
+		myRenderer.submitInputImage(index, pixels.data(), bytesPerRow, key.width, key.height, PixelFormat::BGRA8);
+	}
+}
+
+void
+InstanceController::queryCapabilities()
+{
+	myComponent.capabilities = InstanceCapabilities();
+	myRenderer.getCapabilities(myInstance, myComponent.capabilities);
+	myComponent.deviceName = myRenderer.getDeviceName();
+	myComponent.engineVersion = getEngineVersion();
+	myComponent.hasCapabilities = true;
+	myComponentChanged = true;
+}
+
+std::string
+InstanceController::getEngineVersion() const
+{
+	TouchObject<TEString> path;
+	if (TRACE_TE(TEInstanceGetConfiguredEnginePath, myInstance, path.take()) != TEResultSuccess || !path)
+	{
+		return std::string();
+	}
+	// Installations are usually in a directory named for their version, and the modification time catches one
+	// updated in place
+	std::string version = path->string;
+	std::error_code error;
+	auto modified = std::filesystem::last_write_time(std::filesystem::u8path(version), error);
+	if (!error)
+	{
+		version += "@" + std::to_string(modified.time_since_epoch().count());
+	}
+	return version;
+}
+
+bool
+InstanceController::applyOutputChange()
+{
+	TRACE_SCOPE("InstanceController::applyOutputChange");
+	bool changed = false;
+	if (myLinkLayout)
+	{
+		for (LinkID id = 0; id < myLinkLayout->size(); id++)
+		{
+			const auto& link = myLinkLayout->get(id);
+			if (link.scope == TEScopeOutput && myLinkLayout->takePending(id) && myLinkInterests.read(id))
+			{
+				changed = changed || link.type == TELinkTypeTexture;
+			}
+		}
+	}
+	return changed;
+}
@@ -0,0 +1,338 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
+#include <TouchEngine/TouchEngine.h>
+#include "Renderer.h"
+#include "LinkValueCache.h"
+#include "LinkLayout.h"
+#include "LinkInterestManager.h"
+#include "EventQueue.h"
+#include "FramePipeline.h"
+#include "FramePacer.h"
+#include "RunLoop.h"
+#include "StatisticsCollector.h"
+#include "AudioInput.h"
+#include "InputObjectPool.h"
+#include "TableModel.h"
+#include "ComponentCache.h"
+#include "TestPattern.h"
+
+/*
+* Drives one TEInstance: applies events from TouchEngine's callback threads, keeps a Renderer's images in step
+* with the instance's links, sets inputs and starts frames at their deadlines.
+*
+* update() and pace() must not be called concurrently, but needn't always be called from the same thread.
+*/
+class InstanceController
+{
+public:
+	// runLoop, if not null, is woken whenever the instance has something for us to handle
+	// flipInputImages generates input images bottom row first, for renderers with a bottom-left origin
+	InstanceController(Renderer& renderer, RunLoop* runLoop, bool flipInputImages);
+	InstanceController(const InstanceController& o) = delete;
+	InstanceController& operator=(const InstanceController& o) = delete;
+	~InstanceController();
+
+	// Must be called before load()
+	void		setFrameRate(int32_t numerator, int32_t denominator);
+	// How close to a frame deadline getWaitTime() reaches zero, and pace() spins instead of sleeping
+	void		setSpinThreshold(int64_t nanoseconds);
+	/*
+	* The string data input with identifier is set from table - changes to which are sent with the next frame,
+	* writing only the cells which changed. An empty identifier supplies every string data input without a table
+	* of its own. Null restores the example values.
+	*/
+	void		setTableInput(const std::string& identifier, std::shared_ptr<TableModel> table);
+	// Float buffer inputs receive time-dependent samples from audio rather than the example values, null to stop
+	void		setAudioInput(std::shared_ptr<AudioInput> audio);
+	/*
+	* Must be called before load(). A component the cache has seen before has its layout built as soon as load()
+	* is called, and the renderer is configured without querying the instance.
+	*/
+	void		setComponentCache(std::shared_ptr<ComponentCache> cache);
+	// Input images are drawn once per pattern by patterns, which may be shared by many controllers
+	void		setTestPatterns(std::shared_ptr<TestPatternCache> patterns);
+	/*
+	* Takes effect from the next layout change - width and height are limited to 1 to TestPattern::MaxSize.
+	* Animated patterns are redrawn for every frame, with the frame number stamped on them.
+	*/
+	void		setInputPattern(TestPattern::Type type, uint32_t width, uint32_t height);
+
+	// Creates the instance and begins loading the component at path (UTF-8)
+	TEResult	load(const std::string& path);
+
+	// Returns true if the renderer's images changed and should be drawn
+	bool		update();
+	// Waits briefly for the next frame deadline, and calls update() if it has been reached
+	bool		pace();
+	// How long the caller may block before it should call pace() (nanoseconds)
+	int64_t		getWaitTime() const;
+	/*
+	* Output values are only read for consumers, which are called from update() - see LinkInterestManager.
+	* Output textures are always read for the renderer.
+	*/
+	LinkInterestManager::ConsumerID	subscribe(const std::string& identifier, uint32_t decimation, LinkInterestManager::Consumer consumer);
+	LinkInterestManager::ConsumerID	subscribe(TELinkType type, uint32_t decimation, LinkInterestManager::Consumer consumer);
+	void		unsubscribe(LinkInterestManager::ConsumerID id);
+
+	// True if callback threads have posted events update() hasn't yet applied
+	bool		hasPendingEvents() const;
+
+	// The link tree and input defaults, as cached until the instance has loaded, then as discovered
+	const std::vector<ComponentCache::Link>&
+	getLinks() const
+	{
+		return myComponent.links;
+	}
+
+	// Returns true once if configuration failed, with the instance's result and any message from the renderer
+	bool		takeConfigureError(TEResult& result, std::wstring& message);
+
+	bool
+	isLoaded() const
+	{
+		return myDidLoad;
+	}
+
+	// The result of starting the last frame
+	TEResult
+	getLastResult() const
+	{
+		return myLastResult;
+	}
+
+	// The result of the last TEEventGeneral, which reports errors and warnings not tied to another event - see
+	// TEInstanceGetErrors() for their details
+	TEResult
+	getGeneralResult() const
+	{
+		return myGeneralResult.load(std::memory_order_relaxed);
+	}
+
+	const TouchObject<TEInstance>&
+	getInstance() const
+	{
+		return myInstance;
+	}
+
+	// Counters for the queue of events from TouchEngine's callback threads
+	size_t
+	getEventQueueDepth() const
+	{
+		return myEvents.getDepth();
+	}
+	size_t
+	getEventQueueHighWaterMark() const
+	{
+		return myEvents.getHighWaterMark();
+	}
+	uint64_t
+	getEventQueueOverflowCount() const
+	{
+		return myEvents.getOverflowCount();
+	}
+
+	/*
+	* The start time, in units of 1/TimeRate seconds, of the last frame to finish. TouchEngine only holds the
+	* current value of each output, so outputs read by update() are from this frame or one finishing just after it.
+	*/
+	int64_t
+	getOutputFrameTime() const
+	{
+		return myOutputFrameTime;
+	}
+
+	// Includes the number of frames in flight
+	const FramePipeline::Statistics&
+	getFrameStatistics() const
+	{
+		return myFrames.getStatistics();
+	}
+
+	const FramePacer::Statistics&
+	getPacerStatistics() const
+	{
+		return myPacer.getStatistics();
+	}
+
+	// Hit rates and live counts of the float buffers and tables set on inputs
+	const InputObjectPool&
+	getInputObjects() const
+	{
+		return myInputObjects;
+	}
+
+	// The instance's TEInstanceStatistics and our timings of update(), layout changes and output images
+	StatisticsCollector&
+	getStatistics()
+	{
+		return myStatistics;
+	}
+private:
+	// Events from TouchEngine's callback threads, applied to our state on the update thread
+	struct InstanceEvent
+	{
+		enum class Kind : uint32_t
+		{
+			Configured,
+			Loaded,
+			LayoutChanged,
+			FrameFinished
+		};
+		Kind		kind;
+		TEResult	result = TEResultSuccess;
+		// For FrameFinished, the frame's start time
+		int64_t		timeValue = 0;
+		int32_t		timeScale = 0;
+	};
+
+	static void		eventCallback(TEInstance * instance,
+								TEEvent event,
+								TEResult result,
+								int64_t start_time_value,
+								int32_t start_time_scale,
+								int64_t end_time_value,
+								int32_t end_time_scale,
+								void * info);
+
+	static void		linkEventCallback(TEInstance *instance, TELinkEvent event, const char *identifier, void *info);
+	static void		statisticsCallback(TEInstance *instance, const TEInstanceStatistics *statistics, void *info);
+
+	static constexpr int32_t TimeRate{ 6000 };
+	// The longest pace() waits, so the caller stays responsive (nanoseconds)
+	static constexpr int64_t MaxPaceWait{ 4000000 };
+	// The longest getWaitTime() while a due frame is waiting on the instance, in case we miss a wake (nanoseconds)
+	static constexpr int64_t BlockedWaitLimit{ 100000000 };
+
+	static constexpr size_t	 EventQueueCapacity{ 1024 };
+
+	// The most frames we start before earlier ones finish - reduced automatically if the instance accepts fewer
+	static constexpr size_t	 FramePipelineDepth{ 2 };
+	// Frames started at a reduced depth before trying one frame deeper again, in case the rejection was transient
+	static constexpr uint32_t DepthProbeInterval{ 120 };
+
+	// Double inputs within this of the last value sent are not sent again
+	static constexpr double	 InputValueEpsilon{ 0.0 };
+
+	void	didConfigure(TEResult result);
+	void	didLoad();
+	void	linkLayoutDidChange();
+	void	linkValueChange(const char* identifier);
+	void	endFrame(int64_t time_value, int32_t time_scale, TEResult result);
+	void	postEvent(const InstanceEvent& event);
+	void	applyEvent(const InstanceEvent& event);
+	void	drainEvents();
+	void	getState(bool& configured, bool& loaded, bool& linksChanged, bool& canStartFrame);
+	void	applyLayoutChange();
+	std::vector<ComponentCache::Link>	discoverLinks();
+	void	queryDefaults(ComponentCache::Link& link);
+	// Rebuilds the renderer's images, myInputLinks and myLinkLayout
+	void	buildLayout(const std::vector<ComponentCache::Link>& links);
+	void	configureRenderer();
+	// Draws animated input patterns for frame and submits them to the renderer
+	void	drawInputImages(uint64_t frame);
+	// Replaces myComponent's capabilities with the instance's
+	void	queryCapabilities();
+	// Identifies the TouchDesigner installation the instance was configured with, or empty if unknown
+	std::string	getEngineVersion() const;
+	std::shared_ptr<TableModel>	getTableInput(const std::string& identifier) const;
+	bool	applyOutputChange();
+
+	Renderer&					myRenderer;
+	RunLoop*					myRunLoop;
+	bool						myFlipInputImages;
+	TouchObject<TEInstance>		myInstance;
+
+	int32_t			myRateNumerator{ 60 };
+	int32_t			myRateDenominator{ 1 };
+	bool			myDidLoad{ false };
+	bool			myConfigureRenderer{ false };
+	bool			myConfigureError{ false };
+	bool			myConfigureErrorPending{ false };
+	std::wstring	myConfigureMessage;
+	double			myLastFloatValue{ 0.0 };
+	TEResult		myLastResult{ TEResultSuccess };
+	FramePipeline	myFrames{ FramePipelineDepth };
+	uint32_t		myFramesAtReducedDepth{ 0 };
+	int64_t			myOutputFrameTime{ 0 };
+	SteadyFrameClock	myClock;
+	FramePacer		myPacer{ myClock, myRateNumerator, myRateDenominator };
+	// A frame is due but can't start until the instance has finished loading or finished a frame
+	bool			myFrameBlocked{ false };
+
+	// Input links, flattened from the link tree when the layout changes so update() needn't walk it every frame
+	struct InputLink
+	{
+		std::string		identifier;
+		TELinkType		type;
+		int32_t			count;
+		TELinkIntent	intent;
+		// Renderer input image index, only meaningful for texture links
+		size_t			textureIndex;
+		// Only for string data links
+		std::shared_ptr<TableModel>	table{};
+	};
+	std::vector<InputLink>			myInputLinks;
+	// Last values sent to myInputLinks, by index
+	LinkValueCache					myInputValues{ InputValueEpsilon };
+	// Float buffers and tables for myInputLinks, recycled as frames finish with them
+	InputObjectPool					myInputObjects;
+	// Tables supplied by setTableInput(), by identifier
+	std::unordered_map<std::string, std::shared_ptr<TableModel>>	myTableInputs;
+
+	// Read from the link callback thread with std::atomic_load(), replaced from update() with std::atomic_store()
+	std::shared_ptr<const LinkLayout>	myLinkLayout;
+	bool							myPendingLayoutChange{ false };
+	// Sets the interest of outputs in myLinkLayout
+	LinkInterestManager				myLinkInterests;
+	TEResult						myConfigureResult{ TEResultSuccess };
+
+	// Callback threads post their events here rather than touching the state above
+	EventQueue<InstanceEvent, EventQueueCapacity>	myEvents;
+	// Bits for each InstanceEvent::Kind lost to overflow
+	std::atomic<uint32_t>							myLostEvents{ 0 };
+	std::atomic<TEResult>							myLostConfigureResult{ TEResultSuccess };
+	// Set from TouchEngine's callback threads
+	std::atomic<TEResult>							myGeneralResult{ TEResultSuccess };
+
+	StatisticsCollector								myStatistics;
+
+	// Holds buffers for frames in flight, released with their slots in myFrames
+	std::shared_ptr<AudioInput>						myAudioInput;
+
+	std::shared_ptr<ComponentCache>					myComponentCache;
+
+	std::shared_ptr<TestPatternCache>				myTestPatterns;
+	TestPattern::Type								myInputPattern{ TestPattern::Type::Gradient };
+	uint32_t										myInputImageWidth{ 256 };
+	uint32_t										myInputImageHeight{ 256 };
+	// The pattern of the current layout's input images, with variant 0
+	TestPattern::Key								myLayoutPattern;
+	// Animated patterns drawn for the latest frame, by variant
+	std::vector<std::vector<unsigned char>>			myPatternFrames;
+	// Of the component file, if it could be read
+	bool											myHasComponentKey{ false };
+	uint64_t										myComponentKey{ 0 };
+	// What we know of the component, from the cache or discovered, stored to the cache when it changes
+	ComponentCache::Entry							myComponent;
+	bool											myComponentChanged{ false };
+};
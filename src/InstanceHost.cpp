@@ -0,0 +1,177 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "InstanceHost.h"
+#include "Trace.h"
+#include <algorithm>
+
+InstanceHost::InstanceHost(TEGraphicsContext* context, size_t threadCount)
+	: myRunLoop(RunLoop::create()), myPool(threadCount)
+{
+	myContext.set(context);
+	myThread = std::thread(&InstanceHost::run, this);
+}
+
+InstanceHost::~InstanceHost()
+{
+	myStopping.store(true, std::memory_order_release);
+	myRunLoop->wake();
+	myThread.join();
+}
+
+bool
+InstanceHost::exportStatistics(const std::string& path, StatisticsExporter::Format format, int64_t interval)
+{
+	myStatisticsFile.open(path, std::ios::out | std::ios::app);
+	if (!myStatisticsFile)
+	{
+		return false;
+	}
+	myStatisticsExporter = std::make_unique<StatisticsExporter>(myStatisticsFile, format, interval);
+	return true;
+}
+
+void
+InstanceHost::setComponentCache(std::shared_ptr<ComponentCache> cache)
+{
+	myComponentCache = std::move(cache);
+}
+
+void
+InstanceHost::setTestPatterns(std::shared_ptr<TestPatternCache> patterns)
+{
+	myTestPatterns = std::move(patterns);
+}
+
+void
+InstanceHost::setInputPattern(TestPattern::Type type, uint32_t width, uint32_t height)
+{
+	myInputPattern = type;
+	myInputImageWidth = width;
+	myInputImageHeight = height;
+}
+
+TEResult
+InstanceHost::add(const std::string& path, int32_t rateNumerator, int32_t rateDenominator)
+{
+	auto entry = std::make_unique<Entry>();
+	entry->renderer = std::make_unique<NullRenderer>(myContext);
+	entry->renderer->setup(nullptr);
+	entry->controller = std::make_unique<InstanceController>(*entry->renderer, myRunLoop.get(), false);
+	entry->controller->setFrameRate(rateNumerator, rateDenominator);
+	entry->controller->setSpinThreshold(SpinThreshold);
+	entry->controller->setComponentCache(myComponentCache);
+	if (!myTestPatterns)
+	{
+		// Shared by every instance, so each pattern is only drawn once
+		myTestPatterns = std::make_shared<TestPatternCache>();
+	}
+	entry->controller->setTestPatterns(myTestPatterns);
+	entry->controller->setInputPattern(myInputPattern, myInputImageWidth, myInputImageHeight);
+	entry->label = path;
+
+	TEResult result = entry->controller->load(path);
+	if (result == TEResultSuccess)
+	{
+		{
+			std::lock_guard<std::mutex> guard(myMutex);
+			myEntries.push_back(std::move(entry));
+		}
+		myRunLoop->wake();
+	}
+	return result;
+}
+
+size_t
+InstanceHost::getInstanceCount() const
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	return myEntries.size();
+}
+
+InstanceHost::Status
+InstanceHost::getStatus(size_t index) const
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	const Entry& entry = *myEntries.at(index);
+	Status status;
+	status.loaded = entry.loaded.load(std::memory_order_relaxed);
+	status.failed = entry.failed.load(std::memory_order_relaxed);
+	status.frames = entry.frames.load(std::memory_order_relaxed);
+	return status;
+}
+
+void
+InstanceHost::run()
+{
+	Trace::setThreadName("InstanceHost");
+	while (!myStopping.load(std::memory_order_acquire))
+	{
+		int64_t wait = RunLoop::Infinite;
+		{
+			std::lock_guard<std::mutex> guard(myMutex);
+			for (auto& entry : myEntries)
+			{
+				// Workers wake us when they're done with an entry
+				if (entry->busy.load(std::memory_order_acquire) || entry->failed.load(std::memory_order_relaxed))
+				{
+					continue;
+				}
+				int64_t entryWait = entry->controller->getWaitTime();
+				if (entryWait == 0 || entry->controller->hasPendingEvents())
+				{
+					entry->busy.store(true, std::memory_order_relaxed);
+					Entry* e = entry.get();
+					bool due = entryWait == 0;
+					myPool.submit([this, e, due] { service(*e, due); });
+				}
+				else
+				{
+					wait = (std::min)(wait, entryWait);
+				}
+			}
+		}
+		myRunLoop->wait(wait);
+	}
+}
+
+void
+InstanceHost::service(Entry& entry, bool due)
+{
+	if (due)
+	{
+		entry.controller->pace();
+	}
+	else
+	{
+		// update() only starts frames at their deadlines, so events can be applied early
+		entry.controller->update();
+	}
+
+	TEResult result;
+	std::wstring message;
+	if (entry.controller->takeConfigureError(result, message))
+	{
+		entry.failed.store(true, std::memory_order_relaxed);
+	}
+	entry.loaded.store(entry.controller->isLoaded(), std::memory_order_relaxed);
+	entry.frames.store(entry.controller->getPacerStatistics().frames, std::memory_order_relaxed);
+	if (myStatisticsExporter)
+	{
+		myStatisticsExporter->poll(entry.controller->getStatistics(), entry.label);
+	}
+
+	entry.busy.store(false, std::memory_order_release);
+	myRunLoop->wake();
+}
@@ -0,0 +1,113 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <TouchEngine/TouchEngine.h>
+#include "InstanceController.h"
+#include "NullRenderer.h"
+#include "RunLoop.h"
+#include "StatisticsCollector.h"
+#include "WorkerPool.h"
+
+/*
+* Runs many instances headless in one process. Each instance is paced independently, and is updated on a shared
+* WorkerPool when it is due or has events to handle. A scheduler thread sleeps until one of those happens.
+*
+* Instances can share a TEGraphicsContext, so they render on one device.
+*/
+class InstanceHost
+{
+public:
+	// context, if not null, is used by every instance
+	// A threadCount of 0 uses one worker per hardware thread
+	explicit InstanceHost(TEGraphicsContext* context = nullptr, size_t threadCount = 0);
+	InstanceHost(const InstanceHost& o) = delete;
+	InstanceHost& operator=(const InstanceHost& o) = delete;
+	~InstanceHost();
+
+	// Appends each instance's statistics to a file every interval nanoseconds, labelled with its path
+	// Call before add(), returns false if the file couldn't be opened
+	bool		exportStatistics(const std::string& path, StatisticsExporter::Format format, int64_t interval);
+
+	// Instances added after this share cache, see InstanceController::setComponentCache()
+	void		setComponentCache(std::shared_ptr<ComponentCache> cache);
+	// Instances added after this draw their input images from patterns, see InstanceController::setTestPatterns()
+	void		setTestPatterns(std::shared_ptr<TestPatternCache> patterns);
+	// Instances added after this use the pattern and size for their input images, to load-test texture upload
+	void		setInputPattern(TestPattern::Type type, uint32_t width, uint32_t height);
+
+	// Begins loading the component at path (UTF-8), returning the result of creating the instance
+	TEResult	add(const std::string& path, int32_t rateNumerator, int32_t rateDenominator);
+
+	struct Status
+	{
+		bool		loaded = false;
+		// Configuration failed, the instance is no longer updated
+		bool		failed = false;
+		uint64_t	frames = 0;
+	};
+
+	size_t		getInstanceCount() const;
+	Status		getStatus(size_t index) const;
+
+	size_t
+	getThreadCount() const
+	{
+		return myPool.getThreadCount();
+	}
+private:
+	// Workers would otherwise spin for the pacer's default 2ms before each frame
+	static constexpr int64_t SpinThreshold{ 250000 };
+
+	struct Entry
+	{
+		// Declared first so it outlives the controller
+		std::unique_ptr<NullRenderer>		renderer;
+		std::unique_ptr<InstanceController>	controller;
+		std::string							label;
+		// Set while a worker has the controller
+		std::atomic<bool>					busy{ false };
+		std::atomic<bool>					loaded{ false };
+		std::atomic<bool>					failed{ false };
+		std::atomic<uint64_t>				frames{ 0 };
+	};
+
+	void	run();
+	void	service(Entry& entry, bool due);
+
+	TouchObject<TEGraphicsContext>		myContext;
+	std::ofstream						myStatisticsFile;
+	std::unique_ptr<StatisticsExporter>	myStatisticsExporter;
+	std::unique_ptr<RunLoop>			myRunLoop;
+	std::shared_ptr<ComponentCache>		myComponentCache;
+	std::shared_ptr<TestPatternCache>	myTestPatterns;
+	TestPattern::Type					myInputPattern{ TestPattern::Type::Gradient };
+	uint32_t							myInputImageWidth{ 256 };
+	uint32_t							myInputImageHeight{ 256 };
+	mutable std::mutex					myMutex;
+	std::vector<std::unique_ptr<Entry>>	myEntries;
+	// Destroyed before myEntries, finishing any tasks using them
+	WorkerPool							myPool;
+	std::atomic<bool>					myStopping{ false };
+	std::thread							myThread;
+};
@@ -0,0 +1,179 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "LinkInterestManager.h"
+#include <algorithm>
+
+LinkInterestManager::ConsumerID
+LinkInterestManager::subscribe(const std::string& identifier, uint32_t decimation, Consumer consumer)
+{
+	return add({ InvalidConsumerID, identifier, TELinkTypeDouble, false, decimation, std::move(consumer) });
+}
+
+LinkInterestManager::ConsumerID
+LinkInterestManager::subscribe(TELinkType type, uint32_t decimation, Consumer consumer)
+{
+	return add({ InvalidConsumerID, std::string(), type, true, decimation, std::move(consumer) });
+}
+
+LinkInterestManager::ConsumerID
+LinkInterestManager::add(Subscription subscription)
+{
+	subscription.id = myNextID++;
+	subscription.decimation = std::max(subscription.decimation, 1u);
+	mySubscriptions.push_back(std::move(subscription));
+	bind();
+	return mySubscriptions.back().id;
+}
+
+void
+LinkInterestManager::unsubscribe(ConsumerID id)
+{
+	auto it = std::find_if(mySubscriptions.begin(), mySubscriptions.end(), [id](const Subscription& s) { return s.id == id; });
+	if (it != mySubscriptions.end())
+	{
+		mySubscriptions.erase(it);
+		bind();
+	}
+}
+
+void
+LinkInterestManager::setLayout(TEInstance* instance, std::shared_ptr<const LinkLayout> layout)
+{
+	myInstance = instance;
+	myLayout = std::move(layout);
+	myInterests.assign(myLayout ? myLayout->size() : 0, TELinkInterestAll);
+	bind();
+}
+
+void
+LinkInterestManager::clear()
+{
+	myInstance = nullptr;
+	myLayout.reset();
+	myBindings.clear();
+	myInterests.clear();
+}
+
+void
+LinkInterestManager::bind()
+{
+	myBindings.assign(myLayout ? myLayout->size() : 0, {});
+	if (!myLayout)
+	{
+		return;
+	}
+	for (LinkID id = 0; id < myLayout->size(); id++)
+	{
+		const auto& link = myLayout->get(id);
+		if (link.scope != TEScopeOutput)
+		{
+			continue;
+		}
+		for (size_t i = 0; i < mySubscriptions.size(); i++)
+		{
+			const auto& subscription = mySubscriptions[i];
+			if (subscription.byType ? subscription.type == link.type : subscription.identifier == link.identifier)
+			{
+				// New bindings are due immediately
+				myBindings[id].push_back({ i, 0 });
+			}
+		}
+		if (myBindings[id].empty())
+		{
+			setInterest(id, TELinkInterestNoValues, false);
+		}
+		else if (myInterests[id] == TELinkInterestNoValues)
+		{
+			// We missed any value set while we had no interest, so can only read the next
+			setInterest(id, TELinkInterestSubsequentValues, false);
+		}
+	}
+}
+
+void
+LinkInterestManager::beginFrame()
+{
+	for (LinkID id = 0; id < myBindings.size(); id++)
+	{
+		auto& bindings = myBindings[id];
+		if (bindings.empty())
+		{
+			continue;
+		}
+		for (auto& binding : bindings)
+		{
+			if (binding.countdown > 0)
+			{
+				binding.countdown--;
+			}
+		}
+		if (!isDue(id, 0))
+		{
+			setInterest(id, TELinkInterestNoValues, false);
+		}
+		else if (myInterests[id] == TELinkInterestNoValues)
+		{
+			setInterest(id, TELinkInterestSubsequentValues, false);
+		}
+	}
+}
+
+bool
+LinkInterestManager::read(LinkID id)
+{
+	if (id >= myBindings.size() || !isDue(id, 0) || myInterests[id] == TELinkInterestNoValues)
+	{
+		return false;
+	}
+	const auto& link = myLayout->get(id);
+	for (auto& binding : myBindings[id])
+	{
+		if (binding.countdown == 0)
+		{
+			const auto& subscription = mySubscriptions[binding.subscription];
+			subscription.consumer(myInstance, link);
+			// Counted down by beginFrame(), starting with the next
+			binding.countdown = subscription.decimation;
+		}
+	}
+	// The instance raises the interest to TELinkInterestAll when it delivers a value, so always set it
+	setInterest(id, isDue(id, 1) ? TELinkInterestSubsequentValues : TELinkInterestNoValues, true);
+	return true;
+}
+
+TELinkInterest
+LinkInterestManager::getInterest(LinkID id) const
+{
+	return id < myInterests.size() ? myInterests[id] : TELinkInterestAll;
+}
+
+void
+LinkInterestManager::setInterest(LinkID id, TELinkInterest interest, bool force)
+{
+	if (force || myInterests[id] != interest)
+	{
+		if (myInstance && TEInstanceLinkSetInterest(myInstance, myLayout->get(id).identifier.c_str(), interest) == TEResultSuccess)
+		{
+			myInterests[id] = interest;
+		}
+	}
+}
+
+bool
+LinkInterestManager::isDue(LinkID id, uint32_t frames) const
+{
+	const auto& bindings = myBindings[id];
+	return std::any_of(bindings.begin(), bindings.end(), [frames](const Binding& b) { return b.countdown <= frames; });
+}
@@ -0,0 +1,101 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "LinkLayout.h"
+
+/*
+* Tracks which consumers want the values of an instance's output links, and sets each link's TELinkInterest
+* so the instance does no work for values nobody reads.
+*
+* Outputs without a consumer are set to TELinkInterestNoValues. After each read an output is set to
+* TELinkInterestSubsequentValues, so the instance can recycle the value's resources. A consumer can ask to
+* read only every Nth frame, and outputs with no consumer due in a frame are set to TELinkInterestNoValues
+* for that frame.
+*
+* All functions must be called from the thread which updates the instance.
+*/
+class LinkInterestManager
+{
+public:
+	using ConsumerID = uint32_t;
+	static constexpr ConsumerID InvalidConsumerID = UINT32_MAX;
+
+	// Called with the instance and link when a new value can be read
+	using Consumer = std::function<void(TEInstance*, const LinkLayout::Link&)>;
+
+	LinkInterestManager() = default;
+	LinkInterestManager(const LinkInterestManager& o) = delete;
+	LinkInterestManager& operator=(const LinkInterestManager& o) = delete;
+
+	// Subscriptions outlive layout changes, and apply to whichever link matches in each layout
+	// A decimation of N reads at most every Nth frame
+	ConsumerID	subscribe(const std::string& identifier, uint32_t decimation, Consumer consumer);
+	// Subscribes to every output of the type
+	ConsumerID	subscribe(TELinkType type, uint32_t decimation, Consumer consumer);
+	void		unsubscribe(ConsumerID id);
+
+	// Instances start with every link's interest at TELinkInterestAll
+	void		setLayout(TEInstance* instance, std::shared_ptr<const LinkLayout> layout);
+	void		clear();
+
+	// Advances decimation by a frame
+	void		beginFrame();
+
+	// Gives a changed output to each consumer due to read it, returning true if any did
+	bool		read(LinkID id);
+
+	// The interest last set for a link
+	TELinkInterest	getInterest(LinkID id) const;
+private:
+	struct Subscription
+	{
+		ConsumerID		id;
+		std::string		identifier;
+		TELinkType		type;
+		bool			byType;
+		uint32_t		decimation;
+		Consumer		consumer;
+	};
+
+	// A subscription matched to a link in the current layout
+	struct Binding
+	{
+		size_t			subscription;
+		// Frames until the subscription is due to read the link
+		uint32_t		countdown;
+	};
+
+	ConsumerID	add(Subscription subscription);
+	void		bind();
+	void		setInterest(LinkID id, TELinkInterest interest, bool force);
+	// True if any subscription will be due to read the link within this many frames
+	bool		isDue(LinkID id, uint32_t frames) const;
+
+	TEInstance*							myInstance{ nullptr };
+	std::shared_ptr<const LinkLayout>	myLayout;
+	std::vector<Subscription>			mySubscriptions;
+	ConsumerID							myNextID{ 0 };
+	// By LinkID
+	std::vector<std::vector<Binding>>	myBindings;
+	std::vector<TELinkInterest>			myInterests;
+};
@@ -0,0 +1,61 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "LinkLayout.h"
+
+LinkLayout::LinkLayout(std::vector<Link> links)
+	: myLinks(std::move(links)), myPending(new std::atomic<bool>[myLinks.size()])
+{
+	// Keys view the strings in myLinks, which is not modified after this point
+	myIndex.reserve(myLinks.size());
+	for (LinkID id = 0; id < myLinks.size(); id++)
+	{
+		const Link& link = myLinks[id];
+		myIndex.emplace(link.identifier, id);
+		if (link.scope == TEScopeOutput && link.type == TELinkTypeTexture)
+		{
+			myOutputTextures.push_back(id);
+		}
+	}
+	markAllPending();
+}
+
+LinkID
+LinkLayout::find(std::string_view identifier) const
+{
+	auto it = myIndex.find(identifier);
+	return it == myIndex.end() ? InvalidLinkID : it->second;
+}
+
+void
+LinkLayout::markPending(LinkID id) const
+{
+	myPending[id].store(true, std::memory_order_release);
+}
+
+void
+LinkLayout::markAllPending() const
+{
+	for (size_t i = 0; i < myLinks.size(); i++)
+	{
+		myPending[i].store(true, std::memory_order_release);
+	}
+}
+
+bool
+LinkLayout::takePending(LinkID id) const
+{
+	// Test before exchanging so an idle link doesn't take the cache line exclusively
+	return myPending[id].load(std::memory_order_relaxed) && myPending[id].exchange(false, std::memory_order_acquire);
+}
@@ -0,0 +1,88 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Dense index of a link within a LinkLayout
+using LinkID = uint32_t;
+constexpr LinkID InvalidLinkID = UINT32_MAX;
+
+/*
+* An immutable snapshot of an instance's links, interning each identifier as a LinkID.
+*
+* A new LinkLayout is built whenever the link layout changes, and published to the link callback thread
+* with std::atomic_store(). Looking up an identifier and marking it pending neither allocates nor
+* compares more than the one matching string.
+*/
+class LinkLayout
+{
+public:
+	struct Link
+	{
+		std::string		identifier;
+		TELinkType		type;
+		TEScope			scope;
+		// Renderer image index, only meaningful for texture links
+		size_t			textureIndex;
+	};
+
+	explicit LinkLayout(std::vector<Link> links);
+	LinkLayout(const LinkLayout& o) = delete;
+	LinkLayout& operator=(const LinkLayout& o) = delete;
+
+	size_t
+	size() const
+	{
+		return myLinks.size();
+	}
+
+	// Returns InvalidLinkID if the identifier is not part of this layout
+	LinkID		find(std::string_view identifier) const;
+
+	const Link&
+	get(LinkID id) const
+	{
+		return myLinks[id];
+	}
+
+	// Output texture links, in renderer image order
+	const std::vector<LinkID>&
+	getOutputTextures() const
+	{
+		return myOutputTextures;
+	}
+
+	/*
+	* Pending flags may be set from any thread, and are all initially set so a new layout fetches every value.
+	*/
+	void		markPending(LinkID id) const;
+	void		markAllPending() const;
+	// Clears the flag, returning true if it was set
+	bool		takePending(LinkID id) const;
+private:
+	std::vector<Link>								myLinks;
+	std::unordered_map<std::string_view, LinkID>	myIndex;
+	std::vector<LinkID>								myOutputTextures;
+	std::unique_ptr<std::atomic<bool>[]>			myPending;
+};
@@ -0,0 +1,193 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "LinkValueCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+LinkValueCache::LinkValueCache(double epsilon)
+	: myEpsilon(epsilon)
+{
+}
+
+void
+LinkValueCache::setEpsilon(double epsilon)
+{
+	myEpsilon = epsilon;
+}
+
+void
+LinkValueCache::reset(size_t count)
+{
+	myEntries.clear();
+	myEntries.resize(count);
+	myDirty.clear();
+	markAllDirty();
+}
+
+bool
+LinkValueCache::updateDoubles(size_t index, const double* values, int32_t count)
+{
+	auto& entry = myEntries.at(index);
+	bool changed = !entry.valid || entry.doubles.size() != static_cast<size_t>(count);
+	for (int32_t i = 0; !changed && i < count; i++)
+	{
+		changed = std::fabs(values[i] - entry.doubles[i]) > myEpsilon;
+	}
+	if (changed)
+	{
+		entry.doubles.assign(values, values + count);
+		entry.valid = true;
+	}
+	return setDirty(index, changed);
+}
+
+bool
+LinkValueCache::updateInts(size_t index, const int32_t* values, int32_t count)
+{
+	auto& entry = myEntries.at(index);
+	bool changed = !entry.valid || entry.ints.size() != static_cast<size_t>(count) || !std::equal(values, values + count, entry.ints.begin());
+	if (changed)
+	{
+		entry.ints.assign(values, values + count);
+		entry.valid = true;
+	}
+	return setDirty(index, changed);
+}
+
+bool
+LinkValueCache::updateString(size_t index, const char* value)
+{
+	return updateHash(index, value ? hash(value, std::strlen(value)) : 0);
+}
+
+bool
+LinkValueCache::updateFloatBuffer(size_t index, const float* const* channels, int32_t channelCount, uint32_t valueCount)
+{
+	uint64_t result = hash(&channelCount, sizeof(channelCount));
+	result = hash(&valueCount, sizeof(valueCount), result);
+	for (int32_t channel = 0; channel < channelCount; channel++)
+	{
+		result = hash(channels[channel], sizeof(float) * valueCount, result);
+	}
+	return updateHash(index, result);
+}
+
+bool
+LinkValueCache::updateTable(size_t index, const TETable* table)
+{
+	int32_t rows = table ? TETableGetRowCount(table) : 0;
+	int32_t columns = table ? TETableGetColumnCount(table) : 0;
+	uint64_t result = hash(&rows, sizeof(rows));
+	result = hash(&columns, sizeof(columns), result);
+	for (int32_t row = 0; row < rows; row++)
+	{
+		for (int32_t column = 0; column < columns; column++)
+		{
+			result = hashCell(TETableGetStringValue(table, row, column), result);
+		}
+	}
+	return updateHash(index, result);
+}
+
+bool
+LinkValueCache::updateTable(size_t index, int32_t rows, int32_t columns, const char* const* cells)
+{
+	uint64_t result = hash(&rows, sizeof(rows));
+	result = hash(&columns, sizeof(columns), result);
+	for (int32_t i = 0; i < rows * columns; i++)
+	{
+		result = hashCell(cells[i], result);
+	}
+	return updateHash(index, result);
+}
+
+bool
+LinkValueCache::updateHash(size_t index, uint64_t hash)
+{
+	auto& entry = myEntries.at(index);
+	bool changed = !entry.valid || entry.hash != hash;
+	entry.hash = hash;
+	entry.valid = true;
+	return setDirty(index, changed);
+}
+
+bool
+LinkValueCache::isDirty(size_t index) const
+{
+	return myEntries.at(index).dirty;
+}
+
+void
+LinkValueCache::markDirty(size_t index)
+{
+	setDirty(index, true);
+}
+
+void
+LinkValueCache::markAllDirty()
+{
+	for (size_t i = 0; i < myEntries.size(); i++)
+	{
+		setDirty(i, true);
+	}
+}
+
+void
+LinkValueCache::markClean(size_t index)
+{
+	auto& entry = myEntries.at(index);
+	if (entry.dirty)
+	{
+		entry.dirty = false;
+		// Move the last dirty index into this one's place
+		size_t last = myDirty.back();
+		myDirty[entry.dirtyPosition] = last;
+		myEntries[last].dirtyPosition = entry.dirtyPosition;
+		myDirty.pop_back();
+	}
+}
+
+bool
+LinkValueCache::setDirty(size_t index, bool changed)
+{
+	auto& entry = myEntries.at(index);
+	if (changed && !entry.dirty)
+	{
+		entry.dirty = true;
+		entry.dirtyPosition = myDirty.size();
+		myDirty.push_back(index);
+	}
+	return entry.dirty;
+}
+
+uint64_t
+LinkValueCache::hashCell(const char* cell, uint64_t hash)
+{
+	// Include the terminator so cell boundaries affect the hash
+	return cell ? LinkValueCache::hash(cell, std::strlen(cell) + 1, hash) : LinkValueCache::hash("", 1, hash);
+}
+
+uint64_t
+LinkValueCache::hash(const void* data, size_t length, uint64_t hash)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
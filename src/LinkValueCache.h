@@ -0,0 +1,94 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstdint>
+#include <vector>
+
+/*
+* Remembers the last value sent to each input link so unchanged values needn't be sent again.
+*
+* Links are addressed by index. Pass each frame's value to the matching update function, which
+* returns true if the link is dirty and the value should be sent. Once a value has been sent
+* successfully, call markClean() - a link stays dirty until then, so failed sends are retried.
+*/
+class LinkValueCache
+{
+public:
+	explicit LinkValueCache(double epsilon = 0.0);
+
+	// Doubles which differ from the last value by no more than epsilon are treated as unchanged
+	void	setEpsilon(double epsilon);
+	double
+	getEpsilon() const
+	{
+		return myEpsilon;
+	}
+
+	// Forgets all values and sizes the cache for count links, all of which will be dirty
+	void	reset(size_t count);
+
+	size_t
+	size() const
+	{
+		return myEntries.size();
+	}
+
+	bool	updateDoubles(size_t index, const double* values, int32_t count);
+	bool	updateInts(size_t index, const int32_t* values, int32_t count);
+	bool	updateString(size_t index, const char* value);
+	bool	updateFloatBuffer(size_t index, const float* const* channels, int32_t channelCount, uint32_t valueCount);
+	bool	updateTable(size_t index, const TETable* table);
+	// cells is row-major, rows * columns long - equal content hashes equally to the TETable form
+	bool	updateTable(size_t index, int32_t rows, int32_t columns, const char* const* cells);
+	// For values hashed by the caller
+	bool	updateHash(size_t index, uint64_t hash);
+
+	bool	isDirty(size_t index) const;
+	void	markDirty(size_t index);
+	void	markAllDirty();
+	void	markClean(size_t index);
+
+	// Indices of the currently dirty links, in no particular order
+	const std::vector<size_t>&
+	getDirty() const
+	{
+		return myDirty;
+	}
+
+	// 64-bit FNV-1a, continuing from hash
+	static uint64_t	hash(const void* data, size_t length, uint64_t hash = HashSeed);
+	static constexpr uint64_t HashSeed{ 14695981039346656037ULL };
+private:
+	struct Entry
+	{
+		std::vector<double>		doubles;
+		std::vector<int32_t>	ints;
+		uint64_t				hash{ 0 };
+		bool					valid{ false };
+		bool					dirty{ false };
+		// Position in myDirty while dirty, so markClean() needn't search for it
+		size_t					dirtyPosition{ 0 };
+	};
+
+	bool		setDirty(size_t index, bool changed);
+	static uint64_t	hashCell(const char* cell, uint64_t hash);
+
+	double				myEpsilon;
+	std::vector<Entry>	myEntries;
+	std::vector<size_t>	myDirty;
+};
@@ -0,0 +1,141 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "NullRenderer.h"
+#include "Trace.h"
+
+NullRenderer::NullRenderer(TEGraphicsContext* context)
+	: Renderer()
+{
+	myContext.set(context);
+}
+
+NullRenderer::~NullRenderer()
+{
+}
+
+bool
+NullRenderer::setup(HWND window)
+{
+	// window may be null
+	return Renderer::setup(window);
+}
+
+void
+NullRenderer::stop()
+{
+	myInputImages.clear();
+	myOutputUpdateCounts.clear();
+	Renderer::stop();
+}
+
+bool
+NullRenderer::render()
+{
+	TRACE_SCOPE("NullRenderer::render");
+	myRenderCount++;
+	return true;
+}
+
+bool
+NullRenderer::supportsUploadFormat(PixelFormat format) const
+{
+	// Images are only kept in memory, so any format with a texture format will do
+	return GetTextureFormat(format) != TETextureFormatInvalid;
+}
+
+void
+NullRenderer::createInputImage(const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	TRACE_SCOPE("NullRenderer::createInputImage");
+	// Store rows tightly packed, whatever the source row pitch
+	Image image;
+	image.bytesPerRow = static_cast<size_t>(width) * GetBytesPerPixel(format);
+	image.width = width;
+	image.height = height;
+	image.format = format;
+	image.pixels.resize(image.bytesPerRow * height);
+	ConvertPixels(pixels, bytesPerRow, format, image.pixels.data(), image.bytesPerRow, format, width, height);
+	myInputImages.push_back(std::move(image));
+}
+
+void
+NullRenderer::uploadInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	TRACE_SCOPE("NullRenderer::uploadInputImage");
+	Image& image = myInputImages.at(index);
+	ConvertPixels(pixels, bytesPerRow, format, image.pixels.data(), image.bytesPerRow, image.format, width, height);
+}
+
+bool
+NullRenderer::getInputImage(size_t index, TouchObject<TETexture>& texture, TouchObject<TESemaphore>& semaphore, uint64_t& waitValue)
+{
+	TRACE_SCOPE("NullRenderer::getInputImage");
+	if (inputDidChange(index))
+	{
+		// TouchEngine has no CPU-memory texture type, so the link is given no texture once after each change
+		texture.reset();
+		semaphore.reset();
+		waitValue = 0;
+
+		markInputUnchanged(index);
+		return true;
+	}
+	return false;
+}
+
+void
+NullRenderer::clearInputImages()
+{
+	myInputImages.clear();
+	Renderer::clearInputImages();
+}
+
+void
+NullRenderer::addOutputImage()
+{
+	myOutputUpdateCounts.push_back(0);
+	Renderer::addOutputImage();
+}
+
+bool
+NullRenderer::updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier)
+{
+	TRACE_SCOPE("NullRenderer::updateOutputImage");
+	TouchObject<TETexture> texture;
+	TEResult result = TRACE_TE(TEInstanceLinkGetTextureValue, instance, identifier.c_str(), TELinkValueCurrent, texture.take());
+	if (result == TEResultSuccess)
+	{
+		// The texture is retained so TouchEngine sees the same ownership as with a GPU renderer, but never read
+		setOutputImage(index, texture);
+		myOutputUpdateCounts.at(index)++;
+		return true;
+	}
+	setOutputImage(index, nullptr);
+	return false;
+}
+
+void
+NullRenderer::clearOutputImages()
+{
+	myOutputUpdateCounts.clear();
+	Renderer::clearOutputImages();
+}
+
+const std::wstring&
+NullRenderer::getDeviceName() const
+{
+	static const std::wstring Name(L"Headless");
+	return Name;
+}
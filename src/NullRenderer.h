@@ -0,0 +1,93 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include "Renderer.h"
+#include <vector>
+
+/*
+* A renderer without a window or a GPU, for running instances headless.
+* Input images are kept in CPU memory, and output textures are retained but never drawn.
+* A TEGraphicsContext may be supplied so several instances share one device.
+*/
+class NullRenderer :
+	public Renderer
+{
+public:
+	explicit NullRenderer(TEGraphicsContext* context = nullptr);
+	virtual ~NullRenderer();
+
+	virtual TEGraphicsContext*
+	getTEContext() const override
+	{
+		// Without a graphics context, TouchEngine chooses its own device
+		return myContext;
+	}
+
+	virtual bool	setup(HWND window) override;
+	virtual void	stop() override;
+	virtual bool	render() override;
+
+	virtual size_t
+	getInputImageCount() const override
+	{
+		return myInputImages.size();
+	}
+	virtual bool		getInputImage(size_t index, TouchObject<TETexture>& texture, TouchObject<TESemaphore>& semaphore, uint64_t& waitValue) override;
+	virtual void		clearInputImages() override;
+	virtual void		addOutputImage() override;
+	virtual bool		updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier) override;
+	virtual void		clearOutputImages() override;
+
+	virtual const std::wstring& getDeviceName() const override;
+
+	struct Image
+	{
+		std::vector<unsigned char>	pixels;
+		size_t						bytesPerRow = 0;
+		int							width = 0;
+		int							height = 0;
+		PixelFormat					format = PixelFormat::BGRA8;
+	};
+
+	const Image&
+	getInputImageData(size_t index) const
+	{
+		return myInputImages.at(index);
+	}
+
+	// The number of times each output has received a new value
+	uint64_t
+	getOutputUpdateCount(size_t index) const
+	{
+		return myOutputUpdateCounts.at(index);
+	}
+
+	uint64_t
+	getRenderCount() const
+	{
+		return myRenderCount;
+	}
+protected:
+	virtual bool	supportsUploadFormat(PixelFormat format) const override;
+	virtual void	createInputImage(const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void	uploadInputImage(size_t index, const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+private:
+	TouchObject<TEGraphicsContext>	myContext;
+	std::vector<Image>		myInputImages;
+	std::vector<uint64_t>	myOutputUpdateCounts;
+	uint64_t				myRenderCount{ 0 };
+};
@@ -15,6 +15,7 @@
 #include "stdafx.h"
 #include "OpenGLRenderer.h"
 #include "Strings.h"
+#include "Trace.h"
 #include <TouchEngine/TouchEngine.h>
 #include <TouchEngine/TEOpenGL.h>
 
@@ -136,12 +137,19 @@ OpenGLRenderer::setup(HWND window)
 	return success;
 }
 
+void
+OpenGLRenderer::getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities)
+{
+	Renderer::getCapabilities(instance, capabilities);
+	capabilities.openGLTextures = TEOpenGLContextSupportsTexturesForInstance(myContext, instance);
+}
+
 bool
-OpenGLRenderer::configure(TEInstance* instance, std::wstring& error)
+OpenGLRenderer::configure(const InstanceCapabilities& capabilities, std::wstring& error)
 {
-	if (TEOpenGLContextSupportsTexturesForInstance(myContext, instance))
+	if (capabilities.openGLTextures)
 	{
-		return true;
+		return Renderer::configure(capabilities, error);
 	}
 	error = L"OpenGL is not supported. The selected GPU does not have needed features.";
 	error += L"\nThe selected GPU is: ";
@@ -180,6 +188,7 @@ OpenGLRenderer::stop()
 bool
 OpenGLRenderer::render()
 {
+	TRACE_SCOPE("OpenGLRenderer::render");
 	wglMakeCurrent(myDC, myRenderingContext);
 	
 	glClearColor(myBackgroundColor[0], myBackgroundColor[1], myBackgroundColor[2], 1.0);
@@ -197,7 +206,10 @@ OpenGLRenderer::render()
 	
 	glFlush();
 
-	SwapBuffers(myDC);
+	{
+		TRACE_SCOPE("OpenGLRenderer::swapBuffers");
+		SwapBuffers(myDC);
+	}
 
 	wglMakeCurrent(nullptr, nullptr);
 	return true;
@@ -209,31 +221,58 @@ OpenGLRenderer::getInputImageCount() const
 	return myInputImages.size();
 }
 
+bool
+OpenGLRenderer::supportsUploadFormat(PixelFormat format) const
+{
+	// Every format with a texture format is core in the GL versions TouchEngine supports
+	return GetTextureFormat(format) != TETextureFormatInvalid;
+}
+
 void
-OpenGLRenderer::addInputImage(const unsigned char * rgba, size_t bytesPerRow, int width, int height)
+OpenGLRenderer::createInputImage(const unsigned char * pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
 {
+	TRACE_SCOPE("OpenGLRenderer::createInputImage");
 	wglMakeCurrent(myDC, myRenderingContext);
 	
 	myInputImages.emplace_back();
 	myInputImages.back().setup(myVAIndex, myTAIndex);
-	myInputImages.back().update(OpenGLTexture(rgba, bytesPerRow, width, height));
+	myInputImages.back().update(OpenGLTexture(pixels, bytesPerRow, width, height, format));
 	
 	wglMakeCurrent(nullptr, nullptr);
+}
 
-	Renderer::addInputImage(rgba, bytesPerRow, width, height);
+void
+OpenGLRenderer::beginInputImageUpload()
+{
+	wglMakeCurrent(myDC, myRenderingContext);
+}
+
+void
+OpenGLRenderer::uploadInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	TRACE_SCOPE("OpenGLRenderer::uploadInputImage");
+	// A new texture, as TouchEngine may still hold a reference to the old one
+	myInputImages[index].update(OpenGLTexture(pixels, bytesPerRow, width, height, format));
+}
+
+void
+OpenGLRenderer::endInputImageUpload()
+{
+	wglMakeCurrent(nullptr, nullptr);
 }
 
 bool
 OpenGLRenderer::getInputImage(size_t index, TouchObject<TETexture> & texture, TouchObject<TESemaphore> & semaphore, uint64_t & waitValue)
 {
+	TRACE_SCOPE("OpenGLRenderer::getInputImage");
 	if (inputDidChange(index))
 	{
 		// Create a reference-counted reference to the same texture
 		OpenGLTexture* copied = new OpenGLTexture(myInputImages[index].getTexture());
 
-		TEOpenGLTexture* out = TEOpenGLTextureCreate(copied->getName(),
+		TEOpenGLTexture* out = TRACE_TE(TEOpenGLTextureCreate, copied->getName(),
 			GL_TEXTURE_2D,
-			GL_RGBA8,
+			copied->getInternalFormat(),
 			copied->getWidth(),
 			copied->getHeight(),
 			TETextureOriginBottomLeft,
@@ -275,26 +314,27 @@ OpenGLRenderer::addOutputImage()
 
 bool OpenGLRenderer::updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier)
 {
+	TRACE_SCOPE("OpenGLRenderer::updateOutputImage");
 	bool success = false;
 	if (index < myOutputImages.size())
 	{
 		const auto& source = myOutputImages.at(index).getTexture().getSource();
 		if (source)
 		{
-			TEOpenGLTextureUnlock(source);
+			TRACE_TE(TEOpenGLTextureUnlock, source);
 		}
 	}
 	TouchObject<TETexture> texture;
-	TEResult result = TEInstanceLinkGetTextureValue(instance, identifier.c_str(), TELinkValueCurrent, texture.take());
+	TEResult result = TRACE_TE(TEInstanceLinkGetTextureValue, instance, identifier.c_str(), TELinkValueCurrent, texture.take());
 	if (result == TEResultSuccess)
 	{
 		setOutputImage(index, texture);
 		if (texture && TETextureGetType(texture) == TETextureTypeD3DShared)
 		{
 			TouchObject<TEOpenGLTexture> created;
-			if (TEOpenGLContextGetTexture(myContext, static_cast<TED3DSharedTexture*>(texture.get()), created.take()) == TEResultSuccess)
+			if (TRACE_TE(TEOpenGLContextGetTexture, myContext, static_cast<TED3DSharedTexture*>(texture.get()), created.take()) == TEResultSuccess)
 			{
-				if (TEOpenGLTextureLock(created) == TEResultSuccess)
+				if (TRACE_TE(TEOpenGLTextureLock, created) == TEResultSuccess)
 				{
 					myOutputImages.at(index).update(OpenGLTexture(created));
 					success = true;
@@ -49,12 +49,12 @@ public:
 	}
 
 	virtual bool	setup(HWND window);
-	virtual bool	configure(TEInstance* instance, std::wstring& error) override;
+	virtual void	getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities) override;
+	virtual bool	configure(const InstanceCapabilities& capabilities, std::wstring& error) override;
 	virtual void	resize(int width, int height) override;
 	virtual void	stop();
 	virtual bool	render();
 	virtual size_t	getInputImageCount() const;
-	virtual void	addInputImage(const unsigned char *rgba, size_t bytesPerRow, int width, int height) override;
 	virtual void	clearInputImages() override;
 	virtual void	addOutputImage() override;
 	virtual bool	updateOutputImage(const TouchObject<TEInstance>& instance, size_t index, const std::string& identifier) override;
@@ -62,6 +62,12 @@ public:
 	virtual bool	getInputImage(size_t index, TouchObject<TETexture>& texture, TouchObject<TESemaphore>& semaphore, uint64_t& waitValue) override;
 
 	virtual const std::wstring& getDeviceName() const override;
+protected:
+	virtual bool	supportsUploadFormat(PixelFormat format) const override;
+	virtual void	createInputImage(const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void	beginInputImageUpload() override;
+	virtual void	uploadInputImage(size_t index, const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) override;
+	virtual void	endInputImageUpload() override;
 private:
 	static const char* VertexShader;
 	static const char* FragmentShader;
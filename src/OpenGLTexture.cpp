@@ -15,23 +15,70 @@
 #include "stdafx.h"
 #include "OpenGLTexture.h"
 #include <TouchEngine/TEOpenGL.h>
+#include <vector>
+
+namespace
+{
+	struct TransferFormat
+	{
+		GLint	internalFormat;
+		GLenum	format;
+		GLenum	type;
+	};
+
+	TransferFormat
+	getTransferFormat(PixelFormat format)
+	{
+		switch (format)
+		{
+		case PixelFormat::RGBA8:
+			return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE };
+		case PixelFormat::R8:
+			return { GL_R8, GL_RED, GL_UNSIGNED_BYTE };
+		case PixelFormat::RGBA16:
+			return { GL_RGBA16, GL_RGBA, GL_UNSIGNED_SHORT };
+		case PixelFormat::RGBA16F:
+			return { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT };
+		case PixelFormat::RGBA32F:
+			return { GL_RGBA32F, GL_RGBA, GL_FLOAT };
+		case PixelFormat::RGB10A2:
+			return { GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV };
+		default:
+			return { GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE };
+		}
+	}
+}
 
 OpenGLTexture::OpenGLTexture()
-	: myWidth(0), myHeight(0), myFlipped(false)
+	: myWidth(0), myHeight(0), myInternalFormat(GL_RGBA8), myFlipped(false)
 {
 }
 
-OpenGLTexture::OpenGLTexture(const unsigned char * rgba, size_t bytesPerRow, GLsizei width, GLsizei height)
+OpenGLTexture::OpenGLTexture(const unsigned char * pixels, size_t bytesPerRow, GLsizei width, GLsizei height, PixelFormat format)
 	: myWidth(width), myHeight(height), myFlipped(false)
 {
-	if (bytesPerRow != width * 4LL)
+	TransferFormat transfer = getTransferFormat(format);
+	myInternalFormat = transfer.internalFormat;
+
+	// GL can only skip whole pixels at the end of each row, so other padding is removed first
+	size_t pixelSize = GetBytesPerPixel(format);
+	std::vector<unsigned char> packed;
+	if (bytesPerRow % pixelSize != 0)
 	{
-		throw "Needs work";
+		packed.resize(pixelSize * width * height);
+		ConvertPixels(pixels, bytesPerRow, format, packed.data(), pixelSize * width, format, width, height);
+		pixels = packed.data();
+		bytesPerRow = pixelSize * width;
 	}
+
 	GLuint name;
 	glGenTextures(1, &name);
 	glBindTexture(GL_TEXTURE_2D, name);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, rgba);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(bytesPerRow / pixelSize));
+	glTexImage2D(GL_TEXTURE_2D, 0, transfer.internalFormat, width, height, 0, transfer.format, transfer.type, pixels);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -44,7 +91,8 @@ OpenGLTexture::OpenGLTexture(const unsigned char * rgba, size_t bytesPerRow, GLs
 }
 
 OpenGLTexture::OpenGLTexture(const TouchObject<TEOpenGLTexture> &source)
-	: mySource(source), myWidth(TEOpenGLTextureGetWidth(source)), myHeight(TEOpenGLTextureGetHeight(source)), myFlipped(TETextureGetOrigin(source) != TETextureOriginBottomLeft)
+	: mySource(source), myWidth(TEOpenGLTextureGetWidth(source)), myHeight(TEOpenGLTextureGetHeight(source)),
+		myInternalFormat(TEOpenGLTextureGetInternalFormat(source)), myFlipped(TETextureGetOrigin(source) != TETextureOriginBottomLeft)
 {
 	myName = std::make_shared<GLuint>(TEOpenGLTextureGetName(source));
 }
@@ -67,6 +115,12 @@ OpenGLTexture::getHeight() const
 	return myHeight;
 }
 
+GLint
+OpenGLTexture::getInternalFormat() const
+{
+	return myInternalFormat;
+}
+
 bool
 OpenGLTexture::getFlipped() const
 {
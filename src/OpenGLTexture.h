@@ -17,17 +17,20 @@
 #include <memory>
 #include <functional>
 #include <TouchEngine/TouchObject.h>
+#include "PixelFormat.h"
 
 class OpenGLTexture
 {
 public:
 	OpenGLTexture();
-	OpenGLTexture(const unsigned char *rgba, size_t bytesPerRow, GLsizei width, GLsizei height);
+	// Rows may have any pitch
+	OpenGLTexture(const unsigned char *pixels, size_t bytesPerRow, GLsizei width, GLsizei height, PixelFormat format = PixelFormat::BGRA8);
 	OpenGLTexture(const TouchObject<TEOpenGLTexture> &texture);
 
 	GLuint	getName() const;
 	GLsizei getWidth() const;
 	GLsizei getHeight() const;
+	GLint	getInternalFormat() const;
 	bool	getFlipped() const;
 	bool	isValid() const;
 	constexpr const TouchObject<TEOpenGLTexture> &
@@ -40,6 +43,7 @@ private:
 	std::shared_ptr<GLuint> myName;
 	GLsizei		myWidth;
 	GLsizei		myHeight;
+	GLint		myInternalFormat;
 	bool		myFlipped;
 };
 
@@ -0,0 +1,614 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "PixelFormat.h"
+#include <cstring>
+#include <utility>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define PIXEL_FORMAT_SSE
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PIXEL_FORMAT_TARGET(features)
+#else
+#include <cpuid.h>
+// Lets a function use instructions beyond the compiler's target, once we know the processor has them
+#define PIXEL_FORMAT_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+namespace
+{
+	using RowConversion = void (*)(const unsigned char* source, unsigned char* destination, size_t width);
+
+	constexpr uint32_t Opaque{ 0xFF000000 };
+
+	struct Features
+	{
+		bool	ssse3 = false;
+		bool	f16c = false;
+	};
+
+	Features
+	detectFeatures()
+	{
+		Features features;
+#ifdef PIXEL_FORMAT_SSE
+		uint32_t ecx = 0;
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		ecx = static_cast<uint32_t>(info[2]);
+#else
+		unsigned int eax, ebx, ecx1, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx))
+		{
+			return features;
+		}
+		ecx = ecx1;
+#endif
+		features.ssse3 = (ecx & (1u << 9)) != 0;
+		// F16C instructions are VEX-encoded, so also need the OS to save AVX state
+		if ((ecx & (1u << 27)) != 0 && (ecx & (1u << 29)) != 0)
+		{
+#ifdef _MSC_VER
+			uint64_t xcr0 = _xgetbv(0);
+#else
+			uint32_t low, high;
+			__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			uint64_t xcr0 = (static_cast<uint64_t>(high) << 32) | low;
+#endif
+			features.f16c = (xcr0 & 6) == 6;
+		}
+#endif
+		return features;
+	}
+
+	const Features&
+	getFeatures()
+	{
+		static const Features features = detectFeatures();
+		return features;
+	}
+
+	uint32_t
+	load32(const unsigned char* source)
+	{
+		uint32_t value;
+		memcpy(&value, source, sizeof(value));
+		return value;
+	}
+
+	void
+	store32(unsigned char* destination, uint32_t value)
+	{
+		memcpy(destination, &value, sizeof(value));
+	}
+
+	uint32_t
+	swapRedBlue(uint32_t pixel)
+	{
+		uint32_t redBlue = pixel & 0x00FF00FF;
+		return (pixel & 0xFF00FF00) | (redBlue << 16) | (redBlue >> 16);
+	}
+
+	// Packs 8-bit components in RGBA order, or BGRA if Swap
+	template <bool Swap>
+	uint32_t
+	packPixel(uint32_t red, uint32_t green, uint32_t blue, uint32_t alpha)
+	{
+		return Swap ? (blue | (green << 8) | (red << 16) | (alpha << 24)) : (red | (green << 8) | (blue << 16) | (alpha << 24));
+	}
+
+	// Matches the SSE path, including for NaN, which becomes 1
+	uint32_t
+	floatToUnorm8(float value)
+	{
+		value = value < 1.0f ? value : 1.0f;
+		value = value > 0.0f ? value : 0.0f;
+		return static_cast<uint32_t>(static_cast<int>(value * 255.0f + 0.5f));
+	}
+
+	float
+	halfToFloat(uint16_t half)
+	{
+		uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+		uint32_t exponent = (half >> 10) & 0x1F;
+		uint32_t mantissa = half & 0x3FF;
+		uint32_t bits;
+		if (exponent == 0)
+		{
+			// Zero or subnormal
+			float value = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+			return sign ? -value : value;
+		}
+		else if (exponent == 31)
+		{
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		}
+		else
+		{
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Rounds to nearest even, as F16C does
+	uint16_t
+	floatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		uint32_t sign = (bits >> 16) & 0x8000;
+		bits &= 0x7FFFFFFF;
+		uint32_t half;
+		if (bits > 0x7F800000)
+		{
+			// NaN, kept quiet with the top of its payload
+			half = 0x7E00 | ((bits >> 13) & 0x3FF);
+		}
+		else if (bits >= 0x47800000)
+		{
+			half = 0x7C00;
+		}
+		else if (bits < 0x38800000)
+		{
+			// Subnormal, rounded by adding a value which leaves the half's bits at the bottom of the mantissa
+			const uint32_t magicBits = 126u << 23;
+			float magic;
+			memcpy(&magic, &magicBits, sizeof(magic));
+			float rounded;
+			memcpy(&rounded, &bits, sizeof(rounded));
+			rounded += magic;
+			memcpy(&half, &rounded, sizeof(half));
+			half -= magicBits;
+		}
+		else
+		{
+			uint32_t odd = (bits >> 13) & 1;
+			bits += 0xC8000FFFu + odd;
+			half = bits >> 13;
+		}
+		return static_cast<uint16_t>(half | sign);
+	}
+
+	void
+	swapRedBlueRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+#ifdef PIXEL_FORMAT_SSE
+		const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+		const __m128i greenAlphaMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+			__m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+			__m128i swapped = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), swapped));
+		}
+#endif
+		for (; x < width; x++)
+		{
+			store32(destination + x * 4, swapRedBlue(load32(source + x * 4)));
+		}
+	}
+
+	template <bool Swap>
+	void
+	expandRGBRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		for (size_t x = 0; x < width; x++)
+		{
+			const unsigned char* pixel = source + x * 3;
+			store32(destination + x * 4, packPixel<Swap>(pixel[0], pixel[1], pixel[2], 255));
+		}
+	}
+
+#ifdef PIXEL_FORMAT_SSE
+	template <bool Swap>
+	PIXEL_FORMAT_TARGET("ssse3")
+	void
+	expandRGBRowSSSE3(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		// Four pixels are read with a 16-byte load, so the last four bytes must still be in the row
+		const __m128i shuffle = Swap ?
+			_mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+			_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(Opaque));
+		size_t x = 0;
+		for (; x + 6 <= width; x += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+		}
+		expandRGBRow<Swap>(source + x * 3, destination + x * 4, width - x);
+	}
+#endif
+
+	template <bool Swap>
+	void
+	expandRedRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+#ifdef PIXEL_FORMAT_SSE
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi8(-1);
+		const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+		for (; x + 16 <= width; x += 16)
+		{
+			__m128i red = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+			__m128i out[4];
+			if (Swap)
+			{
+				// Words of red and alpha, after words of zero blue and green
+				__m128i low = _mm_unpacklo_epi8(red, ones);
+				__m128i high = _mm_unpackhi_epi8(red, ones);
+				out[0] = _mm_unpacklo_epi16(zero, low);
+				out[1] = _mm_unpackhi_epi16(zero, low);
+				out[2] = _mm_unpacklo_epi16(zero, high);
+				out[3] = _mm_unpackhi_epi16(zero, high);
+			}
+			else
+			{
+				// Words of red and zero green, before words of zero blue and alpha
+				__m128i low = _mm_unpacklo_epi8(red, zero);
+				__m128i high = _mm_unpackhi_epi8(red, zero);
+				out[0] = _mm_unpacklo_epi16(low, alpha);
+				out[1] = _mm_unpackhi_epi16(low, alpha);
+				out[2] = _mm_unpacklo_epi16(high, alpha);
+				out[3] = _mm_unpackhi_epi16(high, alpha);
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + (x + i * 4) * 4), out[i]);
+			}
+		}
+#endif
+		for (; x < width; x++)
+		{
+			store32(destination + x * 4, packPixel<Swap>(source[x], 0, 0, 255));
+		}
+	}
+
+#ifdef PIXEL_FORMAT_SSE
+	__m128i
+	swapRedBlue(__m128i pixels)
+	{
+		const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+		const __m128i greenAlphaMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+		__m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+		return _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16)));
+	}
+
+	// Four pixels of RGBA floats to 8-bit RGBA
+	__m128i
+	floatsToUnorm8(__m128 p0, __m128 p1, __m128 p2, __m128 p3)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 scale = _mm_set1_ps(255.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		__m128i i0 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_min_ps(p0, one), zero), scale), half));
+		__m128i i1 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_min_ps(p1, one), zero), scale), half));
+		__m128i i2 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_min_ps(p2, one), zero), scale), half));
+		__m128i i3 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_min_ps(p3, one), zero), scale), half));
+		return _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3));
+	}
+#endif
+
+	template <bool Swap>
+	void
+	narrowUnorm16Row(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+#ifdef PIXEL_FORMAT_SSE
+		// (v * 255 + 32768) >> 16 is the high word of the product, plus one if its low word is at least 32768
+		const __m128i scale = _mm_set1_epi16(255);
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 8));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 8 + 16));
+			a = _mm_add_epi16(_mm_mulhi_epu16(a, scale), _mm_srli_epi16(_mm_mullo_epi16(a, scale), 15));
+			b = _mm_add_epi16(_mm_mulhi_epu16(b, scale), _mm_srli_epi16(_mm_mullo_epi16(b, scale), 15));
+			__m128i pixels = _mm_packus_epi16(a, b);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), Swap ? swapRedBlue(pixels) : pixels);
+		}
+#endif
+		for (; x < width; x++)
+		{
+			uint32_t c[4];
+			for (int i = 0; i < 4; i++)
+			{
+				uint16_t value;
+				memcpy(&value, source + x * 8 + i * 2, sizeof(value));
+				c[i] = (static_cast<uint32_t>(value) * 255 + 32768) >> 16;
+			}
+			store32(destination + x * 4, packPixel<Swap>(c[0], c[1], c[2], c[3]));
+		}
+	}
+
+	template <bool Swap>
+	void
+	narrowHalfRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		for (size_t x = 0; x < width; x++)
+		{
+			uint32_t c[4];
+			for (int i = 0; i < 4; i++)
+			{
+				uint16_t value;
+				memcpy(&value, source + x * 8 + i * 2, sizeof(value));
+				c[i] = floatToUnorm8(halfToFloat(value));
+			}
+			store32(destination + x * 4, packPixel<Swap>(c[0], c[1], c[2], c[3]));
+		}
+	}
+
+#ifdef PIXEL_FORMAT_SSE
+	template <bool Swap>
+	PIXEL_FORMAT_TARGET("f16c")
+	void
+	narrowHalfRowF16C(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 8));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 8 + 16));
+			__m128i pixels = floatsToUnorm8(_mm_cvtph_ps(a), _mm_cvtph_ps(_mm_srli_si128(a, 8)), _mm_cvtph_ps(b), _mm_cvtph_ps(_mm_srli_si128(b, 8)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), Swap ? swapRedBlue(pixels) : pixels);
+		}
+		narrowHalfRow<Swap>(source + x * 8, destination + x * 4, width - x);
+	}
+#endif
+
+	template <bool Swap>
+	void
+	narrowFloatRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+#ifdef PIXEL_FORMAT_SSE
+		for (; x + 4 <= width; x += 4)
+		{
+			const float* pixel = reinterpret_cast<const float*>(source + x * 16);
+			__m128i pixels = floatsToUnorm8(_mm_loadu_ps(pixel), _mm_loadu_ps(pixel + 4), _mm_loadu_ps(pixel + 8), _mm_loadu_ps(pixel + 12));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), Swap ? swapRedBlue(pixels) : pixels);
+		}
+#endif
+		for (; x < width; x++)
+		{
+			float c[4];
+			memcpy(c, source + x * 16, sizeof(c));
+			store32(destination + x * 4, packPixel<Swap>(floatToUnorm8(c[0]), floatToUnorm8(c[1]), floatToUnorm8(c[2]), floatToUnorm8(c[3])));
+		}
+	}
+
+	void
+	floatToHalfRow(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		for (size_t i = 0; i < width * 4; i++)
+		{
+			float value;
+			memcpy(&value, source + i * 4, sizeof(value));
+			uint16_t half = floatToHalf(value);
+			memcpy(destination + i * 2, &half, sizeof(half));
+		}
+	}
+
+#ifdef PIXEL_FORMAT_SSE
+	PIXEL_FORMAT_TARGET("f16c")
+	void
+	floatToHalfRowF16C(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		size_t x = 0;
+		for (; x + 2 <= width; x += 2)
+		{
+			const float* pixel = reinterpret_cast<const float*>(source + x * 16);
+			__m128i a = _mm_cvtps_ph(_mm_loadu_ps(pixel), _MM_FROUND_TO_NEAREST_INT);
+			__m128i b = _mm_cvtps_ph(_mm_loadu_ps(pixel + 4), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 8), _mm_unpacklo_epi64(a, b));
+		}
+		floatToHalfRow(source + x * 16, destination + x * 8, width - x);
+	}
+#endif
+
+	template <bool Swap>
+	void
+	narrowRGB10A2Row(const unsigned char* source, unsigned char* destination, size_t width)
+	{
+		const float scale = 255.0f / 1023.0f;
+		size_t x = 0;
+#ifdef PIXEL_FORMAT_SSE
+		const __m128i mask = _mm_set1_epi32(0x3FF);
+		const __m128 scales = _mm_set1_ps(scale);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128i alphaScale = _mm_set1_epi32(85);
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+			__m128i red = _mm_and_si128(pixels, mask);
+			__m128i green = _mm_and_si128(_mm_srli_epi32(pixels, 10), mask);
+			__m128i blue = _mm_and_si128(_mm_srli_epi32(pixels, 20), mask);
+			// Two bits of alpha times 85 fits the low word of each lane, whose high word stays zero
+			__m128i alpha = _mm_mullo_epi16(_mm_srli_epi32(pixels, 30), alphaScale);
+			red = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(red), scales), half));
+			green = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(green), scales), half));
+			blue = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(blue), scales), half));
+			if (Swap)
+			{
+				std::swap(red, blue);
+			}
+			__m128i out = _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)), _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_slli_epi32(alpha, 24)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), out);
+		}
+#endif
+		for (; x < width; x++)
+		{
+			uint32_t pixel = load32(source + x * 4);
+			uint32_t c[3];
+			for (int i = 0; i < 3; i++)
+			{
+				c[i] = static_cast<uint32_t>(static_cast<int>(static_cast<float>((pixel >> (i * 10)) & 0x3FF) * scale + 0.5f));
+			}
+			store32(destination + x * 4, packPixel<Swap>(c[0], c[1], c[2], (pixel >> 30) * 85));
+		}
+	}
+
+	template <bool Swap>
+	RowConversion
+	getNarrowing(PixelFormat from)
+	{
+		const Features& features = getFeatures();
+		(void)features;
+		switch (from)
+		{
+		case PixelFormat::BGRA8:
+		case PixelFormat::RGBA8:
+			return swapRedBlueRow;
+		case PixelFormat::RGB8:
+#ifdef PIXEL_FORMAT_SSE
+			if (features.ssse3)
+				return expandRGBRowSSSE3<Swap>;
+#endif
+			return expandRGBRow<Swap>;
+		case PixelFormat::R8:
+			return expandRedRow<Swap>;
+		case PixelFormat::RGBA16:
+			return narrowUnorm16Row<Swap>;
+		case PixelFormat::RGBA16F:
+#ifdef PIXEL_FORMAT_SSE
+			if (features.f16c)
+				return narrowHalfRowF16C<Swap>;
+#endif
+			return narrowHalfRow<Swap>;
+		case PixelFormat::RGBA32F:
+			return narrowFloatRow<Swap>;
+		case PixelFormat::RGB10A2:
+			return narrowRGB10A2Row<Swap>;
+		}
+		return nullptr;
+	}
+
+	RowConversion
+	getConversion(PixelFormat from, PixelFormat to)
+	{
+		if (to == PixelFormat::RGBA8)
+		{
+			return getNarrowing<false>(from);
+		}
+		if (to == PixelFormat::BGRA8)
+		{
+			return getNarrowing<true>(from);
+		}
+		if (from == PixelFormat::RGBA32F && to == PixelFormat::RGBA16F)
+		{
+#ifdef PIXEL_FORMAT_SSE
+			if (getFeatures().f16c)
+				return floatToHalfRowF16C;
+#endif
+			return floatToHalfRow;
+		}
+		return nullptr;
+	}
+}
+
+size_t
+GetBytesPerPixel(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::BGRA8:
+	case PixelFormat::RGBA8:
+	case PixelFormat::RGB10A2:
+		return 4;
+	case PixelFormat::RGB8:
+		return 3;
+	case PixelFormat::R8:
+		return 1;
+	case PixelFormat::RGBA16:
+	case PixelFormat::RGBA16F:
+		return 8;
+	case PixelFormat::RGBA32F:
+		return 16;
+	}
+	return 0;
+}
+
+TETextureFormat
+GetTextureFormat(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::BGRA8:
+		return TETextureFormatBGRA8Unorm;
+	case PixelFormat::RGBA8:
+		return TETextureFormatRGBA8Unorm;
+	case PixelFormat::R8:
+		return TETextureFormatR8Unorm;
+	case PixelFormat::RGBA16:
+		return TETextureFormatRGBA16Unorm;
+	case PixelFormat::RGBA16F:
+		return TETextureFormatRGBA16F;
+	case PixelFormat::RGBA32F:
+		return TETextureFormatRGBA32F;
+	case PixelFormat::RGB10A2:
+		return TETextureFormatRGB10_A2Unorm;
+	default:
+		return TETextureFormatInvalid;
+	}
+}
+
+bool
+CanConvertPixels(PixelFormat from, PixelFormat to)
+{
+	return from == to || getConversion(from, to) != nullptr;
+}
+
+bool
+ConvertPixels(const unsigned char* source, size_t sourceBytesPerRow, PixelFormat sourceFormat,
+			unsigned char* destination, size_t destinationBytesPerRow, PixelFormat destinationFormat,
+			int width, int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return CanConvertPixels(sourceFormat, destinationFormat);
+	}
+	if (sourceFormat == destinationFormat)
+	{
+		size_t rowSize = static_cast<size_t>(width) * GetBytesPerPixel(sourceFormat);
+		if (sourceBytesPerRow == rowSize && destinationBytesPerRow == rowSize)
+		{
+			memcpy(destination, source, rowSize * height);
+			return true;
+		}
+		for (int y = 0; y < height; y++)
+		{
+			memcpy(destination + y * destinationBytesPerRow, source + y * sourceBytesPerRow, rowSize);
+		}
+		return true;
+	}
+	RowConversion conversion = getConversion(sourceFormat, destinationFormat);
+	if (!conversion)
+	{
+		return false;
+	}
+	for (int y = 0; y < height; y++)
+	{
+		conversion(source + y * sourceBytesPerRow, destination + y * destinationBytesPerRow, static_cast<size_t>(width));
+	}
+	return true;
+}
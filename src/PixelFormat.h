@@ -0,0 +1,56 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Formats of images in CPU memory, for input images and the textures they are uploaded to.
+*
+* Conversions run a row at a time with SSE2, and use SSSE3 and F16C where the processor has them. Rows may
+* have any pitch, including padding which isn't a whole number of pixels.
+*/
+enum class PixelFormat : uint8_t
+{
+	BGRA8,
+	RGBA8,
+	// Only a source format - there is no texture format with three 8-bit components
+	RGB8,
+	R8,
+	RGBA16,
+	RGBA16F,
+	RGBA32F,
+	// Red in the lowest bits
+	RGB10A2,
+};
+
+constexpr size_t PixelFormatCount = 8;
+
+size_t			GetBytesPerPixel(PixelFormat format);
+// TETextureFormatInvalid for a format with no texture format
+TETextureFormat	GetTextureFormat(PixelFormat format);
+
+/*
+* Supported conversions are from each format to itself, from every format to RGBA8 and BGRA8, and from RGBA32F to
+* RGBA16F. Conversions to 8-bit formats clamp to [0, 1] and round to nearest. R8 becomes red with no green or blue.
+*/
+bool	CanConvertPixels(PixelFormat from, PixelFormat to);
+// Returns false if the conversion isn't supported
+bool	ConvertPixels(const unsigned char* source, size_t sourceBytesPerRow, PixelFormat sourceFormat,
+					unsigned char* destination, size_t destinationBytesPerRow, PixelFormat destinationFormat,
+					int width, int height);
@@ -12,8 +12,9 @@
 * prior written permission from Derivative.
 */
 
-#include "stdafx.h"
 #include "Renderer.h"
+#include <algorithm>
+#include <cassert>
 
 
 Renderer::Renderer()
@@ -33,8 +34,31 @@ Renderer::setup(HWND window)
 	return true;
 }
 
-bool Renderer::configure(TEInstance* instance, std::wstring &error)
+void Renderer::getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities)
 {
+	int32_t count = 0;
+	TEResult result = TEInstanceGetSupportedTextureFormats(instance, nullptr, &count);
+	if (result == TEResultInsufficientMemory)
+	{
+		capabilities.textureFormats.resize(count);
+		result = TEInstanceGetSupportedTextureFormats(instance, capabilities.textureFormats.data(), &count);
+		capabilities.textureFormats.resize(result == TEResultSuccess ? count : 0);
+	}
+}
+
+bool Renderer::configure(const InstanceCapabilities& capabilities, std::wstring &)
+{
+	// BGRA8 is what we always uploaded before instances reported their formats, so is assumed
+	myInstanceFormats = 1u << static_cast<uint32_t>(PixelFormat::BGRA8);
+	for (size_t i = 0; i < PixelFormatCount; i++)
+	{
+		TETextureFormat textureFormat = GetTextureFormat(static_cast<PixelFormat>(i));
+		const auto& formats = capabilities.textureFormats;
+		if (textureFormat != TETextureFormatInvalid && std::find(formats.begin(), formats.end(), textureFormat) != formats.end())
+		{
+			myInstanceFormats |= 1u << i;
+		}
+	}
 	return true;
 }
 
@@ -68,14 +92,116 @@ void Renderer::beginImageLayout()
 {
 }
 
-void Renderer::addInputImage(const unsigned char* rgba, size_t bytesPerRow, int width, int height)
+void Renderer::addInputImage(const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
 {
+	PixelFormat uploadFormat = getUploadFormat(format);
+	if (uploadFormat == format)
+	{
+		createInputImage(pixels, bytesPerRow, width, height, format);
+	}
+	else
+	{
+		size_t rowSize = static_cast<size_t>(width) * GetBytesPerPixel(uploadFormat);
+		std::vector<unsigned char> converted(rowSize * height);
+		// getUploadFormat() only falls back to formats every format converts to
+		bool convertible = ConvertPixels(pixels, bytesPerRow, format, converted.data(), rowSize, uploadFormat, width, height);
+		assert(convertible);
+		(void)convertible;
+		createInputImage(converted.data(), rowSize, width, height, uploadFormat);
+	}
 	myInputImageUpdates.push_back(true);
+	myInputImageLayouts.push_back({ width, height, uploadFormat });
+	myInputImageStaging.addInput(width, height, uploadFormat);
 }
 
 void Renderer::clearInputImages()
 {
 	myInputImageUpdates.clear();
+	myInputImageLayouts.clear();
+	myInputImageStaging.clear();
+}
+
+bool
+Renderer::submitInputImage(size_t index, const unsigned char* pixels, size_t bytesPerRow, int width, int height, PixelFormat format)
+{
+	return myInputImageStaging.submit(index, pixels, bytesPerRow, width, height, format);
+}
+
+bool
+Renderer::updateInputImages()
+{
+	bool began = false;
+	size_t count = (std::min)(myInputImageLayouts.size(), getInputImageCount());
+	for (size_t i = 0; i < count; i++)
+	{
+		const unsigned char* pixels = myInputImageStaging.take(i);
+		if (pixels)
+		{
+			if (!began)
+			{
+				beginInputImageUpload();
+				began = true;
+			}
+			const auto& layout = myInputImageLayouts[i];
+			uploadInputImage(i, pixels, static_cast<size_t>(layout.width) * GetBytesPerPixel(layout.format), layout.width, layout.height, layout.format);
+			markInputChange(i);
+		}
+	}
+	if (began)
+	{
+		endInputImageUpload();
+	}
+	return began;
+}
+
+InputImageStaging::Counters
+Renderer::getInputImageCounters() const
+{
+	return myInputImageStaging.getCounters();
+}
+
+PixelFormat
+Renderer::getUploadFormat(PixelFormat format) const
+{
+	auto canUpload = [this](PixelFormat candidate)
+	{
+		return (myInstanceFormats & (1u << static_cast<uint32_t>(candidate))) != 0 && supportsUploadFormat(candidate);
+	};
+	if (canUpload(format))
+	{
+		return format;
+	}
+	// Keep what precision we can, otherwise avoid swapping components where it isn't needed
+	if (format == PixelFormat::RGBA32F && canUpload(PixelFormat::RGBA16F))
+	{
+		return PixelFormat::RGBA16F;
+	}
+	if (format != PixelFormat::BGRA8 && canUpload(PixelFormat::RGBA8))
+	{
+		return PixelFormat::RGBA8;
+	}
+	return PixelFormat::BGRA8;
+}
+
+bool
+Renderer::supportsUploadFormat(PixelFormat format) const
+{
+	return format == PixelFormat::BGRA8;
+}
+
+void
+Renderer::beginInputImageUpload()
+{
+}
+
+void
+Renderer::uploadInputImage(size_t, const unsigned char*, size_t, int, int, PixelFormat)
+{
+}
+
+void
+Renderer::endInputImageUpload()
+{
 }
 
 size_t
@@ -19,6 +19,18 @@
 #include <vector>
 #include <array>
 #include <memory>
+#include <string>
+#include "InstanceCapabilities.h"
+#include "InputImageStaging.h"
+#include "PixelFormat.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+// Only the headless renderer is available on other platforms
+typedef void* HWND;
+typedef uint32_t DWORD;
+#endif
 
 class Renderer
 {
@@ -42,7 +54,9 @@ public:
 	virtual const std::wstring& getDeviceName() const = 0;
 
 	virtual bool	setup(HWND window);
-	virtual bool	configure(TEInstance* instance, std::wstring& error);
+	// Queries what configure() needs - which ComponentCache may supply instead when a component is loaded again
+	virtual void	getCapabilities(TEInstance* instance, InstanceCapabilities& capabilities);
+	virtual bool	configure(const InstanceCapabilities& capabilities, std::wstring& error);
 	virtual bool	doesInputTextureTransfer() const;
 	virtual void	resize(int width, int height);
 	virtual void	stop();
@@ -52,9 +66,22 @@ public:
 
 	virtual size_t		getInputImageCount() const = 0;
 	virtual void		beginImageLayout();
-	virtual void		addInputImage(const unsigned char *rgba, size_t bytesPerRow, int width, int height);
+	// Converts the image if the renderer or instance can't use its format, see getUploadFormat()
+	void				addInputImage(const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format = PixelFormat::BGRA8);
 	virtual bool		getInputImage(size_t index, TouchObject<TETexture> & texture, TouchObject<TESemaphore> & semaphore, uint64_t & waitValue) = 0;
 	virtual void		clearInputImages();
+	/*
+	* May be called from any thread. Copies a new image for the input image at index, converting it to the input
+	* image's upload format, to be uploaded by the next updateInputImages() unless a later image replaces it first.
+	* Returns false if there is no such input image, it is a different size, or its format can't be converted.
+	*/
+	bool				submitInputImage(size_t index, const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format = PixelFormat::BGRA8);
+	// Uploads the latest image submitted for each input image since the last call, before getInputImage()
+	// Returns true if any image changed
+	bool				updateInputImages();
+	InputImageStaging::Counters getInputImageCounters() const;
+	// The format an input image in the given format is uploaded as - its own if both we and the instance support it
+	PixelFormat			getUploadFormat(PixelFormat format) const;
 	size_t				getRightSideImageCount();
 	virtual void		addOutputImage();
 	virtual void		endImageLayout();
@@ -64,6 +91,15 @@ public:
 	virtual void		clearOutputImages(); // TODO: ?
 	virtual TEGraphicsContext* getTEContext() const = 0;
 protected:
+	// Whether input images can be created in a format - BGRA8 must always be supported
+	virtual bool		supportsUploadFormat(PixelFormat format) const;
+	// Called by addInputImage() with pixels already in the upload format, and rows of any pitch
+	virtual void		createInputImage(const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format) = 0;
+	// Replace the contents of input images - pixels are in the format the image was created with, and rows are
+	// tightly packed and only valid until uploadInputImage() returns
+	virtual void		beginInputImageUpload();
+	virtual void		uploadInputImage(size_t index, const unsigned char *pixels, size_t bytesPerRow, int width, int height, PixelFormat format);
+	virtual void		endInputImageUpload();
 	bool				inputDidChange(size_t index) const;
 	void				markInputChange(size_t index);
 	void				markInputUnchanged(size_t index);
@@ -74,6 +110,17 @@ protected:
 private:
 	HWND	myWindow = 0;
 	std::vector<TouchObject<TETexture>> myOutputImages;
+	struct InputImageLayout
+	{
+		int			width;
+		int			height;
+		PixelFormat	format;
+	};
+
 	std::vector<bool>			myInputImageUpdates;
+	std::vector<InputImageLayout>	myInputImageLayouts;
+	// Bits indexed by PixelFormat, set from the instance's supported texture formats when configured
+	uint32_t					myInstanceFormats{ 1u << static_cast<uint32_t>(PixelFormat::BGRA8) };
+	InputImageStaging			myInputImageStaging;
 };
 
@@ -0,0 +1,123 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "RunLoop.h"
+#include <chrono>
+#ifdef _WIN32
+#include <timeapi.h>
+#endif
+
+std::unique_ptr<RunLoop>
+RunLoop::create()
+{
+#ifdef _WIN32
+	return std::make_unique<Win32RunLoop>();
+#else
+	return std::make_unique<ConditionRunLoop>();
+#endif
+}
+
+void
+ConditionRunLoop::wake()
+{
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		if (mySignalled)
+		{
+			return;
+		}
+		mySignalled = true;
+	}
+	myCondition.notify_one();
+}
+
+RunLoop::Wake
+ConditionRunLoop::wait(int64_t timeout)
+{
+	std::unique_lock<std::mutex> lock(myMutex);
+	auto signalled = [this] { return mySignalled; };
+	bool woken;
+	if (timeout == Infinite)
+	{
+		myCondition.wait(lock, signalled);
+		woken = true;
+	}
+	else
+	{
+		woken = myCondition.wait_for(lock, std::chrono::nanoseconds(timeout), signalled);
+	}
+	mySignalled = false;
+	return woken ? Wake::Signal : Wake::Timeout;
+}
+
+#ifdef _WIN32
+
+Win32RunLoop::Win32RunLoop()
+	: myEvent(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+{
+	// Waits are otherwise only as precise as the default timer resolution, around 15ms
+	timeBeginPeriod(1);
+}
+
+Win32RunLoop::~Win32RunLoop()
+{
+	timeEndPeriod(1);
+	if (myEvent)
+	{
+		CloseHandle(myEvent);
+	}
+}
+
+void
+Win32RunLoop::wake()
+{
+	// Only the first wake() after a wait() needs to signal the event
+	if (!mySignalled.exchange(true, std::memory_order_acq_rel))
+	{
+		SetEvent(myEvent);
+	}
+}
+
+RunLoop::Wake
+Win32RunLoop::wait(int64_t timeout)
+{
+	DWORD milliseconds = INFINITE;
+	if (timeout != Infinite)
+	{
+		// Round down so we never wake later than asked, callers spin to any precise deadline
+		int64_t rounded = timeout > 0 ? timeout / 1000000 : 0;
+		milliseconds = static_cast<DWORD>(rounded < INFINITE ? rounded : INFINITE - 1);
+	}
+	DWORD result = MsgWaitForMultipleObjectsEx(1, &myEvent, milliseconds, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+	Wake wake;
+	switch (result)
+	{
+	case WAIT_OBJECT_0:
+		wake = Wake::Signal;
+		break;
+	case WAIT_OBJECT_0 + 1:
+		wake = Wake::Message;
+		break;
+	default:
+		wake = Wake::Timeout;
+		break;
+	}
+	if (wake == Wake::Signal)
+	{
+		mySignalled.store(false, std::memory_order_release);
+	}
+	return wake;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*
+* Blocks the host's main thread until there is something to do: a window message, a timeout
+* (such as a frame deadline) or a wake() from another thread (such as a TouchEngine callback).
+*
+* Wakes are coalesced, so calling wake() for every event is cheap.
+*/
+class RunLoop
+{
+public:
+	enum class Wake
+	{
+		Message,
+		Signal,
+		Timeout
+	};
+
+	static constexpr int64_t Infinite = INT64_MAX;
+
+	// The Win32 run loop on Windows, otherwise a ConditionRunLoop
+	static std::unique_ptr<RunLoop>	create();
+
+	virtual ~RunLoop() = default;
+
+	// May be called from any thread
+	virtual void	wake() = 0;
+
+	// Waits for up to timeout nanoseconds
+	virtual Wake	wait(int64_t timeout) = 0;
+};
+
+/*
+* A run loop without window messages, for headless use and tests on any platform
+*/
+class ConditionRunLoop : public RunLoop
+{
+public:
+	virtual void	wake() override;
+	virtual Wake	wait(int64_t timeout) override;
+private:
+	std::mutex				myMutex;
+	std::condition_variable	myCondition;
+	bool					mySignalled{ false };
+};
+
+#ifdef _WIN32
+class Win32RunLoop : public RunLoop
+{
+public:
+	Win32RunLoop();
+	Win32RunLoop(const Win32RunLoop& o) = delete;
+	Win32RunLoop& operator=(const Win32RunLoop& o) = delete;
+	virtual ~Win32RunLoop();
+
+	virtual void	wake() override;
+	virtual Wake	wait(int64_t timeout) override;
+private:
+	HANDLE				myEvent;
+	std::atomic<bool>	mySignalled{ false };
+};
+#endif
@@ -0,0 +1,82 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "SampleRing.h"
+#include <algorithm>
+
+SampleRing::SampleRing(int32_t channels, size_t capacity)
+	: myChannels(std::max(channels, 1))
+{
+	size_t size = 1;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+	myMask = size - 1;
+	mySamples.resize(size * myChannels);
+}
+
+size_t
+SampleRing::write(const float* interleaved, size_t frames)
+{
+	size_t position = myWritePosition.load(std::memory_order_relaxed);
+	size_t space = getCapacity() - (position - myReadPosition.load(std::memory_order_acquire));
+	frames = std::min(frames, space);
+
+	// Copy in at most two runs, either side of the end of the ring
+	size_t offset = position & myMask;
+	size_t first = std::min(frames, getCapacity() - offset);
+	std::copy(interleaved, interleaved + first * myChannels, mySamples.begin() + offset * myChannels);
+	std::copy(interleaved + first * myChannels, interleaved + frames * myChannels, mySamples.begin());
+
+	myWritePosition.store(position + frames, std::memory_order_release);
+	return frames;
+}
+
+size_t
+SampleRing::read(float* const* channels, size_t frames)
+{
+	return discard(peek(channels, frames));
+}
+
+size_t
+SampleRing::peek(float* const* channels, size_t frames) const
+{
+	size_t position = myReadPosition.load(std::memory_order_relaxed);
+	frames = std::min(frames, myWritePosition.load(std::memory_order_acquire) - position);
+	for (size_t i = 0; i < frames; i++)
+	{
+		const float* frame = &mySamples[((position + i) & myMask) * myChannels];
+		for (int32_t channel = 0; channel < myChannels; channel++)
+		{
+			channels[channel][i] = frame[channel];
+		}
+	}
+	return frames;
+}
+
+size_t
+SampleRing::discard(size_t frames)
+{
+	size_t position = myReadPosition.load(std::memory_order_relaxed);
+	frames = std::min(frames, myWritePosition.load(std::memory_order_acquire) - position);
+	myReadPosition.store(position + frames, std::memory_order_release);
+	return frames;
+}
+
+size_t
+SampleRing::getAvailable() const
+{
+	return myWritePosition.load(std::memory_order_acquire) - myReadPosition.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* A lock-free ring of interleaved audio samples for one producer thread and one consumer thread.
+*
+* Positions count sample frames (one sample per channel) and only ever increase, so the ring is full
+* when they differ by its capacity. Neither side blocks: write() stores what fits and read() returns
+* what is available, and the caller decides how to handle the shortfall.
+*/
+class SampleRing
+{
+public:
+	// capacity is in sample frames, and is rounded up to a power of two
+	SampleRing(int32_t channels, size_t capacity);
+	SampleRing(const SampleRing& o) = delete;
+	SampleRing& operator=(const SampleRing& o) = delete;
+
+	// Producer thread only, returns the number of frames stored
+	size_t	write(const float* interleaved, size_t frames);
+
+	// Consumer thread only, deinterleaving into one destination per channel, returns the number of frames read
+	size_t	read(float* const* channels, size_t frames);
+	// Consumer thread only, as read() but leaving the frames in the ring until discard()
+	size_t	peek(float* const* channels, size_t frames) const;
+	// Consumer thread only, returns the number of frames dropped
+	size_t	discard(size_t frames);
+
+	// Frames waiting to be read, approximate while the producer is active
+	size_t	getAvailable() const;
+
+	int32_t
+	getChannelCount() const
+	{
+		return myChannels;
+	}
+
+	size_t
+	getCapacity() const
+	{
+		return myMask + 1;
+	}
+private:
+	int32_t				myChannels;
+	size_t				myMask;
+	std::vector<float>	mySamples;
+	// Producer and consumer positions are kept on separate cache lines
+	alignas(64) std::atomic<size_t>	myWritePosition{ 0 };
+	alignas(64) std::atomic<size_t>	myReadPosition{ 0 };
+};
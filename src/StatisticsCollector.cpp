@@ -0,0 +1,392 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "StatisticsCollector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	uint32_t
+	getMagnitude(uint64_t value)
+	{
+		// value must not be zero
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	const std::array<double, 3> ExportPercentiles{ 50.0, 99.0, 99.9 };
+	const std::array<const char*, 3> ExportPercentileNames{ "p50", "p99", "p999" };
+
+	int64_t
+	getWallTime()
+	{
+		// Milliseconds since the Unix epoch
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+}
+
+void
+LatencyHistogram::record(int64_t value, uint64_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	uint64_t v = value > 0 ? static_cast<uint64_t>(value) : 0;
+	myCounts[getIndex(v)] += count;
+	myCount += count;
+	mySum += v * count;
+	myMin = std::min(myMin, v);
+	myMax = std::max(myMax, v);
+}
+
+void
+LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	for (size_t i = 0; i < BucketCount; i++)
+	{
+		myCounts[i] += other.myCounts[i];
+	}
+	myCount += other.myCount;
+	mySum += other.mySum;
+	myMin = std::min(myMin, other.myMin);
+	myMax = std::max(myMax, other.myMax);
+}
+
+void
+LatencyHistogram::reset()
+{
+	myCounts.fill(0);
+	myCount = 0;
+	mySum = 0;
+	myMin = UINT64_MAX;
+	myMax = 0;
+}
+
+int64_t
+LatencyHistogram::getMin() const
+{
+	return myCount ? static_cast<int64_t>(myMin) : 0;
+}
+
+int64_t
+LatencyHistogram::getMax() const
+{
+	return static_cast<int64_t>(myMax);
+}
+
+int64_t
+LatencyHistogram::getMean() const
+{
+	return myCount ? static_cast<int64_t>(mySum / myCount) : 0;
+}
+
+int64_t
+LatencyHistogram::getPercentile(double percentile) const
+{
+	if (myCount == 0)
+	{
+		return 0;
+	}
+	percentile = std::min(std::max(percentile, 0.0), 100.0);
+	uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile / 100.0 * myCount)), 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BucketCount; i++)
+	{
+		seen += myCounts[i];
+		if (seen >= target)
+		{
+			return static_cast<int64_t>(std::min(getValue(i), myMax));
+		}
+	}
+	return static_cast<int64_t>(myMax);
+}
+
+size_t
+LatencyHistogram::getIndex(uint64_t value)
+{
+	if (value < SubBucketCount)
+	{
+		return static_cast<size_t>(value);
+	}
+	uint32_t magnitude = getMagnitude(value);
+	if (magnitude > MaxMagnitude)
+	{
+		return BucketCount - 1;
+	}
+	// Each magnitude above the sub-bucket range halves the resolution
+	uint32_t shift = magnitude - SubBucketBits;
+	size_t sub = static_cast<size_t>(value >> shift) - SubBucketCount;
+	return (shift + 1) * SubBucketCount + sub;
+}
+
+uint64_t
+LatencyHistogram::getValue(size_t index)
+{
+	size_t bucket = index / SubBucketCount;
+	uint64_t sub = index % SubBucketCount;
+	if (bucket == 0)
+	{
+		return sub;
+	}
+	uint32_t shift = static_cast<uint32_t>(bucket - 1);
+	return ((SubBucketCount + sub + 1) << shift) - 1;
+}
+
+StatisticsCollector::Timer::Timer(StatisticsCollector* collector, Metric metric)
+	: myCollector(collector), myMetric(metric), myStart(collector ? now() : 0)
+{
+}
+
+StatisticsCollector::Timer::~Timer()
+{
+	if (myCollector)
+	{
+		myCollector->record(myMetric, now() - myStart);
+	}
+}
+
+const char*
+StatisticsCollector::getName(Metric metric)
+{
+	switch (metric)
+	{
+	case Metric::FrameTimeCPU:
+		return "frameTimeCPU";
+	case Metric::FrameTimeGPU:
+		return "frameTimeGPU";
+	case Metric::Update:
+		return "update";
+	case Metric::LayoutChange:
+		return "layoutChange";
+	case Metric::OutputImage:
+		return "outputImage";
+	case Metric::Render:
+		return "render";
+	default:
+		return "unknown";
+	}
+}
+
+int64_t
+StatisticsCollector::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+StatisticsCollector::StatisticsCollector()
+	: myIntervalStart(now())
+{
+}
+
+void
+StatisticsCollector::record(Metric metric, int64_t nanoseconds, uint32_t count)
+{
+	// If the queue is full the sample is lost, and counted by getLostCount()
+	mySamples.push({ metric, count, nanoseconds });
+}
+
+void
+StatisticsCollector::record(const TEInstanceStatistics& statistics)
+{
+	// The times are totals for all the frames in the interval
+	if (statistics.frames > 0)
+	{
+		uint32_t frames = static_cast<uint32_t>(std::min<int64_t>(statistics.frames, UINT32_MAX));
+		record(Metric::FrameTimeCPU, statistics.frameTimeCPU / statistics.frames, frames);
+		// -1 where the version of TouchDesigner doesn't supply these
+		if (statistics.frameTimeGPU >= 0)
+		{
+			record(Metric::FrameTimeGPU, statistics.frameTimeGPU / statistics.frames, frames);
+		}
+	}
+	myFrames.fetch_add(statistics.frames, std::memory_order_relaxed);
+	if (statistics.framesDropped > 0)
+	{
+		myFramesDropped.fetch_add(statistics.framesDropped, std::memory_order_relaxed);
+	}
+	myMemUsedCPU.store(statistics.memUsedCPU, std::memory_order_relaxed);
+	myMemUsedGPU.store(statistics.memUsedGPU, std::memory_order_relaxed);
+}
+
+void
+StatisticsCollector::collect()
+{
+	Sample sample;
+	while (mySamples.pop(sample))
+	{
+		myHistograms[static_cast<size_t>(sample.metric)].record(sample.value, sample.count);
+	}
+}
+
+StatisticsCollector::Totals
+StatisticsCollector::getTotals() const
+{
+	Totals totals;
+	totals.frames = myFrames.load(std::memory_order_relaxed);
+	totals.framesDropped = myFramesDropped.load(std::memory_order_relaxed);
+	totals.memUsedCPU = myMemUsedCPU.load(std::memory_order_relaxed);
+	totals.memUsedGPU = myMemUsedGPU.load(std::memory_order_relaxed);
+	return totals;
+}
+
+void
+StatisticsCollector::reset()
+{
+	for (auto& histogram : myHistograms)
+	{
+		histogram.reset();
+	}
+	myFrames.store(0, std::memory_order_relaxed);
+	myFramesDropped.store(0, std::memory_order_relaxed);
+	myIntervalStart = now();
+}
+
+StatisticsExporter::StatisticsExporter(std::ostream& stream, Format format, int64_t interval)
+	: myStream(stream), myFormat(format), myInterval(interval)
+{
+}
+
+bool
+StatisticsExporter::poll(StatisticsCollector& collector, const std::string& label)
+{
+	collector.collect();
+	if (StatisticsCollector::now() - collector.getIntervalStart() < myInterval)
+	{
+		return false;
+	}
+	write(collector, label);
+	return true;
+}
+
+void
+StatisticsExporter::write(StatisticsCollector& collector, const std::string& label)
+{
+	collector.collect();
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		int64_t time = getWallTime();
+		if (myFormat == Format::CSV)
+		{
+			writeCSV(collector, label, time);
+		}
+		else
+		{
+			writeJSON(collector, label, time);
+		}
+		myStream.flush();
+	}
+	collector.reset();
+}
+
+void
+StatisticsExporter::writeCSV(const StatisticsCollector& collector, const std::string& label, int64_t time)
+{
+	using Metric = StatisticsCollector::Metric;
+	if (!myWroteHeader)
+	{
+		myStream << "time,component,frames,framesDropped,memUsedCPU,memUsedGPU";
+		for (uint32_t m = 0; m < static_cast<uint32_t>(Metric::Count); m++)
+		{
+			const char* name = StatisticsCollector::getName(static_cast<Metric>(m));
+			myStream << ',' << name << "_count";
+			for (const char* percentile : ExportPercentileNames)
+			{
+				myStream << ',' << name << '_' << percentile;
+			}
+			myStream << ',' << name << "_max";
+		}
+		myStream << '\n';
+		myWroteHeader = true;
+	}
+
+	// Quote the label, doubling any quotes in it
+	std::string quoted = "\"";
+	for (char c : label)
+	{
+		quoted += c;
+		if (c == '"')
+		{
+			quoted += c;
+		}
+	}
+	quoted += '"';
+
+	auto totals = collector.getTotals();
+	myStream << time << ',' << quoted << ',' << totals.frames << ',' << totals.framesDropped << ',' << totals.memUsedCPU << ',' << totals.memUsedGPU;
+	for (uint32_t m = 0; m < static_cast<uint32_t>(Metric::Count); m++)
+	{
+		const auto& histogram = collector.getHistogram(static_cast<Metric>(m));
+		myStream << ',' << histogram.getCount();
+		for (double percentile : ExportPercentiles)
+		{
+			myStream << ',' << histogram.getPercentile(percentile);
+		}
+		myStream << ',' << histogram.getMax();
+	}
+	myStream << '\n';
+}
+
+void
+StatisticsExporter::writeJSON(const StatisticsCollector& collector, const std::string& label, int64_t time)
+{
+	using Metric = StatisticsCollector::Metric;
+
+	std::string escaped;
+	for (char c : label)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			const char* hex = "0123456789abcdef";
+			escaped += "\\u00";
+			escaped += hex[(c >> 4) & 0xF];
+			escaped += hex[c & 0xF];
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+
+	auto totals = collector.getTotals();
+	myStream << "{\"time\":" << time << ",\"component\":\"" << escaped << '"'
+		<< ",\"frames\":" << totals.frames << ",\"framesDropped\":" << totals.framesDropped
+		<< ",\"memUsedCPU\":" << totals.memUsedCPU << ",\"memUsedGPU\":" << totals.memUsedGPU;
+	for (uint32_t m = 0; m < static_cast<uint32_t>(Metric::Count); m++)
+	{
+		const auto& histogram = collector.getHistogram(static_cast<Metric>(m));
+		myStream << ",\"" << StatisticsCollector::getName(static_cast<Metric>(m)) << "\":{\"count\":" << histogram.getCount();
+		for (size_t p = 0; p < ExportPercentiles.size(); p++)
+		{
+			myStream << ",\"" << ExportPercentileNames[p] << "\":" << histogram.getPercentile(ExportPercentiles[p]);
+		}
+		myStream << ",\"max\":" << histogram.getMax() << '}';
+	}
+	myStream << "}\n";
+}
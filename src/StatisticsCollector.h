@@ -0,0 +1,203 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "EventQueue.h"
+
+/*
+* A histogram of durations in nanoseconds with buckets of logarithmically increasing width, so any value is
+* recorded to within about 3% using a fixed, small amount of memory (after Gil Tene's HdrHistogram).
+*/
+class LatencyHistogram
+{
+public:
+	static constexpr uint32_t SubBucketBits{ 5 };
+	static constexpr uint32_t SubBucketCount{ 1u << SubBucketBits };
+	// Larger values are counted in the last bucket - 2^40ns is about 18 minutes
+	static constexpr uint32_t MaxMagnitude{ 40 };
+
+	// Negative values are recorded as zero
+	void		record(int64_t value, uint64_t count = 1);
+	void		merge(const LatencyHistogram& other);
+	void		reset();
+
+	uint64_t
+	getCount() const
+	{
+		return myCount;
+	}
+	int64_t		getMin() const;
+	int64_t		getMax() const;
+	int64_t		getMean() const;
+	// percentile is from 0 to 100, returns 0 if empty
+	int64_t		getPercentile(double percentile) const;
+private:
+	static constexpr size_t BucketCount{ (MaxMagnitude - SubBucketBits + 2) * SubBucketCount };
+
+	static size_t	getIndex(uint64_t value);
+	// The highest value counted in a bucket
+	static uint64_t	getValue(size_t index);
+
+	std::array<uint64_t, BucketCount>	myCounts{};
+	uint64_t	myCount{ 0 };
+	uint64_t	mySum{ 0 };
+	uint64_t	myMin{ UINT64_MAX };
+	uint64_t	myMax{ 0 };
+};
+
+/*
+* Collects an instance's TEInstanceStatistics and the host's own timings.
+*
+* Samples can be recorded from any thread, and are passed through a lock-free queue to the thread
+* which calls collect() and reads the histograms.
+*/
+class StatisticsCollector
+{
+public:
+	enum class Metric : uint32_t
+	{
+		FrameTimeCPU,
+		FrameTimeGPU,
+		Update,
+		LayoutChange,
+		OutputImage,
+		Render,
+		Count
+	};
+
+	struct Totals
+	{
+		int64_t		frames = 0;
+		int64_t		framesDropped = 0;
+		// The most recent values, in bytes
+		int64_t		memUsedCPU = 0;
+		int64_t		memUsedGPU = 0;
+	};
+
+	// Records the time from construction to destruction
+	class Timer
+	{
+	public:
+		// collector may be null
+		Timer(StatisticsCollector* collector, Metric metric);
+		Timer(const Timer& o) = delete;
+		Timer& operator=(const Timer& o) = delete;
+		~Timer();
+	private:
+		StatisticsCollector*	myCollector;
+		Metric					myMetric;
+		int64_t					myStart;
+	};
+
+	static const char*	getName(Metric metric);
+	// Steady time in nanoseconds, from an arbitrary epoch
+	static int64_t		now();
+
+	StatisticsCollector();
+	StatisticsCollector(const StatisticsCollector& o) = delete;
+	StatisticsCollector& operator=(const StatisticsCollector& o) = delete;
+
+	// May be called from any thread - count is the number of samples with this value, such as frames averaged
+	void		record(Metric metric, int64_t nanoseconds, uint32_t count = 1);
+	// Records the mean frame times, once for each frame they cover
+	void		record(const TEInstanceStatistics& statistics);
+
+	// Applies samples recorded since the last call - only call from one thread
+	void		collect();
+
+	const LatencyHistogram&
+	getHistogram(Metric metric) const
+	{
+		return myHistograms[static_cast<size_t>(metric)];
+	}
+	Totals		getTotals() const;
+
+	// Samples lost because collect() wasn't called often enough
+	uint64_t
+	getLostCount() const
+	{
+		return mySamples.getOverflowCount();
+	}
+
+	// When reset() was last called, or construction
+	int64_t
+	getIntervalStart() const
+	{
+		return myIntervalStart;
+	}
+	void		reset();
+private:
+	static constexpr size_t SampleQueueCapacity{ 4096 };
+
+	struct Sample
+	{
+		Metric		metric;
+		uint32_t	count;
+		int64_t		value;
+	};
+
+	EventQueue<Sample, SampleQueueCapacity>	mySamples;
+	std::array<LatencyHistogram, static_cast<size_t>(Metric::Count)>	myHistograms;
+	std::atomic<int64_t>	myFrames{ 0 };
+	std::atomic<int64_t>	myFramesDropped{ 0 };
+	std::atomic<int64_t>	myMemUsedCPU{ 0 };
+	std::atomic<int64_t>	myMemUsedGPU{ 0 };
+	int64_t					myIntervalStart;
+};
+
+/*
+* Periodically writes StatisticsCollectors to a stream as CSV or JSON lines, one line per collector per interval.
+* Durations are in nanoseconds.
+*/
+class StatisticsExporter
+{
+public:
+	enum class Format
+	{
+		CSV,
+		JSONLines
+	};
+
+	// interval is in nanoseconds
+	StatisticsExporter(std::ostream& stream, Format format, int64_t interval);
+	StatisticsExporter(const StatisticsExporter& o) = delete;
+	StatisticsExporter& operator=(const StatisticsExporter& o) = delete;
+
+	/*
+	* Collects, and if the collector's interval has passed, writes and resets it. Returns true if written.
+	* May be called from any thread, but each collector must only be polled from one thread at a time.
+	*/
+	bool	poll(StatisticsCollector& collector, const std::string& label);
+
+	// Writes and resets the collector now
+	void	write(StatisticsCollector& collector, const std::string& label);
+private:
+	void	writeCSV(const StatisticsCollector& collector, const std::string& label, int64_t time);
+	void	writeJSON(const StatisticsCollector& collector, const std::string& label, int64_t time);
+
+	std::mutex		myMutex;
+	std::ostream&	myStream;
+	Format			myFormat;
+	int64_t			myInterval;
+	bool			myWroteHeader{ false };
+};
@@ -12,25 +12,305 @@
 * prior written permission from Derivative.
 */
 
-#include "stdafx.h"
 #include "Strings.h"
 
-std::wstring ConvertToWide(const std::string& string)
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define STRINGS_SSE2
+#endif
+
+namespace
+{
+	constexpr bool WideIsUTF16 = sizeof(wchar_t) == 2;
+
+	bool
+	isSurrogate(uint32_t c)
+	{
+		return c >= 0xD800 && c <= 0xDFFF;
+	}
+
+#ifdef STRINGS_SSE2
+	// Converts 16 bytes of UTF-8 to 16 wchar_t if they are all ASCII
+	bool
+	widenASCII(const char* source, wchar_t* destination)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+		if (_mm_movemask_epi8(bytes) != 0)
+		{
+			return false;
+		}
+		__m128i zero = _mm_setzero_si128();
+		__m128i low = _mm_unpacklo_epi8(bytes, zero);
+		__m128i high = _mm_unpackhi_epi8(bytes, zero);
+		__m128i* out = reinterpret_cast<__m128i*>(destination);
+		if constexpr (WideIsUTF16)
+		{
+			_mm_storeu_si128(out, low);
+			_mm_storeu_si128(out + 1, high);
+		}
+		else
+		{
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+		}
+		return true;
+	}
+
+	// Converts 16 wchar_t to 16 bytes of UTF-8 if they are all ASCII
+	bool
+	narrowASCII(const wchar_t* source, char* destination)
+	{
+		const __m128i* in = reinterpret_cast<const __m128i*>(source);
+		__m128i zero = _mm_setzero_si128();
+		__m128i bytes;
+		if constexpr (WideIsUTF16)
+		{
+			__m128i a = _mm_loadu_si128(in);
+			__m128i b = _mm_loadu_si128(in + 1);
+			__m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+			{
+				return false;
+			}
+			bytes = _mm_packus_epi16(a, b);
+		}
+		else
+		{
+			__m128i a = _mm_loadu_si128(in);
+			__m128i b = _mm_loadu_si128(in + 1);
+			__m128i c = _mm_loadu_si128(in + 2);
+			__m128i d = _mm_loadu_si128(in + 3);
+			__m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+			__m128i high = _mm_and_si128(all, _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+			{
+				return false;
+			}
+			bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), bytes);
+		return true;
+	}
+#endif
+}
+
+size_t
+ConvertToWide(const char* source, size_t length, wchar_t* destination, size_t capacity)
+{
+	const char* s = source;
+	const char* end = source + length;
+	wchar_t* d = destination;
+	wchar_t* limit = destination + capacity;
+	while (s < end)
+	{
+#ifdef STRINGS_SSE2
+		while (end - s >= 16 && limit - d >= 16 && widenASCII(s, d))
+		{
+			s += 16;
+			d += 16;
+		}
+		if (s == end)
+		{
+			break;
+		}
+#endif
+		uint32_t c = static_cast<unsigned char>(*s);
+		size_t continuations;
+		uint32_t minimum;
+		if (c < 0x80)
+		{
+			continuations = 0;
+			minimum = 0;
+		}
+		else if ((c & 0xE0) == 0xC0)
+		{
+			continuations = 1;
+			minimum = 0x80;
+			c &= 0x1F;
+		}
+		else if ((c & 0xF0) == 0xE0)
+		{
+			continuations = 2;
+			minimum = 0x800;
+			c &= 0x0F;
+		}
+		else if ((c & 0xF8) == 0xF0)
+		{
+			continuations = 3;
+			minimum = 0x10000;
+			c &= 0x07;
+		}
+		else
+		{
+			return ConversionFailed;
+		}
+		if (static_cast<size_t>(end - s) <= continuations)
+		{
+			return ConversionFailed;
+		}
+		for (size_t i = 1; i <= continuations; i++)
+		{
+			uint32_t byte = static_cast<unsigned char>(s[i]);
+			if ((byte & 0xC0) != 0x80)
+			{
+				return ConversionFailed;
+			}
+			c = (c << 6) | (byte & 0x3F);
+		}
+		if (c < minimum || c > 0x10FFFF || isSurrogate(c))
+		{
+			return ConversionFailed;
+		}
+		s += continuations + 1;
+
+		if (WideIsUTF16 && c >= 0x10000)
+		{
+			if (limit - d < 2)
+			{
+				return ConversionFailed;
+			}
+			c -= 0x10000;
+			*d++ = static_cast<wchar_t>(0xD800 + (c >> 10));
+			*d++ = static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+		}
+		else
+		{
+			if (d == limit)
+			{
+				return ConversionFailed;
+			}
+			*d++ = static_cast<wchar_t>(c);
+		}
+	}
+	return static_cast<size_t>(d - destination);
+}
+
+size_t
+ConvertToMultiByte(const wchar_t* source, size_t length, char* destination, size_t capacity)
+{
+	const wchar_t* s = source;
+	const wchar_t* end = source + length;
+	char* d = destination;
+	char* limit = destination + capacity;
+	while (s < end)
+	{
+#ifdef STRINGS_SSE2
+		while (end - s >= 16 && limit - d >= 16 && narrowASCII(s, d))
+		{
+			s += 16;
+			d += 16;
+		}
+		if (s == end)
+		{
+			break;
+		}
+#endif
+		uint32_t c = static_cast<uint32_t>(*s++);
+		if (WideIsUTF16)
+		{
+			c &= 0xFFFF;
+			if (isSurrogate(c))
+			{
+				// A high surrogate must be followed by a low one
+				uint32_t low = s < end ? static_cast<uint32_t>(*s) & 0xFFFF : 0;
+				if (c >= 0xDC00 || low < 0xDC00 || low > 0xDFFF)
+				{
+					return ConversionFailed;
+				}
+				s++;
+				c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+			}
+		}
+		else if (c > 0x10FFFF || isSurrogate(c))
+		{
+			return ConversionFailed;
+		}
+
+		if (c < 0x80)
+		{
+			if (d == limit)
+			{
+				return ConversionFailed;
+			}
+			*d++ = static_cast<char>(c);
+		}
+		else if (c < 0x800)
+		{
+			if (limit - d < 2)
+			{
+				return ConversionFailed;
+			}
+			*d++ = static_cast<char>(0xC0 | (c >> 6));
+			*d++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			if (limit - d < 3)
+			{
+				return ConversionFailed;
+			}
+			*d++ = static_cast<char>(0xE0 | (c >> 12));
+			*d++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*d++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			if (limit - d < 4)
+			{
+				return ConversionFailed;
+			}
+			*d++ = static_cast<char>(0xF0 | (c >> 18));
+			*d++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			*d++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*d++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+	return static_cast<size_t>(d - destination);
+}
+
+bool
+ConvertToWide(std::string_view source, std::wstring& destination)
+{
+	// Sized for the worst case, so there's no pass to measure the result first
+	destination.resize(GetWideCapacity(source.size()));
+	size_t count = ConvertToWide(source.data(), source.size(), destination.data(), destination.size());
+	if (count == ConversionFailed)
+	{
+		destination.clear();
+		return false;
+	}
+	destination.resize(count);
+	return true;
+}
+
+bool
+ConvertToMultiByte(std::wstring_view source, std::string& destination)
+{
+	destination.resize(GetMultiByteCapacity(source.size()));
+	size_t count = ConvertToMultiByte(source.data(), source.size(), destination.data(), destination.size());
+	if (count == ConversionFailed)
+	{
+		destination.clear();
+		return false;
+	}
+	destination.resize(count);
+	return true;
+}
+
+std::wstring
+ConvertToWide(const std::string& string)
 {
-	int count = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS | MB_PRECOMPOSED, string.c_str(), static_cast<int>(string.size()), nullptr, 0);
 	std::wstring wide;
-	wide.resize(count);
-	count = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS | MB_PRECOMPOSED, string.c_str(), static_cast<int>(string.size()), &wide[0], static_cast<int>(wide.size()));
-	wide.resize(count);
+	ConvertToWide(std::string_view(string), wide);
 	return wide;
 }
 
-std::string ConvertToMultiByte(const std::wstring& string)
+std::string
+ConvertToMultiByte(const std::wstring& string)
 {
-	int count = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), nullptr, 0, nullptr, nullptr);
 	std::string utf8;
-	utf8.resize(count);
-	count = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, string.c_str(), static_cast<int>(string.size()), &utf8[0], static_cast<int>(utf8.size()), nullptr, nullptr);
-	utf8.resize(count);
+	ConvertToMultiByte(std::wstring_view(string), utf8);
 	return utf8;
 }
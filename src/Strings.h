@@ -12,9 +12,50 @@
 * prior written permission from Derivative.
 */
 
+
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+
+/*
+* Conversion between UTF-8 and wide strings, which are UTF-16 where wchar_t is 16 bits (Windows) and UTF-32
+* elsewhere.
+*
+* Each conversion is a single pass: runs of ASCII are converted 16 characters at a time with SSE2 where it is
+* available, and other characters are decoded and validated one at a time. Invalid input - malformed, truncated
+* or overlong UTF-8, unpaired surrogates, or values beyond U+10FFFF - fails the conversion rather than being
+* replaced.
+*/
+
+// Returned by the buffer conversions if the source is invalid or the destination too small
+constexpr size_t ConversionFailed = SIZE_MAX;
+
+// The most wchar_t converting length bytes of UTF-8 can produce
+constexpr size_t
+GetWideCapacity(size_t length)
+{
+	return length;
+}
+
+// The most bytes converting length wchar_t can produce
+constexpr size_t
+GetMultiByteCapacity(size_t length)
+{
+	return length * (sizeof(wchar_t) == 2 ? 3 : 4);
+}
+
+// Convert into caller-provided buffers, returning the number of units written - without a terminator
+size_t	ConvertToWide(const char* source, size_t length, wchar_t* destination, size_t capacity);
+size_t	ConvertToMultiByte(const wchar_t* source, size_t length, char* destination, size_t capacity);
+
+// Replace the contents of destination, reusing its storage - prefer these where a conversion is repeated
+// Return false, leaving destination empty, if source is invalid
+bool	ConvertToWide(std::string_view source, std::wstring& destination);
+bool	ConvertToMultiByte(std::wstring_view source, std::string& destination);
 
+// Return an empty string if string is invalid
 std::wstring ConvertToWide(const std::string& string);
 std::string ConvertToMultiByte(const std::wstring& string);
@@ -0,0 +1,2002 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#ifdef TOUCHENGINE_STAND_IN
+
+#include "TEStandIn.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+	struct Counters
+	{
+		std::atomic<uint64_t>	apiCalls{ 0 };
+		std::atomic<uint64_t>	valueSets{ 0 };
+		std::atomic<uint64_t>	valueGets{ 0 };
+		std::atomic<uint64_t>	objectsCreated{ 0 };
+		std::atomic<uint64_t>	objectsDestroyed{ 0 };
+		std::atomic<uint64_t>	framesStarted{ 0 };
+		std::atomic<uint64_t>	framesCompleted{ 0 };
+		std::atomic<uint64_t>	callbacks{ 0 };
+	};
+
+	Counters theCounters;
+
+	std::mutex				theConfigurationMutex;
+	TEStandInConfiguration	theConfiguration;
+
+	void
+	countCall()
+	{
+		theCounters.apiCalls.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*
+	* Every TEObject is preceded in memory by a header holding its reference count and type,
+	* so the pointers we return can be the public structs (TELinkInfo, TEStringArray, etc) themselves.
+	*/
+	struct alignas(16) ObjectHeader
+	{
+		std::atomic<int32_t>	references;
+		TEObjectType			type;
+		void					(*destroy)(ObjectHeader* header);
+	};
+
+	static_assert(sizeof(ObjectHeader) == 16, "ObjectHeader must precede objects by a fixed offset");
+
+	template <typename T>
+	struct Object
+	{
+		template <typename... Args>
+		explicit Object(TEObjectType type, Args&&... args)
+			: body(std::forward<Args>(args)...)
+		{
+			header.references = 1;
+			header.type = type;
+			header.destroy = &Object<T>::destroy;
+			theCounters.objectsCreated.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		static void
+		destroy(ObjectHeader* header)
+		{
+			delete reinterpret_cast<Object<T>*>(header);
+			theCounters.objectsDestroyed.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		ObjectHeader	header;
+		T				body;
+	};
+
+	template <typename T, typename... Args>
+	T*
+	createObject(TEObjectType type, Args&&... args)
+	{
+		static_assert(alignof(T) <= alignof(ObjectHeader), "Object alignment exceeds the header");
+		auto object = new Object<T>(type, std::forward<Args>(args)...);
+		return &object->body;
+	}
+
+	ObjectHeader*
+	getHeader(const void* object)
+	{
+		return reinterpret_cast<ObjectHeader*>(const_cast<char*>(static_cast<const char*>(object)) - sizeof(ObjectHeader));
+	}
+
+	struct CStringHash
+	{
+		size_t
+		operator()(const char* string) const
+		{
+			// FNV-1a
+			uint64_t hash = 14695981039346656037ULL;
+			for (; *string; string++)
+			{
+				hash ^= static_cast<unsigned char>(*string);
+				hash *= 1099511628211ULL;
+			}
+			return static_cast<size_t>(hash);
+		}
+	};
+
+	struct CStringEqual
+	{
+		bool
+		operator()(const char* a, const char* b) const
+		{
+			return std::strcmp(a, b) == 0;
+		}
+	};
+
+	struct LinkDefinition
+	{
+		std::string					identifier;
+		std::string					label;
+		std::string					parent;
+		TELinkInfo					info{};
+		std::vector<const char*>	children;
+	};
+
+	/*
+	* An immutable link layout, shared by an instance and any TELinkInfo or TEStringArray returned from it
+	*/
+	struct Layout
+	{
+		std::vector<std::unique_ptr<LinkDefinition>>								links;
+		std::unordered_map<const char*, size_t, CStringHash, CStringEqual>		index;
+		std::vector<const char*>													groups[2];
+		std::vector<size_t>															outputs;
+
+		const LinkDefinition*
+		find(const char* identifier, size_t* position = nullptr) const
+		{
+			if (identifier == nullptr)
+			{
+				return nullptr;
+			}
+			auto it = index.find(identifier);
+			if (it == index.end())
+			{
+				return nullptr;
+			}
+			if (position)
+			{
+				*position = it->second;
+			}
+			return links[it->second].get();
+		}
+	};
+
+	std::shared_ptr<const Layout>
+	makeLayout(const std::vector<TEStandInLink>& source)
+	{
+		auto layout = std::make_shared<Layout>();
+		layout->links.reserve(source.size());
+		for (const auto& link : source)
+		{
+			auto definition = std::make_unique<LinkDefinition>();
+			definition->identifier = link.identifier;
+			definition->label = link.label.empty() ? link.identifier : link.label;
+			definition->parent = link.parent;
+			definition->info.scope = link.scope;
+			definition->info.intent = link.intent;
+			definition->info.type = link.parent.empty() ? TELinkTypeGroup : link.type;
+			definition->info.domain = link.parent.empty() ? TELinkDomainParameterPage : TELinkDomainParameter;
+			definition->info.count = link.count;
+			layout->links.push_back(std::move(definition));
+		}
+		// Pointers are only taken once every definition is in place
+		for (size_t i = 0; i < layout->links.size(); i++)
+		{
+			auto& definition = *layout->links[i];
+			definition.info.label = definition.label.c_str();
+			definition.info.name = definition.label.c_str();
+			definition.info.identifier = definition.identifier.c_str();
+			layout->index.emplace(definition.identifier.c_str(), i);
+		}
+		for (size_t i = 0; i < layout->links.size(); i++)
+		{
+			auto& definition = *layout->links[i];
+			if (definition.parent.empty())
+			{
+				layout->groups[definition.info.scope == TEScopeInput ? 0 : 1].push_back(definition.identifier.c_str());
+			}
+			else
+			{
+				auto it = layout->index.find(definition.parent.c_str());
+				if (it != layout->index.end())
+				{
+					auto& parent = *layout->links[it->second];
+					parent.children.push_back(definition.identifier.c_str());
+					parent.info.count = static_cast<int32_t>(parent.children.size());
+				}
+				if (definition.info.scope == TEScopeOutput)
+				{
+					layout->outputs.push_back(i);
+				}
+			}
+		}
+		return layout;
+	}
+
+	struct LinkInfoObject
+	{
+		explicit LinkInfoObject(const TELinkInfo& i, std::shared_ptr<const Layout> l)
+			: info(i), layout(std::move(l))
+		{
+		}
+		TELinkInfo						info;
+		std::shared_ptr<const Layout>	layout;
+	};
+
+	struct StringArrayObject
+	{
+		StringArrayObject(const std::vector<const char*>& strings, std::shared_ptr<const Layout> l)
+			: layout(std::move(l))
+		{
+			array.count = static_cast<int32_t>(strings.size());
+			array.strings = strings.empty() ? nullptr : strings.data();
+		}
+		TEStringArray					array{};
+		std::shared_ptr<const Layout>	layout;
+	};
+
+	struct OwnedStringArrayObject
+	{
+		explicit OwnedStringArrayObject(std::vector<std::string> s)
+			: storage(std::move(s))
+		{
+			for (const auto& string : storage)
+			{
+				pointers.push_back(string.c_str());
+			}
+			array.count = static_cast<int32_t>(pointers.size());
+			array.strings = pointers.empty() ? nullptr : pointers.data();
+		}
+		TEStringArray				array{};
+		std::vector<std::string>	storage;
+		std::vector<const char*>	pointers;
+	};
+
+	struct StringObject
+	{
+		explicit StringObject(std::string s)
+			: storage(std::move(s))
+		{
+			string.string = storage.c_str();
+		}
+		TEString		string{};
+		std::string		storage;
+	};
+
+	struct LinkStateObject
+	{
+		TELinkState		state{ true, true };
+	};
+
+	struct ErrorArrayObject
+	{
+		TEErrorArray	array{ 0, nullptr };
+	};
+
+	TEString*
+	createString(std::string value)
+	{
+		return &createObject<StringObject>(TEObjectTypeString, std::move(value))->string;
+	}
+
+	struct LinkValue
+	{
+		std::vector<double>						doubles;
+		std::vector<int32_t>					ints;
+		bool									boolean{ false };
+		std::string								string;
+		TouchObject<TEObject>					object;
+		std::deque<TouchObject<TEFloatBuffer>>	queued;
+		TELinkInterest							interest{ TELinkInterestAll };
+	};
+
+	struct Job
+	{
+		enum class Kind
+		{
+			Configure,
+			Load,
+			Unload,
+			Frame
+		};
+		Kind									kind;
+		int64_t									timeValue{ 0 };
+		int32_t									timeScale{ 0 };
+		std::chrono::steady_clock::time_point	due{};
+	};
+
+	/*
+	* Instance state lives apart from the TEInstance so the worker thread can keep it alive
+	* if the final TERelease of an instance happens in one of its callbacks.
+	*/
+	struct InstanceState
+	{
+		TEInstance*						instance{ nullptr };
+		TEInstanceEventCallback			eventCallback{ nullptr };
+		TEInstanceLinkCallback			linkCallback{ nullptr };
+		TEInstanceStatisticsCallback	statisticsCallback{ nullptr };
+		void*							info{ nullptr };
+
+		std::mutex						mutex;
+		std::condition_variable			condition;
+		std::deque<Job>					jobs;
+		bool							stopping{ false };
+		bool							cancelFrames{ false };
+
+		TEStandInConfiguration			configuration;
+		std::shared_ptr<const Layout>	layout;
+		std::vector<LinkValue>			values;
+		std::string						path;
+		std::string						preferredPath;
+		std::string						assetDirectory;
+		bool							loaded{ false };
+		bool							suspended{ true };
+		TETimeMode						mode{ TETimeExternal };
+		TETextureOrigin					origin{ TETextureOriginTopLeft };
+		int64_t							rateNumerator{ 60 };
+		int32_t							rateDenominator{ 1 };
+		int32_t							framesInFlight{ 0 };
+		uint64_t						frameCount{ 0 };
+		int64_t							statisticsFrames{ 0 };
+		std::chrono::nanoseconds		statisticsTime{ 0 };
+
+		void	run();
+		void	runLoad(std::unique_lock<std::mutex>& lock);
+		void	runUnload(std::unique_lock<std::mutex>& lock);
+		void	runFrame(std::unique_lock<std::mutex>& lock, const Job& job, std::chrono::steady_clock::time_point started);
+		void	updateOutput(size_t index, uint64_t frame);
+
+		void
+		sendEvent(std::unique_lock<std::mutex>& lock, TEEvent event, TEResult result, int64_t startValue = 0, int32_t startScale = 0, int64_t endValue = 0, int32_t endScale = 0)
+		{
+			if (eventCallback)
+			{
+				lock.unlock();
+				theCounters.callbacks.fetch_add(1, std::memory_order_relaxed);
+				eventCallback(instance, event, result, startValue, startScale, endValue, endScale, info);
+				lock.lock();
+			}
+		}
+
+		void
+		sendLinkEvents(std::unique_lock<std::mutex>& lock, TELinkEvent event, const std::vector<const char*>& identifiers)
+		{
+			if (linkCallback && !identifiers.empty())
+			{
+				// The layout owns the identifiers, keep it alive while the lock is released
+				auto keep = layout;
+				lock.unlock();
+				for (const char* identifier : identifiers)
+				{
+					theCounters.callbacks.fetch_add(1, std::memory_order_relaxed);
+					linkCallback(instance, event, identifier, info);
+				}
+				lock.lock();
+			}
+		}
+	};
+}
+
+struct TEInstance_
+{
+	std::shared_ptr<InstanceState>	state;
+	std::thread						worker;
+
+	~TEInstance_()
+	{
+		{
+			std::lock_guard<std::mutex> guard(state->mutex);
+			state->stopping = true;
+		}
+		state->condition.notify_all();
+		if (worker.joinable())
+		{
+			if (worker.get_id() == std::this_thread::get_id())
+			{
+				worker.detach();
+			}
+			else
+			{
+				worker.join();
+			}
+		}
+	}
+};
+
+struct TETable_
+{
+	int32_t						rows{ 0 };
+	int32_t						columns{ 0 };
+	std::vector<std::string>	cells;
+};
+
+struct TEFloatBuffer_
+{
+	TEFloatBuffer_(double r, int32_t c, uint32_t cap, bool t, const char* const* n)
+		: rate(r), channels(std::max(c, 0)), capacity(cap), timeDependent(t)
+	{
+		values.resize(static_cast<size_t>(channels) * capacity);
+		pointers.resize(channels);
+		for (int32_t i = 0; i < channels; i++)
+		{
+			pointers[i] = values.data() + static_cast<size_t>(i) * capacity;
+		}
+		if (n)
+		{
+			for (int32_t i = 0; i < channels; i++)
+			{
+				names.push_back(n[i] ? n[i] : "");
+			}
+			for (const auto& name : names)
+			{
+				namePointers.push_back(name.c_str());
+			}
+		}
+	}
+
+	double						rate;
+	int32_t						channels;
+	uint32_t					capacity;
+	bool						timeDependent;
+	int64_t						start{ 0 };
+	uint32_t					count{ 0 };
+	TEFloatBufferExtend			before{ TEFloatBufferExtendHold };
+	TEFloatBufferExtend			after{ TEFloatBufferExtendHold };
+	float						constant{ 0.0f };
+	std::vector<float>			values;
+	std::vector<const float*>	pointers;
+	std::vector<std::string>	names;
+	std::vector<const char*>	namePointers;
+};
+
+namespace
+{
+	void
+	InstanceState::run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (stopping)
+			{
+				break;
+			}
+			Job job = jobs.front();
+			jobs.pop_front();
+			switch (job.kind)
+			{
+			case Job::Kind::Configure:
+				sendEvent(lock, TEEventInstanceReady, path.empty() ? TEResultSuccess : configuration.configureResult);
+				break;
+			case Job::Kind::Load:
+				runLoad(lock);
+				break;
+			case Job::Kind::Unload:
+				runUnload(lock);
+				break;
+			case Job::Kind::Frame:
+			{
+				auto started = std::chrono::steady_clock::now();
+				condition.wait_until(lock, job.due, [this] { return stopping || cancelFrames; });
+				if (stopping)
+				{
+					break;
+				}
+				runFrame(lock, job, started);
+				break;
+			}
+			}
+		}
+	}
+
+	void
+	InstanceState::runLoad(std::unique_lock<std::mutex>& lock)
+	{
+		condition.wait_until(lock, std::chrono::steady_clock::now() + configuration.loadLatency, [this] { return stopping; });
+		if (stopping)
+		{
+			return;
+		}
+		if (loaded)
+		{
+			runUnload(lock);
+		}
+		layout = makeLayout(configuration.links);
+		values.clear();
+		values.resize(layout->links.size());
+		for (size_t i = 0; i < layout->links.size(); i++)
+		{
+			const auto& info = layout->links[i]->info;
+			int32_t count = std::max(info.count, 0);
+			if (info.type == TELinkTypeDouble)
+			{
+				values[i].doubles.resize(count);
+			}
+			else if (info.type == TELinkTypeInt)
+			{
+				values[i].ints.resize(count);
+			}
+		}
+		loaded = true;
+
+		std::vector<const char*> added;
+		added.reserve(layout->links.size());
+		for (const auto& link : layout->links)
+		{
+			added.push_back(link->identifier.c_str());
+		}
+		sendLinkEvents(lock, TELinkEventAdded, added);
+		sendEvent(lock, TEEventInstanceDidLoad, configuration.loadResult);
+	}
+
+	void
+	InstanceState::runUnload(std::unique_lock<std::mutex>& lock)
+	{
+		if (!loaded)
+		{
+			return;
+		}
+		std::vector<const char*> removed;
+		for (const auto& link : layout->links)
+		{
+			removed.push_back(link->identifier.c_str());
+		}
+		// Keep the identifiers alive until the callbacks complete
+		auto keep = layout;
+		loaded = false;
+		sendLinkEvents(lock, TELinkEventRemoved, removed);
+		layout.reset();
+		values.clear();
+		sendEvent(lock, TEEventInstanceReady, TEResultSuccess);
+	}
+
+	void
+	InstanceState::updateOutput(size_t index, uint64_t frame)
+	{
+		const auto& info = layout->links[index]->info;
+		auto& value = values[index];
+		double phase = std::fmod(static_cast<double>(frame) / 60.0, 1.0);
+		switch (info.type)
+		{
+		case TELinkTypeBoolean:
+			value.boolean = (frame & 1) != 0;
+			break;
+		case TELinkTypeDouble:
+			for (size_t i = 0; i < value.doubles.size(); i++)
+			{
+				value.doubles[i] = phase + static_cast<double>(i);
+			}
+			break;
+		case TELinkTypeInt:
+			for (size_t i = 0; i < value.ints.size(); i++)
+			{
+				value.ints[i] = static_cast<int32_t>((frame + i) % 100);
+			}
+			break;
+		case TELinkTypeString:
+			value.object.take(createString("frame " + std::to_string(frame)));
+			break;
+		case TELinkTypeFloatBuffer:
+		{
+			TouchObject<TEFloatBuffer> buffer;
+			buffer.take(TEFloatBufferCreate(-1.0, configuration.outputChannelCount, configuration.outputSampleCount, nullptr));
+			if (buffer)
+			{
+				for (int32_t channel = 0; channel < buffer->channels; channel++)
+				{
+					float* samples = buffer->values.data() + static_cast<size_t>(channel) * buffer->capacity;
+					for (uint32_t sample = 0; sample < buffer->capacity; sample++)
+					{
+						samples[sample] = static_cast<float>(std::sin(6.283185307179586 * (phase + static_cast<double>(sample) / std::max(buffer->capacity, 1u))));
+					}
+				}
+				buffer->count = buffer->capacity;
+			}
+			value.object = buffer;
+			break;
+		}
+		case TELinkTypeStringData:
+		{
+			TouchObject<TETable> table;
+			table.take(TETableCreate());
+			TETableResize(table, configuration.outputTableRows, configuration.outputTableColumns);
+			for (auto& cell : table->cells)
+			{
+				cell = std::to_string(frame);
+			}
+			value.object = table;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void
+	InstanceState::runFrame(std::unique_lock<std::mutex>& lock, const Job& job, std::chrono::steady_clock::time_point started)
+	{
+		TEResult result = cancelFrames ? TEResultCancelled : configuration.frameResult;
+		uint64_t frame = frameCount++;
+
+		std::vector<const char*> changed;
+		if (result != TEResultCancelled && loaded)
+		{
+			changed.reserve(layout->outputs.size());
+			for (size_t index : layout->outputs)
+			{
+				updateOutput(index, frame);
+				auto& value = values[index];
+				if (value.interest == TELinkInterestSubsequentValues)
+				{
+					value.interest = TELinkInterestAll;
+				}
+				if (value.interest == TELinkInterestAll)
+				{
+					changed.push_back(layout->links[index]->identifier.c_str());
+				}
+			}
+		}
+		sendLinkEvents(lock, TELinkEventValueChange, changed);
+
+		int64_t endValue = job.timeValue;
+		if (rateNumerator > 0)
+		{
+			endValue += (static_cast<int64_t>(job.timeScale) * rateDenominator) / rateNumerator;
+		}
+		sendEvent(lock, TEEventFrameDidFinish, result, job.timeValue, job.timeScale, endValue, job.timeScale);
+
+		framesInFlight--;
+		if (framesInFlight == 0)
+		{
+			cancelFrames = false;
+		}
+		theCounters.framesCompleted.fetch_add(1, std::memory_order_relaxed);
+
+		statisticsFrames++;
+		statisticsTime += std::chrono::steady_clock::now() - started;
+		if (statisticsCallback && configuration.statisticsInterval > 0 && statisticsFrames >= configuration.statisticsInterval)
+		{
+			TEInstanceStatistics statistics{};
+			statistics.memUsedGPU = 0;
+			statistics.memUsedCPU = 0;
+			statistics.frameTimeCPU = statisticsTime.count();
+			statistics.frameTimeGPU = -1;
+			statistics.frames = statisticsFrames;
+			statistics.framesDropped = 0;
+			statisticsFrames = 0;
+			statisticsTime = std::chrono::nanoseconds(0);
+
+			auto callback = statisticsCallback;
+			lock.unlock();
+			theCounters.callbacks.fetch_add(1, std::memory_order_relaxed);
+			callback(instance, &statistics, info);
+			lock.lock();
+		}
+	}
+
+	/*
+	* Holds an instance's lock and resolves a link for the link API functions
+	*/
+	class LinkAccess
+	{
+	public:
+		LinkAccess(TEInstance* instance, const char* identifier)
+			: myLock(instance->state->mutex), myState(*instance->state)
+		{
+			countCall();
+			if (myState.loaded)
+			{
+				myDefinition = myState.layout->find(identifier, &myIndex);
+			}
+		}
+
+		explicit operator bool() const
+		{
+			return myDefinition != nullptr;
+		}
+
+		const TELinkInfo&
+		info() const
+		{
+			return myDefinition->info;
+		}
+
+		LinkValue&
+		value()
+		{
+			return myState.values[myIndex];
+		}
+
+		// Returns TEResultSuccess if the link can be set with a value of the given type
+		TEResult
+		checkSet(TELinkType type)
+		{
+			theCounters.valueSets.fetch_add(1, std::memory_order_relaxed);
+			if (!myDefinition)
+			{
+				return TEResultNoMatchingEntity;
+			}
+			if (myDefinition->info.scope != TEScopeInput || myDefinition->info.type != type)
+			{
+				return TEResultBadUsage;
+			}
+			return TEResultSuccess;
+		}
+
+		TEResult
+		checkGet(TELinkType type)
+		{
+			theCounters.valueGets.fetch_add(1, std::memory_order_relaxed);
+			if (!myDefinition)
+			{
+				return TEResultNoMatchingEntity;
+			}
+			if (myDefinition->info.type != type)
+			{
+				return TEResultBadUsage;
+			}
+			return TEResultSuccess;
+		}
+	private:
+		std::lock_guard<std::mutex>	myLock;
+		InstanceState&				myState;
+		const LinkDefinition*		myDefinition{ nullptr };
+		size_t						myIndex{ 0 };
+	};
+
+	template <typename T>
+	TEResult
+	getNumericValue(TEInstance* instance, const char* identifier, TELinkType type, const std::vector<T> LinkValue::* member, TELinkValue which, T* value, int32_t count)
+	{
+		LinkAccess link(instance, identifier);
+		TEResult result = link.checkGet(type);
+		if (result == TEResultSuccess)
+		{
+			const auto& values = link.value().*member;
+			if (count < 0 || static_cast<size_t>(count) > values.size())
+			{
+				return TEResultBadUsage;
+			}
+			for (int32_t i = 0; i < count; i++)
+			{
+				switch (which)
+				{
+				case TELinkValueCurrent:
+					value[i] = values[i];
+					break;
+				case TELinkValueMaximum:
+				case TELinkValueUIMaximum:
+					value[i] = T(1);
+					break;
+				default:
+					value[i] = T(0);
+					break;
+				}
+			}
+		}
+		return result;
+	}
+
+	template <typename T>
+	TEResult
+	setNumericValue(TEInstance* instance, const char* identifier, TELinkType type, std::vector<T> LinkValue::* member, const T* value, int32_t count)
+	{
+		LinkAccess link(instance, identifier);
+		TEResult result = link.checkSet(type);
+		if (result == TEResultSuccess)
+		{
+			auto& values = link.value().*member;
+			if (count < 0 || static_cast<size_t>(count) > values.size())
+			{
+				return TEResultBadUsage;
+			}
+			std::copy(value, value + count, values.begin());
+		}
+		return result;
+	}
+
+	template <typename T>
+	TEResult
+	getObjectValue(TEInstance* instance, const char* identifier, TELinkValue which, T** value, std::function<bool(const TELinkInfo&)> accepts)
+	{
+		LinkAccess link(instance, identifier);
+		theCounters.valueGets.fetch_add(1, std::memory_order_relaxed);
+		*value = nullptr;
+		if (!link)
+		{
+			return TEResultNoMatchingEntity;
+		}
+		if (!accepts(link.info()))
+		{
+			return TEResultBadUsage;
+		}
+		if (which == TELinkValueCurrent && link.value().object)
+		{
+			*value = static_cast<T*>(TERetain(link.value().object));
+		}
+		return TEResultSuccess;
+	}
+}
+
+void
+TEStandInSetConfiguration(const TEStandInConfiguration& configuration)
+{
+	std::lock_guard<std::mutex> guard(theConfigurationMutex);
+	theConfiguration = configuration;
+}
+
+TEStandInConfiguration
+TEStandInGetConfiguration()
+{
+	std::lock_guard<std::mutex> guard(theConfigurationMutex);
+	return theConfiguration;
+}
+
+std::vector<TEStandInLink>
+TEStandInMakeLayout(int32_t inputGroups, int32_t inputsPerGroup, int32_t outputs)
+{
+	static const TELinkType Types[] = {
+		TELinkTypeDouble,
+		TELinkTypeInt,
+		TELinkTypeString,
+		TELinkTypeTexture,
+		TELinkTypeFloatBuffer,
+		TELinkTypeStringData
+	};
+	constexpr size_t TypeCount = sizeof(Types) / sizeof(Types[0]);
+
+	std::vector<TEStandInLink> links;
+	for (int32_t group = 0; group < inputGroups; group++)
+	{
+		TEStandInLink page;
+		page.identifier = "ip" + std::to_string(group);
+		page.scope = TEScopeInput;
+		page.type = TELinkTypeGroup;
+		links.push_back(page);
+		for (int32_t i = 0; i < inputsPerGroup; i++)
+		{
+			TEStandInLink link;
+			link.parent = page.identifier;
+			link.identifier = page.identifier + "/in" + std::to_string(i);
+			link.scope = TEScopeInput;
+			link.type = Types[i % TypeCount];
+			link.count = link.type == TELinkTypeDouble ? 4 : 1;
+			link.intent = link.type == TELinkTypeDouble ? TELinkIntentColorRGBA : TELinkIntentNotSpecified;
+			links.push_back(link);
+		}
+	}
+	if (outputs > 0)
+	{
+		TEStandInLink page;
+		page.identifier = "op";
+		page.scope = TEScopeOutput;
+		page.type = TELinkTypeGroup;
+		links.push_back(page);
+		for (int32_t i = 0; i < outputs; i++)
+		{
+			TEStandInLink link;
+			link.parent = page.identifier;
+			link.identifier = "op/out" + std::to_string(i);
+			link.scope = TEScopeOutput;
+			link.type = Types[i % TypeCount];
+			links.push_back(link);
+		}
+	}
+	return links;
+}
+
+TEStandInCounters
+TEStandInGetCounters()
+{
+	TEStandInCounters counters;
+	counters.apiCalls = theCounters.apiCalls.load();
+	counters.valueSets = theCounters.valueSets.load();
+	counters.valueGets = theCounters.valueGets.load();
+	counters.objectsCreated = theCounters.objectsCreated.load();
+	counters.objectsDestroyed = theCounters.objectsDestroyed.load();
+	counters.framesStarted = theCounters.framesStarted.load();
+	counters.framesCompleted = theCounters.framesCompleted.load();
+	counters.callbacks = theCounters.callbacks.load();
+	return counters;
+}
+
+void
+TEStandInResetCounters()
+{
+	theCounters.apiCalls = 0;
+	theCounters.valueSets = 0;
+	theCounters.valueGets = 0;
+	theCounters.objectsCreated = 0;
+	theCounters.objectsDestroyed = 0;
+	theCounters.framesStarted = 0;
+	theCounters.framesCompleted = 0;
+	theCounters.callbacks = 0;
+}
+
+int32_t
+TEStandInGetReferenceCount(const TEObject* object)
+{
+	return object ? getHeader(object)->references.load() : 0;
+}
+
+/*
+* TEObject
+*/
+
+TEObject*
+TERetain(TEObject* object)
+{
+	if (object)
+	{
+		getHeader(object)->references.fetch_add(1, std::memory_order_relaxed);
+	}
+	return object;
+}
+
+void
+TERelease_(TEObject** object)
+{
+	if (object && *object)
+	{
+		ObjectHeader* header = getHeader(*object);
+		if (header->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			header->destroy(header);
+		}
+		*object = nullptr;
+	}
+}
+
+TEObjectType
+TEGetType(const TEObject* object)
+{
+	return object ? getHeader(object)->type : TEObjectTypeUnknown;
+}
+
+/*
+* TEResult
+*/
+
+const char*
+TEResultGetDescription(TEResult result)
+{
+	switch (result)
+	{
+	case TEResultSuccess:
+		return "Success";
+	case TEResultInsufficientMemory:
+		return "Insufficient memory";
+	case TEResultBadUsage:
+		return "Invalid arguments or a function was called at an improper time";
+	case TEResultNoMatchingEntity:
+		return "No matching entity";
+	case TEResultCancelled:
+		return "The operation was cancelled";
+	case TEResultFileError:
+		return "Error reading or accessing a file";
+	case TEResultComponentErrors:
+		return "Errors were reported by the component";
+	case TEResultComponentWarnings:
+		return "Warnings were reported by the component";
+	case TEResultInternalError:
+		return "Internal error";
+	default:
+		return "TouchEngine stand-in error";
+	}
+}
+
+TESeverity
+TEResultGetSeverity(TEResult result)
+{
+	switch (result)
+	{
+	case TEResultSuccess:
+		return TESeverityNone;
+	case TEResultDroppedSamples:
+	case TEResultMissedSamples:
+	case TEResultCancelled:
+	case TEResultOlderEngineVersion:
+	case TEResultComponentWarnings:
+		return TESeverityWarning;
+	default:
+		return TESeverityError;
+	}
+}
+
+/*
+* TEInstance
+*/
+
+TEResult
+TEInstanceGetSupportedFileExtensions(TEStringArray** extensions)
+{
+	countCall();
+	*extensions = &createObject<OwnedStringArrayObject>(TEObjectTypeStringArray, std::vector<std::string>{ "tox" })->array;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceCreate(TEInstanceEventCallback event_callback, TEInstanceLinkCallback link_callback, void* callback_info, TEInstance** instance)
+{
+	countCall();
+	if (event_callback == nullptr || link_callback == nullptr || instance == nullptr)
+	{
+		return TEResultBadUsage;
+	}
+	TEInstance* created = createObject<TEInstance_>(TEObjectTypeInstance);
+	auto state = std::make_shared<InstanceState>();
+	state->instance = created;
+	state->eventCallback = event_callback;
+	state->linkCallback = link_callback;
+	state->info = callback_info;
+	created->state = state;
+	created->worker = std::thread([state]() { state->run(); });
+	*instance = created;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSetPreferredEnginePath(TEInstance* instance, const char* path)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->preferredPath = path ? path : "";
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetPreferredEnginePath(TEInstance* instance, TEString** string)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*string = createString(instance->state->preferredPath);
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetConfiguredEnginePath(TEInstance*, TEString** string)
+{
+	countCall();
+	*string = createString("stand-in");
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceConfigure(TEInstance* instance, const char* path, TETimeMode mode)
+{
+	countCall();
+	auto& state = *instance->state;
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+		state.configuration = TEStandInGetConfiguration();
+		state.path = path ? path : "";
+		state.mode = mode;
+		// Frames already started still finish, cancelled, as they do for TEInstanceUnload()
+		state.jobs.erase(std::remove_if(state.jobs.begin(), state.jobs.end(), [](const Job& job) { return job.kind != Job::Kind::Frame; }), state.jobs.end());
+		state.cancelFrames = state.framesInFlight > 0;
+		if (state.loaded)
+		{
+			state.jobs.push_back({ Job::Kind::Unload });
+		}
+		state.jobs.push_back({ Job::Kind::Configure });
+	}
+	state.condition.notify_all();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceLoad(TEInstance* instance)
+{
+	countCall();
+	auto& state = *instance->state;
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+		if (state.path.empty())
+		{
+			return TEResultBadUsage;
+		}
+		state.jobs.push_back({ Job::Kind::Load });
+	}
+	state.condition.notify_all();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceUnload(TEInstance* instance)
+{
+	countCall();
+	auto& state = *instance->state;
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+		state.cancelFrames = state.framesInFlight > 0;
+		state.jobs.push_back({ Job::Kind::Unload });
+	}
+	state.condition.notify_all();
+	return TEResultSuccess;
+}
+
+bool
+TEInstanceHasFile(TEInstance* instance)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	return !instance->state->path.empty();
+}
+
+void
+TEInstanceGetPath(TEInstance* instance, TEString** string)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*string = createString(instance->state->path);
+}
+
+TETimeMode
+TEInstanceGetTimeMode(TEInstance* instance)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	return instance->state->mode;
+}
+
+TEResult
+TEInstanceAssociateGraphicsContext(TEInstance*, TEGraphicsContext*)
+{
+	countCall();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceAssociateAdapter(TEInstance*, TEAdapter*)
+{
+	countCall();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSetOutputTextureOrigin(TEInstance* instance, TETextureOrigin origin)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->origin = origin;
+	return TEResultSuccess;
+}
+
+TETextureOrigin
+TEInstanceGetOutputTextureOrigin(TEInstance* instance)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	return instance->state->origin;
+}
+
+TEResult
+TEInstanceResume(TEInstance* instance)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->suspended = false;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSuspend(TEInstance* instance)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->suspended = true;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSetFrameRate(TEInstance* instance, int64_t numerator, int32_t denominator)
+{
+	countCall();
+	if (numerator <= 0 || denominator <= 0)
+	{
+		return TEResultBadUsage;
+	}
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->rateNumerator = numerator;
+	instance->state->rateDenominator = denominator;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSetFloatFrameRate(TEInstance* instance, float rate)
+{
+	return TEInstanceSetFrameRate(instance, static_cast<int64_t>(std::llround(rate * 1000.0)), 1000);
+}
+
+TEResult
+TEInstanceGetFrameRate(TEInstance* instance, int64_t* numerator, int32_t* denominator)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*numerator = instance->state->rateNumerator;
+	*denominator = instance->state->rateDenominator;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetFloatFrameRate(TEInstance* instance, float* rate)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*rate = static_cast<float>(static_cast<double>(instance->state->rateNumerator) / instance->state->rateDenominator);
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceSetStatisticsCallback(TEInstance* instance, TEInstanceStatisticsCallback callback)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->statisticsCallback = callback;
+	return TEResultSuccess;
+}
+
+void
+TEInstanceGetAssetDirectory(TEInstance* instance, TEString** string)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*string = createString(instance->state->assetDirectory);
+}
+
+TEResult
+TEInstanceSetAssetDirectory(TEInstance* instance, const char* path)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	instance->state->assetDirectory = path ? path : "";
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetSupportedTextureTypes(TEInstance*, TETextureType[], int32_t* count)
+{
+	countCall();
+	*count = 0;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetSupportedTextureFormats(TEInstance*, TETextureFormat[], int32_t* count)
+{
+	countCall();
+	*count = 0;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetSupportedSemaphoreTypes(TEInstance*, TESemaphoreType[], int32_t* count)
+{
+	countCall();
+	*count = 0;
+	return TEResultSuccess;
+}
+
+bool
+TEInstanceDoesTextureOwnershipTransfer(TEInstance*)
+{
+	countCall();
+	return false;
+}
+
+TEResult
+TEInstanceAddTextureTransfer(TEInstance*, TETexture*, TESemaphore*, uint64_t)
+{
+	countCall();
+	return TEResultSuccess;
+}
+
+bool
+TEInstanceHasTextureTransfer(TEInstance*, const TETexture*)
+{
+	countCall();
+	return false;
+}
+
+TEResult
+TEInstanceGetTextureTransfer(TEInstance*, const TETexture*, TESemaphore** semaphore, uint64_t*)
+{
+	countCall();
+	*semaphore = nullptr;
+	return TEResultNoMatchingEntity;
+}
+
+TEResult
+TEInstanceStartFrameAtTime(TEInstance* instance, int64_t time_value, int32_t time_scale, bool)
+{
+	countCall();
+	auto& state = *instance->state;
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+		if (!state.loaded || state.suspended || time_scale <= 0)
+		{
+			return TEResultBadUsage;
+		}
+		if (state.framesInFlight >= std::max(state.configuration.maxFramesInFlight, 1))
+		{
+			return TEResultBadUsage;
+		}
+		state.framesInFlight++;
+		Job job{ Job::Kind::Frame, time_value, time_scale };
+		job.due = std::chrono::steady_clock::now() + state.configuration.frameLatency;
+		state.jobs.push_back(job);
+	}
+	theCounters.framesStarted.fetch_add(1, std::memory_order_relaxed);
+	state.condition.notify_all();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceCancelFrame(TEInstance* instance)
+{
+	countCall();
+	auto& state = *instance->state;
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+		if (state.framesInFlight == 0)
+		{
+			return TEResultBadUsage;
+		}
+		state.cancelFrames = true;
+	}
+	state.condition.notify_all();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetErrors(TEInstance*, TEErrorArray** errors)
+{
+	countCall();
+	*errors = &createObject<ErrorArrayObject>(TEObjectTypeErrorArray)->array;
+	return TEResultSuccess;
+}
+
+/*
+* Link Layout
+*/
+
+TEResult
+TEInstanceLinkGetChildren(TEInstance* instance, const char* identifier, TEStringArray** children)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*children = nullptr;
+	const auto& layout = instance->state->layout;
+	if (!layout)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	if (identifier == nullptr || *identifier == 0)
+	{
+		std::vector<const char*> top(layout->groups[0]);
+		top.insert(top.end(), layout->groups[1].begin(), layout->groups[1].end());
+		std::vector<std::string> owned(top.begin(), top.end());
+		*children = &createObject<OwnedStringArrayObject>(TEObjectTypeStringArray, std::move(owned))->array;
+		return TEResultSuccess;
+	}
+	const LinkDefinition* definition = layout->find(identifier);
+	if (!definition)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	*children = &createObject<StringArrayObject>(TEObjectTypeStringArray, definition->children, layout)->array;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceLinkGetParent(TEInstance* instance, const char* identifier, TEString** string)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*string = nullptr;
+	const auto& layout = instance->state->layout;
+	const LinkDefinition* definition = layout ? layout->find(identifier) : nullptr;
+	if (!definition)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	*string = createString(definition->parent);
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceGetLinkGroups(TEInstance* instance, TEScope scope, TEStringArray** groups)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	const auto& layout = instance->state->layout;
+	static const std::vector<const char*> empty;
+	const auto& source = layout ? layout->groups[scope == TEScopeInput ? 0 : 1] : empty;
+	*groups = &createObject<StringArrayObject>(TEObjectTypeStringArray, source, layout)->array;
+	return TEResultSuccess;
+}
+
+/*
+* Link Basics
+*/
+
+TEResult
+TEInstanceLinkGetInfo(TEInstance* instance, const char* identifier, TELinkInfo** info)
+{
+	countCall();
+	std::lock_guard<std::mutex> guard(instance->state->mutex);
+	*info = nullptr;
+	const auto& layout = instance->state->layout;
+	const LinkDefinition* definition = layout ? layout->find(identifier) : nullptr;
+	if (!definition)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	*info = &createObject<LinkInfoObject>(TEObjectTypeLinkInfo, definition->info, layout)->info;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceLinkGetState(TEInstance* instance, const char* identifier, TELinkState** state)
+{
+	LinkAccess link(instance, identifier);
+	*state = nullptr;
+	if (!link)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	*state = &createObject<LinkStateObject>(TEObjectTypeLinkState)->state;
+	return TEResultSuccess;
+}
+
+bool
+TEInstanceLinkHasChoices(TEInstance*, const char*)
+{
+	countCall();
+	return false;
+}
+
+TEResult
+TEInstanceLinkGetChoiceLabels(TEInstance*, const char*, TEStringArray** labels)
+{
+	countCall();
+	*labels = nullptr;
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceLinkGetChoiceValues(TEInstance*, const char*, TEStringArray** values)
+{
+	countCall();
+	*values = nullptr;
+	return TEResultSuccess;
+}
+
+bool
+TEInstanceLinkHasUserTint(TEInstance*, const char*)
+{
+	countCall();
+	return false;
+}
+
+TEResult
+TEInstanceLinkGetUserTint(TEInstance*, const char*, TEColor*)
+{
+	countCall();
+	return TEResultNoMatchingEntity;
+}
+
+TEResult
+TEInstanceLinkSetInterest(TEInstance* instance, const char* identifier, TELinkInterest interest)
+{
+	LinkAccess link(instance, identifier);
+	if (!link)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	link.value().interest = interest;
+	return TEResultSuccess;
+}
+
+TELinkInterest
+TEInstanceLinkGetInterest(TEInstance* instance, const char* identifier)
+{
+	LinkAccess link(instance, identifier);
+	return link ? link.value().interest : TELinkInterestNone;
+}
+
+/*
+* Getting Link Values
+*/
+
+bool
+TEInstanceLinkHasValue(TEInstance* instance, const char* identifier, TELinkValue which, int32_t)
+{
+	LinkAccess link(instance, identifier);
+	return link && (which == TELinkValueCurrent || which == TELinkValueDefault);
+}
+
+TEResult
+TEInstanceLinkGetBooleanValue(TEInstance* instance, const char* identifier, TELinkValue which, bool* value)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkGet(TELinkTypeBoolean);
+	if (result == TEResultSuccess)
+	{
+		*value = which == TELinkValueCurrent ? link.value().boolean : false;
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkGetDoubleValue(TEInstance* instance, const char* identifier, TELinkValue which, double* value, int32_t count)
+{
+	return getNumericValue(instance, identifier, TELinkTypeDouble, &LinkValue::doubles, which, value, count);
+}
+
+TEResult
+TEInstanceLinkGetIntValue(TEInstance* instance, const char* identifier, TELinkValue which, int32_t* value, int32_t count)
+{
+	return getNumericValue(instance, identifier, TELinkTypeInt, &LinkValue::ints, which, value, count);
+}
+
+TEResult
+TEInstanceLinkGetStringValue(TEInstance* instance, const char* identifier, TELinkValue which, TEString** string)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkGet(TELinkTypeString);
+	*string = nullptr;
+	if (result == TEResultSuccess)
+	{
+		auto& value = link.value();
+		if (which == TELinkValueCurrent && value.object && TEGetType(value.object) == TEObjectTypeString)
+		{
+			*string = static_cast<TEString*>(TERetain(value.object));
+		}
+		else
+		{
+			*string = createString(which == TELinkValueCurrent ? value.string : std::string());
+		}
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkGetTextureValue(TEInstance* instance, const char* identifier, TELinkValue, TETexture** value)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkGet(TELinkTypeTexture);
+	// Textures are never produced by the stand-in
+	*value = nullptr;
+	return result;
+}
+
+TEResult
+TEInstanceLinkGetTableValue(TEInstance* instance, const char* identifier, TELinkValue which, TETable** value)
+{
+	return getObjectValue(instance, identifier, which, value, [](const TELinkInfo& info) {
+		return info.type == TELinkTypeStringData;
+	});
+}
+
+TEResult
+TEInstanceLinkGetFloatBufferValue(TEInstance* instance, const char* identifier, TELinkValue which, TEFloatBuffer** value)
+{
+	return getObjectValue(instance, identifier, which, value, [](const TELinkInfo& info) {
+		return info.type == TELinkTypeFloatBuffer;
+	});
+}
+
+TEResult
+TEInstanceLinkGetObjectValue(TEInstance* instance, const char* identifier, TELinkValue which, TEObject** value)
+{
+	return getObjectValue(instance, identifier, which, value, [](const TELinkInfo& info) {
+		return info.type == TELinkTypeStringData || info.type == TELinkTypeFloatBuffer || info.type == TELinkTypeTexture || info.type == TELinkTypeString;
+	});
+}
+
+/*
+* Setting Input Link Values
+*/
+
+TEResult
+TEInstanceLinkSetBooleanValue(TEInstance* instance, const char* identifier, bool value)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkSet(TELinkTypeBoolean);
+	if (result == TEResultSuccess)
+	{
+		link.value().boolean = value;
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkSetDoubleValue(TEInstance* instance, const char* identifier, const double* value, int32_t count)
+{
+	return setNumericValue(instance, identifier, TELinkTypeDouble, &LinkValue::doubles, value, count);
+}
+
+TEResult
+TEInstanceLinkSetIntValue(TEInstance* instance, const char* identifier, const int32_t* value, int32_t count)
+{
+	return setNumericValue(instance, identifier, TELinkTypeInt, &LinkValue::ints, value, count);
+}
+
+TEResult
+TEInstanceLinkSetStringValue(TEInstance* instance, const char* identifier, const char* value)
+{
+	LinkAccess link(instance, identifier);
+	theCounters.valueSets.fetch_add(1, std::memory_order_relaxed);
+	if (!link)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	if (link.info().scope != TEScopeInput || (link.info().type != TELinkTypeString && link.info().type != TELinkTypeStringData))
+	{
+		return TEResultBadUsage;
+	}
+	link.value().string = value ? value : "";
+	link.value().object.reset();
+	return TEResultSuccess;
+}
+
+TEResult
+TEInstanceLinkSetTextureValue(TEInstance* instance, const char* identifier, TETexture*, TEGraphicsContext*)
+{
+	LinkAccess link(instance, identifier);
+	// The texture is not retained: the stand-in does no work with textures
+	return link.checkSet(TELinkTypeTexture);
+}
+
+TEResult
+TEInstanceLinkSetFloatBufferValue(TEInstance* instance, const char* identifier, const TEFloatBuffer* buffer)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkSet(TELinkTypeFloatBuffer);
+	if (result == TEResultSuccess)
+	{
+		link.value().object.set(const_cast<TEFloatBuffer*>(buffer));
+		link.value().queued.clear();
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkAddFloatBuffer(TEInstance* instance, const char* identifier, const TEFloatBuffer* buffer)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkSet(TELinkTypeFloatBuffer);
+	if (result == TEResultSuccess)
+	{
+		if (buffer == nullptr || !buffer->timeDependent)
+		{
+			return TEResultBadUsage;
+		}
+		auto& queued = link.value().queued;
+		// Bound the queue as the instance would, dropping the oldest samples
+		while (queued.size() >= 16)
+		{
+			queued.pop_front();
+		}
+		queued.emplace_back(TouchObject<TEFloatBuffer>::make_set(const_cast<TEFloatBuffer*>(buffer)));
+		link.value().object.set(const_cast<TEFloatBuffer*>(buffer));
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkSetTableValue(TEInstance* instance, const char* identifier, const TETable* table)
+{
+	LinkAccess link(instance, identifier);
+	TEResult result = link.checkSet(TELinkTypeStringData);
+	if (result == TEResultSuccess)
+	{
+		link.value().object.set(const_cast<TETable*>(table));
+	}
+	return result;
+}
+
+TEResult
+TEInstanceLinkSetObjectValue(TEInstance* instance, const char* identifier, TEObject* object)
+{
+	switch (TEGetType(object))
+	{
+	case TEObjectTypeTable:
+		return TEInstanceLinkSetTableValue(instance, identifier, static_cast<TETable*>(object));
+	case TEObjectTypeFloatBuffer:
+		return TEInstanceLinkSetFloatBufferValue(instance, identifier, static_cast<TEFloatBuffer*>(object));
+	case TEObjectTypeString:
+		return TEInstanceLinkSetStringValue(instance, identifier, static_cast<TEString*>(object)->string);
+	default:
+		return TEResultBadUsage;
+	}
+}
+
+TEResult
+TEInstanceLinkSetSequenceCount(TEInstance* instance, const char* identifier, int32_t)
+{
+	LinkAccess link(instance, identifier);
+	if (!link)
+	{
+		return TEResultNoMatchingEntity;
+	}
+	// The stand-in's synthetic layouts have no sequences
+	return TEResultBadUsage;
+}
+
+/*
+* TEGraphicsContext
+*/
+
+TEAdapter*
+TEGraphicsContextGetAdapter(TEGraphicsContext*)
+{
+	countCall();
+	return nullptr;
+}
+
+/*
+* TEFloatBuffer
+*/
+
+TEFloatBuffer*
+TEFloatBufferCreate(double rate, int32_t channels, uint32_t capacity, const char* const* names)
+{
+	countCall();
+	if (channels < 0)
+	{
+		return nullptr;
+	}
+	return createObject<TEFloatBuffer_>(TEObjectTypeFloatBuffer, rate, channels, capacity, false, names);
+}
+
+TEFloatBuffer*
+TEFloatBufferCreateTimeDependent(double rate, int32_t channels, uint32_t capacity, const char* const* names)
+{
+	countCall();
+	if (channels < 0 || rate <= 0.0)
+	{
+		return nullptr;
+	}
+	return createObject<TEFloatBuffer_>(TEObjectTypeFloatBuffer, rate, channels, capacity, true, names);
+}
+
+TEFloatBuffer*
+TEFloatBufferCreateCopy(const TEFloatBuffer* buffer)
+{
+	countCall();
+	TEFloatBuffer* copy = createObject<TEFloatBuffer_>(TEObjectTypeFloatBuffer, buffer->rate, buffer->channels, buffer->capacity, buffer->timeDependent,
+		buffer->namePointers.empty() ? nullptr : buffer->namePointers.data());
+	copy->start = buffer->start;
+	copy->count = buffer->count;
+	copy->before = buffer->before;
+	copy->after = buffer->after;
+	copy->constant = buffer->constant;
+	std::copy(buffer->values.begin(), buffer->values.end(), copy->values.begin());
+	return copy;
+}
+
+TEResult
+TEFloatBufferSetValues(TEFloatBuffer* buffer, const float** values, uint32_t count)
+{
+	countCall();
+	if (count > buffer->capacity)
+	{
+		return TEResultBadUsage;
+	}
+	for (int32_t channel = 0; channel < buffer->channels; channel++)
+	{
+		std::memcpy(buffer->values.data() + static_cast<size_t>(channel) * buffer->capacity, values[channel], sizeof(float) * count);
+	}
+	buffer->count = count;
+	return TEResultSuccess;
+}
+
+TEResult
+TEFloatBufferSetStartTime(TEFloatBuffer* buffer, int64_t start)
+{
+	countCall();
+	buffer->start = start;
+	return TEResultSuccess;
+}
+
+const float* const*
+TEFloatBufferGetValues(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->pointers.empty() ? nullptr : buffer->pointers.data();
+}
+
+bool
+TEFloatBufferIsTimeDependent(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->timeDependent;
+}
+
+int64_t
+TEFloatBufferGetStartTime(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->start;
+}
+
+int64_t
+TEFloatBufferGetEndTime(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->start + buffer->count;
+}
+
+uint32_t
+TEFloatBufferGetCapacity(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->capacity;
+}
+
+double
+TEFloatBufferGetRate(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->rate;
+}
+
+int32_t
+TEFloatBufferGetChannelCount(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->channels;
+}
+
+uint32_t
+TEFloatBufferGetValueCount(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->count;
+}
+
+const char* const*
+TEFloatBufferGetChannelNames(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->namePointers.empty() ? nullptr : buffer->namePointers.data();
+}
+
+TEFloatBufferExtend
+TEFloatBufferGetExtendBefore(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->before;
+}
+
+TEFloatBufferExtend
+TEFloatBufferGetExtendAfter(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->after;
+}
+
+float
+TEFloatBufferGetExtendConstantValue(const TEFloatBuffer* buffer)
+{
+	countCall();
+	return buffer->constant;
+}
+
+void
+TEFloatBufferSetExtend(TEFloatBuffer* buffer, TEFloatBufferExtend before, TEFloatBufferExtend after, float constant)
+{
+	countCall();
+	buffer->before = before;
+	buffer->after = after;
+	buffer->constant = constant;
+}
+
+/*
+* TETable
+*/
+
+TETable*
+TETableCreate(void)
+{
+	countCall();
+	return createObject<TETable_>(TEObjectTypeTable);
+}
+
+TETable*
+TETableCreateCopy(const TETable* table)
+{
+	countCall();
+	TETable* copy = createObject<TETable_>(TEObjectTypeTable);
+	copy->rows = table->rows;
+	copy->columns = table->columns;
+	copy->cells = table->cells;
+	return copy;
+}
+
+int32_t
+TETableGetRowCount(const TETable* table)
+{
+	countCall();
+	return table->rows;
+}
+
+int32_t
+TETableGetColumnCount(const TETable* table)
+{
+	countCall();
+	return table->columns;
+}
+
+const char*
+TETableGetStringValue(const TETable* table, int32_t row, int32_t column)
+{
+	countCall();
+	if (row < 0 || column < 0 || row >= table->rows || column >= table->columns)
+	{
+		return nullptr;
+	}
+	return table->cells[static_cast<size_t>(row) * table->columns + column].c_str();
+}
+
+void
+TETableResize(TETable* table, int32_t rows, int32_t columns)
+{
+	countCall();
+	rows = std::max(rows, 0);
+	columns = std::max(columns, 0);
+	if (rows == table->rows && columns == table->columns)
+	{
+		return;
+	}
+	if (columns == table->columns)
+	{
+		table->cells.resize(static_cast<size_t>(rows) * columns);
+	}
+	else
+	{
+		std::vector<std::string> cells(static_cast<size_t>(rows) * columns);
+		for (int32_t row = 0; row < std::min(rows, table->rows); row++)
+		{
+			for (int32_t column = 0; column < std::min(columns, table->columns); column++)
+			{
+				cells[static_cast<size_t>(row) * columns + column] = std::move(table->cells[static_cast<size_t>(row) * table->columns + column]);
+			}
+		}
+		table->cells = std::move(cells);
+	}
+	table->rows = rows;
+	table->columns = columns;
+}
+
+TEResult
+TETableSetStringValue(TETable* table, int32_t row, int32_t column, const char* value)
+{
+	countCall();
+	if (row < 0 || column < 0 || row >= table->rows || column >= table->columns)
+	{
+		return TEResultBadUsage;
+	}
+	auto& cell = table->cells[static_cast<size_t>(row) * table->columns + column];
+	if (value)
+	{
+		cell.assign(value);
+	}
+	else
+	{
+		cell.clear();
+	}
+	return TEResultSuccess;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+* An in-process stand-in for the TouchEngine library, for profiling the host side of the example
+* without a TouchDesigner installation or a GPU.
+*
+* To use it, compile TEStandIn.cpp with TOUCHENGINE_STAND_IN defined and do not link TouchEngine.lib.
+* On Windows also define TE_EXPORT as empty so the TouchEngine headers do not declare dllimport functions.
+*
+* The stand-in implements TEObject reference counting, TEInstance (configure, load, link layout, link values
+* and frames), TEFloatBuffer and TETable. It presents a synthetic link layout you describe with a
+* TEStandInConfiguration, and delivers all instance and link callbacks from a worker thread owned by each
+* instance, after a configurable latency. Texture outputs have no value, and texture inputs are accepted
+* and discarded.
+*/
+
+struct TEStandInLink
+{
+	// Empty for a top-level group
+	std::string		parent;
+	std::string		identifier;
+	std::string		label;
+	TEScope			scope{ TEScopeInput };
+	TELinkType		type{ TELinkTypeDouble };
+	TELinkIntent	intent{ TELinkIntentNotSpecified };
+	// For value links, the number of values - for groups this is ignored and the number of children is used
+	int32_t			count{ 1 };
+};
+
+struct TEStandInConfiguration
+{
+	// Groups must be listed before their children
+	std::vector<TEStandInLink>	links;
+
+	// The time between TEInstanceStartFrameAtTime() and the frame's output and completion callbacks
+	std::chrono::microseconds	frameLatency{ 0 };
+
+	// The time between TEInstanceLoad() and the first TELinkEventAdded
+	std::chrono::microseconds	loadLatency{ 0 };
+
+	// The number of frames which may be started before earlier ones complete
+	int32_t						maxFramesInFlight{ 1 };
+
+	// Statistics are delivered to any TEInstanceStatisticsCallback after this many frames
+	int32_t						statisticsInterval{ 60 };
+
+	// Shape of the values given to float buffer and string data outputs each frame
+	int32_t						outputChannelCount{ 2 };
+	uint32_t					outputSampleCount{ 1 };
+	int32_t						outputTableRows{ 3 };
+	int32_t						outputTableColumns{ 2 };
+
+	// Results delivered with TEEventInstanceReady, TEEventInstanceDidLoad and TEEventFrameDidFinish
+	TEResult					configureResult{ TEResultSuccess };
+	TEResult					loadResult{ TEResultSuccess };
+	TEResult					frameResult{ TEResultSuccess };
+};
+
+struct TEStandInCounters
+{
+	uint64_t	apiCalls{ 0 };
+	uint64_t	valueSets{ 0 };
+	uint64_t	valueGets{ 0 };
+	uint64_t	objectsCreated{ 0 };
+	uint64_t	objectsDestroyed{ 0 };
+	uint64_t	framesStarted{ 0 };
+	uint64_t	framesCompleted{ 0 };
+	uint64_t	callbacks{ 0 };
+};
+
+/*
+* Sets the configuration used by instances when they are subsequently configured with TEInstanceConfigure().
+*/
+void					TEStandInSetConfiguration(const TEStandInConfiguration& configuration);
+TEStandInConfiguration	TEStandInGetConfiguration();
+
+/*
+* Builds a layout with 'inputGroups' input groups of 'inputsPerGroup' links each, and 'outputs' output links
+* in a single group. Link types cycle through double, int, string, texture, float buffer and string data.
+*/
+std::vector<TEStandInLink>	TEStandInMakeLayout(int32_t inputGroups, int32_t inputsPerGroup, int32_t outputs);
+
+/*
+* Process-wide counts of calls into the stand-in, for measuring host overhead.
+*/
+TEStandInCounters	TEStandInGetCounters();
+void				TEStandInResetCounters();
+
+/*
+* Returns the current reference count of a TEObject created by the stand-in.
+*/
+int32_t				TEStandInGetReferenceCount(const TEObject* object);
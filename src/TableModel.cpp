@@ -0,0 +1,117 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "TableModel.h"
+#include "Trace.h"
+#include <algorithm>
+
+TableModel::TableModel(int32_t rows, int32_t columns)
+{
+	resize(rows, columns);
+}
+
+void
+TableModel::resize(int32_t rows, int32_t columns)
+{
+	rows = std::max(rows, 0);
+	columns = std::max(columns, 0);
+	if (rows == myRows && columns == myColumns)
+	{
+		return;
+	}
+
+	myGeneration++;
+	std::vector<Cell> cells(static_cast<size_t>(rows) * columns);
+	for (int32_t row = 0; row < std::min(rows, myRows); row++)
+	{
+		for (int32_t column = 0; column < std::min(columns, myColumns); column++)
+		{
+			cells[static_cast<size_t>(row) * columns + column] = std::move(myCells[getIndex(row, column)]);
+		}
+	}
+	// Tables are rewritten in full after a change of shape, so every cell counts as changed
+	for (auto& cell : cells)
+	{
+		cell.generation = myGeneration;
+	}
+	myCells = std::move(cells);
+	myRowGenerations.assign(rows, myGeneration);
+	myRows = rows;
+	myColumns = columns;
+	myShapeGeneration = myGeneration;
+}
+
+void
+TableModel::set(int32_t row, int32_t column, std::string_view value)
+{
+	Cell& cell = myCells[getIndex(row, column)];
+	if (cell.value != value)
+	{
+		cell.value.assign(value.data(), value.size());
+		cell.generation = ++myGeneration;
+		myRowGenerations[row] = myGeneration;
+	}
+}
+
+size_t
+TableModel::update(const TouchObject<TETable>& table)
+{
+	TRACE_SCOPE("TableModel::update");
+
+	auto tracked = std::find_if(myTables.begin(), myTables.end(), [&table](const TrackedTable& t) { return t.table.get() == table.get(); });
+	uint64_t since = 0;
+	if (tracked != myTables.end())
+	{
+		since = tracked->generation;
+		// Move to the back, as the most recently updated
+		std::rotate(tracked, tracked + 1, myTables.end());
+		myTables.back().generation = myGeneration;
+	}
+	else
+	{
+		if (myTables.size() >= TrackedTableLimit)
+		{
+			myTables.erase(myTables.begin());
+		}
+		myTables.push_back({ table, myGeneration });
+	}
+
+	if (since < myShapeGeneration)
+	{
+		since = 0;
+		if (TETableGetRowCount(table) != myRows || TETableGetColumnCount(table) != myColumns)
+		{
+			TRACE_TE(TETableResize, table, myRows, myColumns);
+		}
+	}
+
+	size_t written = 0;
+	for (int32_t row = 0; row < myRows; row++)
+	{
+		if (myRowGenerations[row] <= since)
+		{
+			continue;
+		}
+		for (int32_t column = 0; column < myColumns; column++)
+		{
+			const Cell& cell = myCells[getIndex(row, column)];
+			if (cell.generation > since)
+			{
+				TETableSetStringValue(table, row, column, cell.value.c_str());
+				written++;
+			}
+		}
+	}
+	return written;
+}
@@ -0,0 +1,111 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <TouchEngine/TouchObject.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+* A host-side table for a string data input, which tracks its changes so TETables can be brought up to
+* date by writing only the cells which differ.
+*
+* Every change advances a generation, and each cell and row remembers the generation it last changed in.
+* update() remembers the generation each TETable was last brought to, so a table from a pool - which may
+* be several frames behind - receives exactly the cells changed since.
+*
+* Not thread-safe: edit the model on the thread which sets inputs, or guard it yourself.
+*/
+class TableModel
+{
+public:
+	TableModel(int32_t rows = 0, int32_t columns = 0);
+	TableModel(const TableModel& o) = delete;
+	TableModel& operator=(const TableModel& o) = delete;
+
+	// Keeps the values of cells inside both shapes, new cells are empty
+	void	resize(int32_t rows, int32_t columns);
+
+	// Does nothing if the cell already holds value
+	void	set(int32_t row, int32_t column, std::string_view value);
+	const std::string&
+	get(int32_t row, int32_t column) const
+	{
+		return myCells[getIndex(row, column)].value;
+	}
+
+	int32_t
+	getRowCount() const
+	{
+		return myRows;
+	}
+
+	int32_t
+	getColumnCount() const
+	{
+		return myColumns;
+	}
+
+	// Advances with every change, so a host can tell whether the table needs setting at all
+	uint64_t
+	getGeneration() const
+	{
+		return myGeneration;
+	}
+
+	/*
+	* Brings table up to date, resizing it if necessary, and returns the number of cells written. Tables this
+	* model hasn't updated recently are written in full.
+	*/
+	size_t	update(const TouchObject<TETable>& table);
+private:
+	// The most tables whose generation we remember - enough for a link's pooled tables
+	static constexpr size_t	 TrackedTableLimit{ 8 };
+
+	struct Cell
+	{
+		std::string		value;
+		uint64_t		generation = 0;
+	};
+
+	struct TrackedTable
+	{
+		// Holding a reference stops the address being reused by another table
+		TouchObject<TETable>	table;
+		uint64_t				generation;
+	};
+
+	size_t
+	getIndex(int32_t row, int32_t column) const
+	{
+		return static_cast<size_t>(row) * myColumns + column;
+	}
+
+	int32_t					myRows{ 0 };
+	int32_t					myColumns{ 0 };
+	std::vector<Cell>		myCells;
+	// The latest generation of any cell in each row
+	std::vector<uint64_t>	myRowGenerations;
+	uint64_t				myGeneration{ 1 };
+	// Tables written before this generation are the wrong shape
+	uint64_t				myShapeGeneration{ 1 };
+	// Most recently updated last
+	std::vector<TrackedTable>	myTables;
+};
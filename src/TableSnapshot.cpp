@@ -0,0 +1,174 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "TableSnapshot.h"
+#include "Trace.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	// 64-bit FNV-1a, continuing from hash
+	uint64_t
+	hashBytes(const void* data, size_t length, uint64_t hash)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < length; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+bool
+TableSnapshot::update(const TouchObject<TETable>& table)
+{
+	TRACE_SCOPE("TableSnapshot::update");
+	if (!table)
+	{
+		if (!myHasTable)
+		{
+			return false;
+		}
+		clear();
+		return true;
+	}
+
+	int32_t rows = TETableGetRowCount(table);
+	int32_t columns = TETableGetColumnCount(table);
+	uint64_t hash = hashBytes(&rows, sizeof(rows), 14695981039346656037ULL);
+	hash = hashBytes(&columns, sizeof(columns), hash);
+
+	// The only pass over the table, after which it isn't called again
+	myCells.resize(static_cast<size_t>(rows) * columns);
+	for (int32_t row = 0; row < rows; row++)
+	{
+		for (int32_t column = 0; column < columns; column++)
+		{
+			const char* value = TETableGetStringValue(table, row, column);
+			std::string_view cell = value ? std::string_view(value) : std::string_view();
+			myCells[static_cast<size_t>(column) * rows + row] = cell;
+			// Including the terminator, so cell boundaries affect the hash
+			hash = hashBytes(cell.data(), cell.size(), hash);
+			hash = hashBytes("", 1, hash);
+		}
+	}
+	if (myHasTable && hash == myHash)
+	{
+		myCells.clear();
+		return false;
+	}
+
+	clear();
+	myHasTable = true;
+	myHash = hash;
+	myRowCount = rows;
+	myColumnCount = columns;
+
+	myColumns.resize(myColumnCount);
+	size_t stringSize = 0;
+	for (int32_t i = 0; i < myColumnCount; i++)
+	{
+		Column& column = myColumns[i];
+		const std::string_view* cells = myCells.data() + static_cast<size_t>(i) * myRowCount;
+		column.numbers.resize(myRowCount);
+		if (myRowCount > 0 && parseNumbers(cells, myRowCount, column.numbers.data()))
+		{
+			column.type = ColumnType::Number;
+			column.strings.clear();
+		}
+		else
+		{
+			column.type = ColumnType::String;
+			column.numbers.clear();
+			for (int32_t row = 0; row < myRowCount; row++)
+			{
+				stringSize += cells[row].size() + 1;
+			}
+		}
+	}
+
+	// Reserving the most the arena could need keeps the keys in myStringIDs valid as it grows
+	myArena.reserve(stringSize);
+	for (int32_t i = 0; i < myColumnCount; i++)
+	{
+		Column& column = myColumns[i];
+		if (column.type == ColumnType::String)
+		{
+			const std::string_view* cells = myCells.data() + static_cast<size_t>(i) * myRowCount;
+			column.strings.resize(myRowCount);
+			for (int32_t row = 0; row < myRowCount; row++)
+			{
+				column.strings[row] = intern(cells[row]);
+			}
+		}
+	}
+	// Cells point into the table, which may change once we return
+	myCells.clear();
+	return true;
+}
+
+void
+TableSnapshot::clear()
+{
+	myHasTable = false;
+	myHash = 0;
+	myRowCount = 0;
+	myColumnCount = 0;
+	// Columns and the arena keep their storage for the next table
+	myArena.clear();
+	myStringOffsets.assign(1, 0);
+	myStringIDs.clear();
+	myGeneration++;
+}
+
+uint32_t
+TableSnapshot::findString(std::string_view value) const
+{
+	auto found = myStringIDs.find(value);
+	return found == myStringIDs.end() ? InvalidStringID : found->second;
+}
+
+bool
+TableSnapshot::parseNumbers(const std::string_view* cells, int32_t count, double* numbers)
+{
+	for (int32_t i = 0; i < count; i++)
+	{
+		const char* end = cells[i].data() + cells[i].size();
+		auto result = std::from_chars(cells[i].data(), end, numbers[i]);
+		if (cells[i].empty() || result.ec != std::errc() || result.ptr != end)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t
+TableSnapshot::intern(std::string_view value)
+{
+	auto found = myStringIDs.find(value);
+	if (found != myStringIDs.end())
+	{
+		return found->second;
+	}
+	uint32_t id = static_cast<uint32_t>(myStringOffsets.size() - 1);
+	size_t offset = myArena.size();
+	myArena.insert(myArena.end(), value.begin(), value.end());
+	myArena.push_back('\0');
+	myStringOffsets.push_back(myArena.size());
+	myStringIDs.emplace(std::string_view(myArena.data() + offset, value.size()), id);
+	return id;
+}
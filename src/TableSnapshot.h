@@ -0,0 +1,126 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+
+#pragma once
+
+#include <TouchEngine/TouchEngine.h>
+#include <TouchEngine/TouchObject.h>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+* A columnar copy of a string data output's TETable, decoded in one pass so it can be scanned without a
+* TouchEngine call per cell, and without TETableGetStringValue()'s results going stale.
+*
+* Columns whose every cell is a number are parsed to doubles. Other columns hold IDs of interned strings,
+* so equal values share storage and compare as integers. Strings live in one arena, and remain valid
+* until the next update() which decodes a table.
+*
+* update() hashes the cells as it reads them, and does nothing more when they match those last decoded, so an
+* unchanged output costs one read of each cell. The same TETable may be changed in place between frames, so
+* its identity alone can't tell us it is unchanged. Not thread-safe.
+*/
+class TableSnapshot
+{
+public:
+	static constexpr uint32_t InvalidStringID = UINT32_MAX;
+
+	enum class ColumnType
+	{
+		Number,
+		String
+	};
+
+	struct Column
+	{
+		ColumnType				type = ColumnType::String;
+		// A value per row, for Number columns
+		std::vector<double>		numbers;
+		// A string ID per row, for String columns
+		std::vector<uint32_t>	strings;
+	};
+
+	TableSnapshot() = default;
+	TableSnapshot(const TableSnapshot& o) = delete;
+	TableSnapshot& operator=(const TableSnapshot& o) = delete;
+
+	// Returns false if table holds the same cells as the last table decoded, leaving the snapshot as it was
+	bool	update(const TouchObject<TETable>& table);
+	void	clear();
+
+	int32_t
+	getRowCount() const
+	{
+		return myRowCount;
+	}
+
+	int32_t
+	getColumnCount() const
+	{
+		return myColumnCount;
+	}
+
+	const Column&
+	getColumn(int32_t column) const
+	{
+		return myColumns[column];
+	}
+
+	size_t
+	getStringCount() const
+	{
+		return myStringOffsets.empty() ? 0 : myStringOffsets.size() - 1;
+	}
+
+	// Null-terminated
+	std::string_view
+	getString(uint32_t id) const
+	{
+		return std::string_view(myArena.data() + myStringOffsets[id], myStringOffsets[id + 1] - myStringOffsets[id] - 1);
+	}
+
+	// Returns InvalidStringID if no String column holds value
+	uint32_t	findString(std::string_view value) const;
+
+	// Advances each time a table is decoded
+	uint64_t
+	getGeneration() const
+	{
+		return myGeneration;
+	}
+private:
+	static bool	parseNumbers(const std::string_view* cells, int32_t count, double* numbers);
+	uint32_t	intern(std::string_view value);
+
+	bool					myHasTable{ false };
+	// Of the cells of the last table decoded
+	uint64_t				myHash{ 0 };
+	int32_t					myRowCount{ 0 };
+	int32_t					myColumnCount{ 0 };
+	std::vector<Column>		myColumns;
+	uint64_t				myGeneration{ 0 };
+
+	// Cells of the table being decoded, by column
+	std::vector<std::string_view>	myCells;
+
+	std::vector<char>		myArena;
+	// Offset in myArena of each string, followed by the arena's size
+	std::vector<size_t>		myStringOffsets;
+	// Keys point into myArena
+	std::unordered_map<std::string_view, uint32_t>	myStringIDs;
+};
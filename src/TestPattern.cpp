@@ -0,0 +1,413 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "TestPattern.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TEST_PATTERN_SSE
+#endif
+
+namespace
+{
+	struct Color
+	{
+		int	red;
+		int	green;
+		int	blue;
+	};
+
+	struct Gradient
+	{
+		Color	start;
+		Color	end;
+	};
+
+	const std::array<Gradient, TestPattern::VariantCount> Gradients{
+		Gradient{{0, 0, 0}, {255, 0, 255}},
+		Gradient{{100, 100, 100}, {255, 255, 0}},
+		Gradient{{40, 40, 40}, {255, 255, 255}},
+		Gradient{{255, 0, 0}, {255, 0, 255}}
+	};
+
+	const std::array<std::array<Color, 2>, TestPattern::VariantCount> CheckerboardColors{ {
+		{ Color{255, 255, 255}, Color{0, 0, 0} },
+		{ Color{192, 192, 192}, Color{64, 64, 64} },
+		{ Color{255, 0, 0}, Color{0, 255, 255} },
+		{ Color{255, 255, 0}, Color{0, 0, 255} }
+	} };
+
+	// 75% colour bars
+	const std::array<Color, 8> BarColors{
+		Color{191, 191, 191},
+		Color{191, 191, 0},
+		Color{0, 191, 191},
+		Color{0, 191, 0},
+		Color{191, 0, 191},
+		Color{191, 0, 0},
+		Color{0, 0, 191},
+		Color{0, 0, 0}
+	};
+
+	// 3x5 digits, a row of three bits per line, most significant bit leftmost
+	const std::array<std::array<uint8_t, 5>, 10> Digits{ {
+		{ 7, 5, 5, 5, 7 },
+		{ 2, 6, 2, 2, 7 },
+		{ 7, 1, 7, 4, 7 },
+		{ 7, 1, 3, 1, 7 },
+		{ 5, 5, 7, 1, 1 },
+		{ 7, 4, 7, 1, 7 },
+		{ 7, 4, 7, 5, 7 },
+		{ 7, 1, 1, 1, 1 },
+		{ 7, 5, 7, 5, 7 },
+		{ 7, 5, 7, 1, 7 }
+	} };
+
+	// Rows drawn by each worker are about this many bytes
+	constexpr size_t BandSize{ 256 * 1024 };
+
+	constexpr uint32_t Opaque{ 0xFF000000 };
+
+	uint32_t
+	pack(const Color& color)
+	{
+		return Opaque | (static_cast<uint32_t>(color.red) << 16) | (static_cast<uint32_t>(color.green) << 8) | static_cast<uint32_t>(color.blue);
+	}
+
+	uint64_t
+	mix(uint64_t value)
+	{
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	unsigned char*
+	getRow(unsigned char* pixels, size_t bytesPerRow, size_t y)
+	{
+		return pixels + y * bytesPerRow;
+	}
+
+	// Calls draw with ranges of rows covering height, in parallel if workers isn't null
+	void
+	forEachBand(uint32_t height, size_t bytesPerRow, WorkerPool* workers, const std::function<void(uint32_t, uint32_t)>& draw)
+	{
+		uint32_t rows = static_cast<uint32_t>((std::max<size_t>)(1, BandSize / bytesPerRow));
+		uint32_t bands = (height + rows - 1) / rows;
+		if (workers == nullptr || bands < 2)
+		{
+			draw(0, height);
+			return;
+		}
+		workers->parallelFor(bands, [&](size_t band)
+		{
+			uint32_t first = static_cast<uint32_t>(band) * rows;
+			draw(first, (std::min)(height, first + rows));
+		});
+	}
+
+	// Each pixel of the row is the template's pixel with red added
+	void
+	fillRow(uint32_t* row, const uint32_t* source, uint32_t width, uint32_t red)
+	{
+		uint32_t x = 0;
+#ifdef TEST_PATTERN_SSE
+		__m128i value = _mm_set1_epi32(static_cast<int>(red << 16));
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_or_si128(pixels, value));
+		}
+#endif
+		for (; x < width; x++)
+		{
+			row[x] = source[x] | (red << 16);
+		}
+	}
+
+	void
+	drawGradient(const TestPattern::Key& key, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers)
+	{
+		const Gradient& gradient = Gradients[key.variant % Gradients.size()];
+		const Color& start = gradient.start;
+		const Color& end = gradient.end;
+
+		// Green and blue only vary across the image, so are worked out once for every row
+		std::vector<uint32_t> columns(key.width);
+		double columnScale = key.width > 1 ? key.width - 1 : 1;
+		for (uint32_t x = 0; x < key.width; x++)
+		{
+			double xColor = x / columnScale;
+			int green = start.green + static_cast<int>(xColor * (static_cast<double>(end.green) - start.green));
+			int blue = start.blue + static_cast<int>(xColor * (static_cast<double>(end.blue) - start.blue));
+			columns[x] = pack({ 0, green, blue });
+		}
+
+		double rowScale = key.height > 1 ? key.height - 1 : 1;
+		forEachBand(key.height, bytesPerRow, workers, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t y = first; y < last; y++)
+			{
+				double yColor = y / rowScale;
+				if (key.flipped)
+					yColor = 1.0 - yColor;
+				int red = start.red + static_cast<int>(yColor * (static_cast<double>(end.red) - start.red));
+				fillRow(reinterpret_cast<uint32_t*>(getRow(pixels, bytesPerRow, y)), columns.data(), key.width, static_cast<uint32_t>(red));
+			}
+		});
+	}
+
+	void
+	drawCheckerboard(const TestPattern::Key& key, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers)
+	{
+		const auto& colors = CheckerboardColors[key.variant % CheckerboardColors.size()];
+		uint32_t cell = (std::max)(1u, (std::min)(key.width, key.height) / 8);
+
+		// Every row is a copy of one of two rows
+		std::array<std::vector<uint32_t>, 2> rows;
+		for (size_t phase = 0; phase < rows.size(); phase++)
+		{
+			rows[phase].resize(key.width);
+			for (uint32_t x = 0; x < key.width; x++)
+			{
+				rows[phase][x] = pack(colors[((x / cell) + phase) & 1]);
+			}
+		}
+
+		forEachBand(key.height, bytesPerRow, workers, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t y = first; y < last; y++)
+			{
+				uint32_t row = key.flipped ? key.height - 1 - y : y;
+				memcpy(getRow(pixels, bytesPerRow, y), rows[(row / cell) & 1].data(), key.width * TestPattern::BytesPerPixel);
+			}
+		});
+	}
+
+	void
+	drawBars(const TestPattern::Key& key, uint64_t frame, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers)
+	{
+		// Two widths of bars, so a scrolled row is a copy starting part way along
+		std::vector<uint32_t> bars(static_cast<size_t>(key.width) * 2);
+		for (uint32_t x = 0; x < key.width; x++)
+		{
+			bars[x] = bars[x + key.width] = pack(BarColors[(static_cast<uint64_t>(x) * BarColors.size()) / key.width]);
+		}
+		uint64_t period = TestPattern::BarPeriod * BarColors.size();
+		size_t offset = static_cast<size_t>(((frame % period) * key.width) / period);
+
+		forEachBand(key.height, bytesPerRow, workers, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t y = first; y < last; y++)
+			{
+				memcpy(getRow(pixels, bytesPerRow, y), bars.data() + offset, key.width * TestPattern::BytesPerPixel);
+			}
+		});
+	}
+
+	/*
+	* Each row runs four xorshift32 generators, seeded from the frame, variant and row, one for each pixel in
+	* a group of four - so rows can be drawn in any order and the SSE and scalar paths draw the same image.
+	*/
+	void
+	drawNoise(const TestPattern::Key& key, uint64_t frame, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers)
+	{
+		uint64_t seed = mix(mix(frame) ^ key.variant);
+		bool grey = (key.variant & 1) != 0;
+
+		forEachBand(key.height, bytesPerRow, workers, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t y = first; y < last; y++)
+			{
+				uint32_t* row = reinterpret_cast<uint32_t*>(getRow(pixels, bytesPerRow, y));
+				alignas(16) uint32_t state[4];
+				for (uint32_t lane = 0; lane < 4; lane++)
+				{
+					state[lane] = static_cast<uint32_t>(mix(seed + static_cast<uint64_t>(y) * 4 + lane)) | 1;
+				}
+
+				uint32_t x = 0;
+#ifdef TEST_PATTERN_SSE
+				__m128i s = _mm_load_si128(reinterpret_cast<const __m128i*>(state));
+				const __m128i opaque = _mm_set1_epi32(static_cast<int>(Opaque));
+				const __m128i low = _mm_set1_epi32(0xFF);
+				for (; x + 4 <= key.width; x += 4)
+				{
+					s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+					s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+					s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+					__m128i value = s;
+					if (grey)
+					{
+						__m128i v = _mm_and_si128(s, low);
+						value = _mm_or_si128(v, _mm_or_si128(_mm_slli_epi32(v, 8), _mm_slli_epi32(v, 16)));
+					}
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_or_si128(value, opaque));
+				}
+				_mm_store_si128(reinterpret_cast<__m128i*>(state), s);
+#endif
+				for (; x < key.width; x += 4)
+				{
+					for (uint32_t lane = 0; lane < 4 && x + lane < key.width; lane++)
+					{
+						uint32_t& s = state[lane];
+						s ^= s << 13;
+						s ^= s >> 17;
+						s ^= s << 5;
+						uint32_t value = grey ? (s & 0xFF) * 0x010101 : s;
+						row[x + lane] = value | Opaque;
+					}
+				}
+			}
+		});
+	}
+}
+
+bool
+TestPattern::isAnimated(Type type)
+{
+	return type == Type::Bars || type == Type::Noise;
+}
+
+void
+TestPattern::draw(const Key& key, uint64_t frame, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers)
+{
+	if (key.width == 0 || key.height == 0)
+	{
+		return;
+	}
+	switch (key.type)
+	{
+	case Type::Gradient:
+		drawGradient(key, pixels, bytesPerRow, workers);
+		break;
+	case Type::Checkerboard:
+		drawCheckerboard(key, pixels, bytesPerRow, workers);
+		break;
+	case Type::Bars:
+		drawBars(key, frame, pixels, bytesPerRow, workers);
+		break;
+	case Type::Noise:
+		drawNoise(key, frame, pixels, bytesPerRow, workers);
+		break;
+	}
+}
+
+void
+TestPattern::stamp(uint64_t number, unsigned char* pixels, size_t bytesPerRow, uint32_t width, uint32_t height, bool flipped)
+{
+	char text[20];
+	size_t length = 0;
+	do
+	{
+		text[length++] = static_cast<char>(number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	// Digits are 3x5 cells with a cell between them, on a black box with a cell of margin
+	uint32_t scale = (std::max)(1u, height / 64);
+	uint32_t boxWidth = (std::min)(width, static_cast<uint32_t>((length * 4 + 1) * scale));
+	uint32_t boxHeight = (std::min)(height, 7 * scale);
+	for (uint32_t y = 0; y < boxHeight; y++)
+	{
+		uint32_t* row = reinterpret_cast<uint32_t*>(getRow(pixels, bytesPerRow, flipped ? height - 1 - y : y));
+		uint32_t line = y / scale;
+		for (uint32_t x = 0; x < boxWidth; x++)
+		{
+			uint32_t column = x / scale;
+			bool lit = false;
+			if (line >= 1 && line <= 5 && column >= 1 && column % 4 != 0)
+			{
+				size_t digit = (column - 1) / 4;
+				uint32_t bit = 2 - ((column - 1) % 4);
+				lit = ((Digits[text[length - 1 - digit]][line - 1] >> bit) & 1) != 0;
+			}
+			row[x] = lit ? 0xFFFFFFFF : Opaque;
+		}
+	}
+}
+
+size_t
+TestPatternCache::KeyHash::operator()(const TestPattern::Key& key) const
+{
+	uint64_t value = (static_cast<uint64_t>(key.width) << 32) | key.height;
+	value ^= mix((static_cast<uint64_t>(key.variant) << 16) | (static_cast<uint64_t>(key.type) << 8) | (key.flipped ? 1 : 0));
+	return static_cast<size_t>(mix(value));
+}
+
+TestPatternCache::TestPatternCache(WorkerPool* workers, size_t capacity)
+	: myWorkers(workers), myCapacity(capacity)
+{
+}
+
+std::shared_ptr<const TestPatternCache::Image>
+TestPatternCache::get(const TestPattern::Key& key)
+{
+	if (key.width == 0 || key.height == 0 || key.width > TestPattern::MaxSize || key.height > TestPattern::MaxSize)
+	{
+		return nullptr;
+	}
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		auto found = myImages.find(key);
+		if (found != myImages.end())
+		{
+			myOrder.splice(myOrder.begin(), myOrder, found->second);
+			return *found->second;
+		}
+	}
+
+	// Drawn without the lock, so other patterns can be fetched meanwhile
+	auto image = std::make_shared<Image>();
+	image->key = key;
+	image->bytesPerRow = key.width * TestPattern::BytesPerPixel;
+	image->pixels.resize(image->bytesPerRow * key.height);
+	TestPattern::draw(key, 0, image->pixels.data(), image->bytesPerRow, myWorkers);
+
+	std::lock_guard<std::mutex> guard(myMutex);
+	auto found = myImages.find(key);
+	if (found != myImages.end())
+	{
+		// Another thread drew it first
+		myOrder.splice(myOrder.begin(), myOrder, found->second);
+		return *found->second;
+	}
+	myOrder.push_front(image);
+	myImages.emplace(key, myOrder.begin());
+	myByteCount += image->pixels.size();
+
+	// Images still in use elsewhere stay alive until they are released
+	while (myByteCount > myCapacity && myOrder.size() > 1)
+	{
+		const auto& last = myOrder.back();
+		myByteCount -= last->pixels.size();
+		myImages.erase(last->key);
+		myOrder.pop_back();
+	}
+	return image;
+}
+
+void
+TestPatternCache::clear()
+{
+	std::lock_guard<std::mutex> guard(myMutex);
+	myImages.clear();
+	myOrder.clear();
+	myByteCount = 0;
+}
@@ -0,0 +1,138 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "WorkerPool.h"
+
+/*
+* Procedural images for texture inputs, drawn as 8-bit BGRA rows with SSE2 where available.
+*
+* Images larger than a band of rows are drawn in bands on a WorkerPool, so sizes up to MaxSize can be
+* generated quickly enough to load-test texture upload.
+*/
+class TestPattern
+{
+public:
+	enum class Type : uint8_t
+	{
+		// Red increases down the image, green and blue across it - the variant selects the palette
+		Gradient,
+		// Eight squares across the shorter side - the variant selects the colours
+		Checkerboard,
+		// Vertical colour bars scrolling one bar width every BarPeriod frames
+		Bars,
+		// A new pattern each frame - odd variants are greyscale
+		Noise,
+	};
+
+	struct Key
+	{
+		Type		type = Type::Gradient;
+		// Below VariantCount
+		uint32_t	variant = 0;
+		uint32_t	width = 0;
+		uint32_t	height = 0;
+		// Row 0 is the bottom of the image rather than the top, as OpenGL expects
+		bool		flipped = false;
+
+		bool
+		operator==(const Key& other) const
+		{
+			return type == other.type && variant == other.variant && width == other.width && height == other.height && flipped == other.flipped;
+		}
+	};
+
+	static constexpr uint32_t	MaxSize{ 8192 };
+	static constexpr uint32_t	VariantCount{ 4 };
+	static constexpr size_t		BytesPerPixel{ 4 };
+	static constexpr uint64_t	BarPeriod{ 30 };
+
+	// Whether the pattern differs from frame to frame
+	static bool	isAnimated(Type type);
+
+	/*
+	* Draws the pattern for frame into pixels, which has key.height rows of bytesPerRow bytes.
+	* workers, if not null, draws large images in parallel.
+	*/
+	static void	draw(const Key& key, uint64_t frame, unsigned char* pixels, size_t bytesPerRow, WorkerPool* workers = nullptr);
+
+	// Draws number in decimal over the top-left corner, scaled to the image size
+	static void	stamp(uint64_t number, unsigned char* pixels, size_t bytesPerRow, uint32_t width, uint32_t height, bool flipped);
+};
+
+/*
+* Frame 0 of each pattern drawn, by key, shared by every texture input using the same pattern so a layout
+* change only draws patterns it hasn't seen before.
+*
+* Least recently used images are forgotten once the images held exceed the capacity. Any thread may call get().
+*/
+class TestPatternCache
+{
+public:
+	struct Image
+	{
+		TestPattern::Key			key;
+		size_t						bytesPerRow = 0;
+		std::vector<unsigned char>	pixels;
+	};
+
+	static constexpr size_t DefaultCapacity{ 512 * 1024 * 1024 };
+
+	explicit TestPatternCache(WorkerPool* workers = nullptr, size_t capacity = DefaultCapacity);
+	TestPatternCache(const TestPatternCache& o) = delete;
+	TestPatternCache& operator=(const TestPatternCache& o) = delete;
+
+	// Returns null if the key's size is empty or larger than TestPattern::MaxSize
+	std::shared_ptr<const Image>	get(const TestPattern::Key& key);
+	void	clear();
+
+	// The workers patterns are drawn on, which may be null
+	WorkerPool*
+	getWorkers() const
+	{
+		return myWorkers;
+	}
+
+	size_t
+	getByteCount() const
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		return myByteCount;
+	}
+private:
+	struct KeyHash
+	{
+		size_t	operator()(const TestPattern::Key& key) const;
+	};
+
+	using Order = std::list<std::shared_ptr<const Image>>;
+
+	WorkerPool*		myWorkers;
+	size_t			myCapacity;
+	mutable std::mutex	myMutex;
+	// Most recently used first
+	Order			myOrder;
+	std::unordered_map<TestPattern::Key, Order::iterator, KeyHash>	myImages;
+	size_t			myByteCount{ 0 };
+};
@@ -0,0 +1,185 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct Slot
+	{
+		// Atomic so write() can read slots while their thread records - relaxed stores cost the same as plain ones
+		std::atomic<const char*>	name{ nullptr };
+		std::atomic<int64_t>		start{ 0 };
+		std::atomic<int64_t>		end{ 0 };
+	};
+
+	struct ThreadRing
+	{
+		uint32_t					id;
+		std::atomic<const char*>	name{ nullptr };
+		// Total events recorded, the next slot is head % RingCapacity
+		std::atomic<uint64_t>		head{ 0 };
+		std::unique_ptr<Slot[]>		slots{ new Slot[Trace::RingCapacity] };
+	};
+
+	// Rings are never freed, so events from threads which have exited are still written
+	std::mutex										theRingsMutex;
+	std::vector<std::shared_ptr<ThreadRing>>		theRings;
+
+	ThreadRing&
+	getRing()
+	{
+		thread_local std::shared_ptr<ThreadRing> ring;
+		if (!ring)
+		{
+			ring = std::make_shared<ThreadRing>();
+			std::lock_guard<std::mutex> guard(theRingsMutex);
+			ring->id = static_cast<uint32_t>(theRings.size()) + 1;
+			theRings.push_back(ring);
+		}
+		return *ring;
+	}
+
+	void
+	writeString(std::ostream& stream, const char* string)
+	{
+		stream << '"';
+		for (const char* c = string; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				stream << '\\';
+			}
+			if (static_cast<unsigned char>(*c) >= 0x20)
+			{
+				stream << *c;
+			}
+		}
+		stream << '"';
+	}
+}
+
+int64_t
+Trace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void
+Trace::record(const char* name, int64_t start, int64_t end)
+{
+	ThreadRing& ring = getRing();
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	Slot& slot = ring.slots[head % RingCapacity];
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void
+Trace::setThreadName(const char* name)
+{
+	getRing().name.store(name, std::memory_order_relaxed);
+}
+
+bool
+Trace::isEnabled()
+{
+#ifdef TOUCHENGINE_TRACE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void
+Trace::write(std::ostream& stream)
+{
+	std::vector<std::shared_ptr<ThreadRing>> rings;
+	{
+		std::lock_guard<std::mutex> guard(theRingsMutex);
+		rings = theRings;
+	}
+
+	struct Event
+	{
+		const char*	name;
+		int64_t		start;
+		int64_t		end;
+	};
+
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	int64_t epoch = INT64_MAX;
+	std::vector<std::vector<Event>> threads(rings.size());
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		ThreadRing& ring = *rings[i];
+		uint64_t head = ring.head.load(std::memory_order_acquire);
+		uint64_t tail = head > RingCapacity ? head - RingCapacity : 0;
+		auto& events = threads[i];
+		events.reserve(static_cast<size_t>(head - tail));
+		for (uint64_t j = tail; j < head; j++)
+		{
+			const Slot& slot = ring.slots[j % RingCapacity];
+			events.push_back({ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed) });
+		}
+		// Discard slots the thread may have overwritten while we copied them, including the one it may be writing now
+		uint64_t after = ring.head.load(std::memory_order_acquire);
+		uint64_t oldest = after + 1 > RingCapacity ? after + 1 - RingCapacity : 0;
+		if (oldest > tail)
+		{
+			events.erase(events.begin(), events.begin() + static_cast<size_t>(std::min<uint64_t>(oldest - tail, events.size())));
+		}
+		for (const auto& event : events)
+		{
+			epoch = std::min(epoch, event.start);
+		}
+	}
+
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		const ThreadRing& ring = *rings[i];
+		const char* name = ring.name.load(std::memory_order_relaxed);
+		if (name)
+		{
+			stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.id << ",\"args\":{\"name\":";
+			writeString(stream, name);
+			stream << "}}";
+			first = false;
+		}
+		for (const auto& event : threads[i])
+		{
+			if (!event.name)
+			{
+				continue;
+			}
+			// Times are in microseconds
+			stream << (first ? "" : ",") << "\n{\"name\":";
+			writeString(stream, event.name);
+			stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.id
+				<< ",\"ts\":" << (event.start - epoch) / 1000 << '.' << static_cast<char>('0' + ((event.start - epoch) / 100) % 10)
+				<< ",\"dur\":" << (event.end - event.start) / 1000 << '.' << static_cast<char>('0' + ((event.end - event.start) / 100) % 10) << '}';
+			first = false;
+		}
+	}
+	stream << "\n]}\n";
+}
@@ -0,0 +1,94 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <utility>
+
+/*
+* Low-overhead tracing of scopes on the hot path, written out as Chrome trace_event JSON
+* (open it in chrome://tracing or https://ui.perfetto.dev).
+*
+* Each thread records into its own fixed-size ring, so recording takes no locks and the oldest events
+* are overwritten. Tracing is compiled out unless TOUCHENGINE_TRACE is defined, when TRACE_SCOPE() and
+* TRACE_TE() cost nothing.
+*
+*	void Renderer::render()
+*	{
+*		TRACE_SCOPE("Renderer::render");
+*		...
+*		result = TRACE_TE(TEInstanceLinkGetTextureValue, instance, identifier, TELinkValueCurrent, texture.take());
+*	}
+*/
+namespace Trace
+{
+	// Events each thread keeps
+	constexpr size_t RingCapacity{ 1 << 16 };
+
+	// Nanoseconds from an arbitrary epoch
+	int64_t	now();
+
+	// name must remain valid for the life of the process, typically a string literal
+	void	record(const char* name, int64_t start, int64_t end);
+
+	// Names the calling thread in the trace, name must remain valid for the life of the process
+	void	setThreadName(const char* name);
+
+	// Writes events from every thread, may be called while other threads are recording
+	void	write(std::ostream& stream);
+
+	// Returns true if tracing is compiled in
+	bool	isEnabled();
+
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name)
+			: myName(name), myStart(now())
+		{
+		}
+		Scope(const Scope& o) = delete;
+		Scope& operator=(const Scope& o) = delete;
+		~Scope()
+		{
+			record(myName, myStart, now());
+		}
+	private:
+		const char*	myName;
+		int64_t		myStart;
+	};
+
+	template <typename F, typename... Args>
+	auto
+	call(const char* name, F function, Args&&... args)
+	{
+		Scope scope(name);
+		return function(std::forward<Args>(args)...);
+	}
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef TOUCHENGINE_TRACE
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+// Calls a TouchEngine function, tracing it under its own name
+#define TRACE_TE(function, ...) Trace::call(#function, function, __VA_ARGS__)
+#else
+#define TRACE_SCOPE(name) do {} while (false)
+#define TRACE_TE(function, ...) function(__VA_ARGS__)
+#endif
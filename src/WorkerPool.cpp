@@ -0,0 +1,124 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "WorkerPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+WorkerPool::WorkerPool(size_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+	myThreads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		myThreads.emplace_back(&WorkerPool::run, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		myStopping = true;
+	}
+	myCondition.notify_all();
+	for (auto& thread : myThreads)
+	{
+		thread.join();
+	}
+}
+
+void
+WorkerPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> guard(myMutex);
+		myTasks.push_back(std::move(task));
+	}
+	myCondition.notify_one();
+}
+
+void
+WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	struct State
+	{
+		std::atomic<size_t>		next{ 0 };
+		size_t					finished{ 0 };
+		std::mutex				mutex;
+		std::condition_variable	condition;
+	};
+	auto state = std::make_shared<State>();
+	size_t total = count;
+
+	// Helpers which start after every index is taken return without touching task, which may be gone by then
+	auto work = [state, total, &task]
+	{
+		size_t done = 0;
+		for (size_t i = state->next.fetch_add(1); i < total; i = state->next.fetch_add(1))
+		{
+			task(i);
+			done++;
+		}
+		if (done > 0)
+		{
+			std::lock_guard<std::mutex> guard(state->mutex);
+			state->finished += done;
+			if (state->finished == total)
+			{
+				state->condition.notify_all();
+			}
+		}
+	};
+
+	size_t helpers = std::min(count, myThreads.size() + 1) - (count > 0 ? 1 : 0);
+	for (size_t i = 0; i < helpers; i++)
+	{
+		submit(work);
+	}
+	work();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&state, total] { return state->finished == total; });
+}
+
+void
+WorkerPool::run()
+{
+	Trace::setThreadName("Worker");
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(myMutex);
+			myCondition.wait(lock, [this] { return myStopping || !myTasks.empty(); });
+			if (myTasks.empty())
+			{
+				return;
+			}
+			task = std::move(myTasks.front());
+			myTasks.pop_front();
+		}
+		task();
+	}
+}
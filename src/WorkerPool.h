@@ -0,0 +1,59 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* A fixed set of threads running submitted tasks in the order they were submitted.
+* Tasks already submitted are run before the pool is destroyed.
+*/
+class WorkerPool
+{
+public:
+	// A threadCount of 0 uses one thread per hardware thread
+	explicit WorkerPool(size_t threadCount = 0);
+	WorkerPool(const WorkerPool& o) = delete;
+	WorkerPool& operator=(const WorkerPool& o) = delete;
+	~WorkerPool();
+
+	void	submit(std::function<void()> task);
+
+	/*
+	* Calls task with each index below count, on the pool's threads and the calling thread, and returns
+	* once every call has returned. The caller takes indices too, so this may be called from a task.
+	*/
+	void	parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	size_t
+	getThreadCount() const
+	{
+		return myThreads.size();
+	}
+private:
+	void	run();
+
+	std::mutex							myMutex;
+	std::condition_variable				myCondition;
+	std::deque<std::function<void()>>	myTasks;
+	bool								myStopping{ false };
+	std::vector<std::thread>			myThreads;
+};
@@ -0,0 +1,88 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "CSVLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	const size_t RowCount = 5000;
+
+	std::string
+	makeRow(size_t row)
+	{
+		return std::to_string(row) + ",\"multi\nline " + std::to_string(row) + "\"\r\n";
+	}
+
+	void
+	checkRows(CSVLoader& loader, size_t first, size_t count)
+	{
+		CSVTable table;
+		CHECK(loader.loadRows(first, count, table));
+		CHECK(table.getRowCount() == count);
+		for (size_t row = 0; row < table.getRowCount(); row++)
+		{
+			CHECK(std::to_string(first + row) == table.getCell(row, 0));
+		}
+	}
+
+	void
+	testLoader(const std::wstring& path, WorkerPool* workers)
+	{
+		CSVLoader loader(path, workers);
+		CSVTable table;
+		CHECK(loader.load(table));
+		CHECK(table.getRowCount() == RowCount);
+		CHECK(std::strcmp(table.getCell(RowCount - 1, 1), "multi\nline 4999") == 0);
+
+		CHECK(loader.index());
+		CHECK(loader.getRowCount() == RowCount);
+		// Within one indexed block, across blocks, and at the end
+		checkRows(loader, 10, 20);
+		checkRows(loader, 1000, 2100);
+		checkRows(loader, RowCount - 3, 3);
+		CHECK(!loader.loadRows(RowCount, 1, table));
+	}
+}
+
+int
+main()
+{
+	const char* path = "CSVLoaderTest.csv";
+	{
+		std::ofstream file(path, std::ios::binary);
+		for (size_t row = 0; row < RowCount; row++)
+		{
+			file << makeRow(row);
+		}
+	}
+
+	testLoader(L"CSVLoaderTest.csv", nullptr);
+	// Indexes through a FileStream, small as the file is
+	WorkerPool workers(2);
+	testLoader(L"CSVLoaderTest.csv", &workers);
+
+	CSVTable table;
+	CSVLoader missing(L"CSVLoaderTest.missing.csv");
+	CHECK(!missing.load(table));
+	CHECK(!missing.index());
+
+	std::remove(path);
+	return CHECK_RESULT();
+}
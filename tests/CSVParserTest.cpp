@@ -0,0 +1,131 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "CSVParser.h"
+#include <cstring>
+#include <string>
+
+namespace
+{
+	bool
+	cellIs(const CSVTable& table, size_t row, int32_t column, const char* value)
+	{
+		return std::strcmp(table.getCell(row, column), value) == 0;
+	}
+
+	CSVTable
+	parse(const std::string& text, char delimiter = ',', bool quoted = true, WorkerPool* workers = nullptr)
+	{
+		CSVTable table;
+		CSVParser(delimiter, quoted, workers).parse(text.data(), text.size(), table);
+		return table;
+	}
+
+	void
+	testQuotedNewlines()
+	{
+		CSVTable table = parse("a,\"two\nlines\",c\n\"\r\n\",x\n");
+		CHECK(table.getRowCount() == 2);
+		CHECK(table.getColumnCount() == 3);
+		CHECK(cellIs(table, 0, 1, "two\nlines"));
+		CHECK(cellIs(table, 0, 2, "c"));
+		CHECK(cellIs(table, 1, 0, "\r\n"));
+		CHECK(cellIs(table, 1, 1, "x"));
+		// Missing from the short row
+		CHECK(cellIs(table, 1, 2, ""));
+	}
+
+	void
+	testEscapedQuotes()
+	{
+		CSVTable table = parse("\"say \"\"hi\"\"\",\"\"\"\",\"a,b\"\n");
+		CHECK(table.getRowCount() == 1);
+		CHECK(cellIs(table, 0, 0, "say \"hi\""));
+		CHECK(cellIs(table, 0, 1, "\""));
+		CHECK(cellIs(table, 0, 2, "a,b"));
+	}
+
+	void
+	testCRLF()
+	{
+		CSVTable table = parse("a,b\r\nc,\"d\"\r\n,\r\n");
+		CHECK(table.getRowCount() == 3);
+		CHECK(cellIs(table, 0, 1, "b"));
+		CHECK(cellIs(table, 1, 0, "c"));
+		CHECK(cellIs(table, 1, 1, "d"));
+		CHECK(cellIs(table, 2, 0, ""));
+		CHECK(cellIs(table, 2, 1, ""));
+
+		table = parse("a\tb\r\nc\td\r\n", '\t', false);
+		CHECK(table.getRowCount() == 2);
+		CHECK(cellIs(table, 0, 1, "b"));
+		CHECK(cellIs(table, 1, 1, "d"));
+	}
+
+	void
+	testTrailingRow()
+	{
+		CSVTable table = parse("a,b\nc,d");
+		CHECK(table.getRowCount() == 2);
+		CHECK(cellIs(table, 1, 0, "c"));
+		CHECK(cellIs(table, 1, 1, "d"));
+
+		table = parse("a,\"b\nc\"");
+		CHECK(table.getRowCount() == 1);
+		CHECK(cellIs(table, 0, 1, "b\nc"));
+
+		CHECK(parse("").getRowCount() == 0);
+	}
+
+	void
+	testChunks()
+	{
+		// Enough rows to be split between workers, with quoted newlines to cross the chunk boundaries
+		std::string text;
+		const size_t rows = 200000;
+		for (size_t row = 0; row < rows; row++)
+		{
+			text += std::to_string(row) + ",\"line\nbreak, \"\"quoted\"\"\",last\r\n";
+		}
+		WorkerPool workers(4);
+		CSVTable table = parse(text, ',', true, &workers);
+		CHECK(table.getRowCount() == rows);
+		CHECK(table.getColumnCount() == 3);
+		bool same = true;
+		for (size_t row = 0; row < rows; row++)
+		{
+			same = same && cellIs(table, row, 0, std::to_string(row).c_str()) &&
+				cellIs(table, row, 1, "line\nbreak, \"quoted\"") && cellIs(table, row, 2, "last");
+		}
+		CHECK(same);
+
+		CSVParser parser;
+		CHECK(parser.skipRows(text.data(), text.size(), rows) == text.size());
+		size_t offset = parser.skipRows(text.data(), text.size(), 1000);
+		CHECK(text.compare(offset, 5, "1000,") == 0);
+	}
+}
+
+int
+main()
+{
+	testQuotedNewlines();
+	testEscapedQuotes();
+	testCRLF();
+	testTrailingRow();
+	testChunks();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,100 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "ComponentCache.h"
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	std::filesystem::path
+	getEntryPath(const std::filesystem::path& directory)
+	{
+		for (const auto& file : std::filesystem::directory_iterator(directory))
+		{
+			return file.path();
+		}
+		return std::filesystem::path();
+	}
+
+	std::vector<char>
+	readFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void
+	writeFile(const std::filesystem::path& path, const std::vector<char>& data)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+}
+
+int
+main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ComponentCacheTest";
+	std::filesystem::remove_all(directory);
+	ComponentCache cache(directory.wstring());
+
+	ComponentCache::Entry entry;
+	entry.links.push_back({ "op/value", "op", TELinkTypeDouble, TEScopeInput, 2, TELinkIntentPulse });
+	entry.links.back().defaults = { 0.5, 1.0 };
+	entry.deviceName = L"device";
+	entry.engineVersion = "engine@1";
+	entry.hasCapabilities = true;
+	entry.capabilities.textureTypes = { TETextureTypeD3DShared };
+	entry.capabilities.textureFormats = { TETextureFormatBGRA8Unorm, TETextureFormatRGBA16F };
+	entry.capabilities.openGLTextures = true;
+
+	const uint64_t key = ComponentCache::hash("component", 9);
+	CHECK(cache.store(key, entry));
+
+	ComponentCache::Entry found;
+	CHECK(cache.find(key, found));
+	CHECK(found.links.size() == 1);
+	CHECK(found.links[0].isSameLink(entry.links[0]));
+	CHECK(found.links[0].defaults == entry.links[0].defaults);
+	CHECK(found.deviceName == entry.deviceName);
+	CHECK(found.engineVersion == entry.engineVersion);
+	CHECK(found.capabilities.textureFormats == entry.capabilities.textureFormats);
+	CHECK(found.capabilities.openGLTextures);
+	CHECK(!cache.find(key + 1, found));
+
+	// The entry ends with openGLTextures, which must be a valid bool
+	std::filesystem::path path = getEntryPath(directory);
+	std::vector<char> data = readFile(path);
+	CHECK(!data.empty() && data.back() == 1);
+	data.back() = 2;
+	writeFile(path, data);
+	CHECK(!cache.find(key, found));
+
+	// A link type beyond TELinkTypeSeparator
+	data.back() = 1;
+	entry.links[0].type = static_cast<TELinkType>(TELinkTypeSeparator + 1);
+	CHECK(cache.store(key, entry));
+	CHECK(!cache.find(key, found));
+
+	// A truncated entry
+	data.pop_back();
+	writeFile(path, data);
+	CHECK(!cache.find(key, found));
+
+	std::filesystem::remove_all(directory);
+	return CHECK_RESULT();
+}
@@ -0,0 +1,94 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Check.h"
+#include "FileStream.h"
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	const size_t ChunkSize = 4096;
+
+	unsigned char
+	getByte(uint64_t offset)
+	{
+		// Varies within and between chunks, so a chunk out of place is caught
+		return static_cast<unsigned char>(offset * 31 + (offset >> 12));
+	}
+
+	void
+	testSize(WorkerPool& workers, size_t size, size_t readAhead)
+	{
+		const char* path = "FileStreamTest.bin";
+		{
+			std::ofstream file(path, std::ios::binary);
+			for (size_t i = 0; i < size; i++)
+			{
+				file.put(static_cast<char>(getByte(i)));
+			}
+		}
+		{
+			FileReader file(L"FileStreamTest.bin");
+			CHECK(file.isOpen());
+			FileStream stream(file, workers, ChunkSize, readAhead);
+			FileStream::Chunk chunk;
+			uint64_t offset = 0;
+			bool ordered = true;
+			while (stream.next(chunk))
+			{
+				CHECK(chunk.size > 0 && chunk.size <= ChunkSize);
+				CHECK(chunk.offset == offset);
+				for (size_t i = 0; i < chunk.size; i++)
+				{
+					ordered = ordered && chunk.data[i] == getByte(offset + i);
+				}
+				offset += chunk.size;
+			}
+			CHECK(ordered);
+			CHECK(offset == size);
+			CHECK(!stream.hasFailed());
+			// And stays at the end
+			CHECK(!stream.next(chunk));
+		}
+		std::remove(path);
+	}
+
+	void
+	testMissingFile(WorkerPool& workers)
+	{
+		FileReader file(L"FileStreamTest.missing");
+		CHECK(!file.isOpen());
+		FileStream stream(file, workers, ChunkSize);
+		FileStream::Chunk chunk;
+		CHECK(!stream.next(chunk));
+	}
+}
+
+int
+main()
+{
+	WorkerPool workers(2);
+	for (size_t readAhead : { size_t(1), FileStream::DefaultReadAhead })
+	{
+		for (size_t size : { size_t(0), size_t(1), ChunkSize - 1, ChunkSize, ChunkSize + 1 })
+		{
+			testSize(workers, size, readAhead);
+		}
+		// More chunks than buffers, so each is reused
+		testSize(workers, ChunkSize * 9 + 7, readAhead);
+	}
+	testMissingFile(workers);
+	return CHECK_RESULT();
+}
@@ -0,0 +1,195 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "FramePacer.h"
+
+namespace
+{
+	constexpr int64_t Millisecond = 1000000;
+
+	/*
+	* Time only moves when the pacer sleeps or spins, so every wait is deterministic
+	*/
+	class FakeFrameClock : public FrameClock
+	{
+	public:
+		virtual int64_t
+		now() const override
+		{
+			return myNow;
+		}
+		virtual void
+		sleepFor(int64_t nanoseconds) override
+		{
+			sleeps++;
+			slept += nanoseconds;
+			myNow += nanoseconds + oversleep;
+		}
+		virtual void
+		relax() override
+		{
+			spins++;
+			myNow += SpinStep;
+		}
+		void
+		advance(int64_t nanoseconds)
+		{
+			myNow += nanoseconds;
+		}
+
+		static constexpr int64_t SpinStep{ 1000 };
+
+		// Added to every sleep, as a system timer would
+		int64_t		oversleep{ 0 };
+		uint32_t	sleeps{ 0 };
+		int64_t		slept{ 0 };
+		uint32_t	spins{ 0 };
+	private:
+		int64_t		myNow{ 1000 * Millisecond };
+	};
+
+	int64_t
+	deadline60(uint64_t index)
+	{
+		return static_cast<int64_t>((static_cast<double>(index) * 1000000000.0) / 60.0);
+	}
+
+	void
+	testDeadline()
+	{
+		FakeFrameClock clock;
+		FramePacer pacer(clock, 60, 1);
+		const int64_t start = clock.now();
+
+		FramePacer::Frame frame = pacer.beginFrame(6000);
+		CHECK(frame.index == 0);
+		CHECK(frame.timeValue == 0);
+		CHECK(frame.lateness == 0);
+
+		// Sleeps until the spin threshold, then spins to the deadline
+		CHECK(pacer.waitForDeadline(100 * Millisecond));
+		CHECK(clock.sleeps == 1);
+		CHECK(clock.slept == deadline60(1) - pacer.getSpinThreshold());
+		CHECK(clock.spins == pacer.getSpinThreshold() / FakeFrameClock::SpinStep);
+		CHECK(clock.now() >= start + deadline60(1));
+		CHECK(clock.now() < start + deadline60(1) + FakeFrameClock::SpinStep);
+		CHECK(pacer.getTimeUntilDeadline() <= 0);
+
+		frame = pacer.beginFrame(6000);
+		CHECK(frame.index == 1);
+		CHECK(frame.timeValue == 100);
+		CHECK(frame.lateness < FakeFrameClock::SpinStep);
+		CHECK(pacer.getStatistics().skipped == 0);
+		CHECK(pacer.getStatistics().late == 0);
+	}
+
+	void
+	testLimit()
+	{
+		FakeFrameClock clock;
+		FramePacer pacer(clock, 60, 1);
+		const int64_t start = clock.now();
+		pacer.beginFrame(6000);
+
+		// Gives up at the limit, well before the deadline
+		CHECK(!pacer.waitForDeadline(Millisecond));
+		CHECK(clock.now() == start + Millisecond);
+		CHECK(clock.spins == 0);
+
+		// Within the spin threshold the limit still applies
+		clock.advance(deadline60(1) - 2 * Millisecond);
+		CHECK(!pacer.waitForDeadline(Millisecond / 2));
+		CHECK(clock.sleeps == 1);
+		CHECK(clock.now() - (start + deadline60(1) - Millisecond) >= Millisecond / 2);
+		CHECK(pacer.waitForDeadline(100 * Millisecond));
+	}
+
+	void
+	testNoSpinAfterOversleep()
+	{
+		FakeFrameClock clock;
+		clock.oversleep = 3 * Millisecond;
+		FramePacer pacer(clock, 60, 1);
+		pacer.beginFrame(6000);
+
+		CHECK(pacer.waitForDeadline(100 * Millisecond));
+		CHECK(clock.spins == 0);
+
+		// One millisecond past the deadline is not more than the default late threshold
+		FramePacer::Frame frame = pacer.beginFrame(6000);
+		CHECK(frame.index == 1);
+		CHECK(frame.lateness == Millisecond);
+		CHECK(pacer.getStatistics().late == 0);
+	}
+
+	void
+	testMissedFrames()
+	{
+		FakeFrameClock clock;
+		FramePacer pacer(clock, 60, 1);
+		const int64_t start = clock.now();
+		pacer.beginFrame(6000);
+
+		// A stall of three and a half frames: deadlines 1 and 2 are skipped, and frame 3 begins late
+		clock.advance(deadline60(3) + 8 * Millisecond);
+		FramePacer::Frame frame = pacer.beginFrame(6000);
+		CHECK(frame.index == 3);
+		CHECK(frame.timeValue == 300);
+		CHECK(frame.lateness == 8 * Millisecond);
+		CHECK(pacer.getStatistics().frames == 2);
+		CHECK(pacer.getStatistics().skipped == 2);
+		CHECK(pacer.getStatistics().late == 1);
+		CHECK(pacer.getStatistics().latenessMax == 8 * Millisecond);
+
+		// The next deadline keeps to the original schedule rather than restarting from the stall
+		CHECK(pacer.getTimeUntilDeadline() == start + deadline60(4) - clock.now());
+		CHECK(pacer.waitForDeadline(100 * Millisecond));
+		CHECK(pacer.beginFrame(6000).index == 4);
+
+		pacer.resetStatistics();
+		CHECK(pacer.getStatistics().skipped == 0);
+	}
+
+	void
+	testNoDrift()
+	{
+		FakeFrameClock clock;
+		FramePacer pacer(clock, 60000, 1001);
+		const int64_t start = clock.now();
+		for (uint64_t i = 0; i < 6000; i++)
+		{
+			CHECK(pacer.waitForDeadline(100 * Millisecond));
+			FramePacer::Frame frame = pacer.beginFrame(60000);
+			CHECK(frame.index == i);
+			CHECK(frame.timeValue == static_cast<int64_t>(i * 1001));
+			CHECK(frame.lateness < FakeFrameClock::SpinStep);
+		}
+		const int64_t expected = static_cast<int64_t>((5999.0 * 1001.0 * 1000000000.0) / 60000.0);
+		CHECK(clock.now() - start - expected < FakeFrameClock::SpinStep);
+		CHECK(pacer.getStatistics().skipped == 0);
+	}
+}
+
+int
+main()
+{
+	testDeadline();
+	testLimit();
+	testNoSpinAfterOversleep();
+	testMissedFrames();
+	testNoDrift();
+	return CHECK_RESULT();
+}
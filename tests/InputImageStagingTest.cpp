@@ -0,0 +1,134 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "NullRenderer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	constexpr int Width = 64;
+	constexpr int Height = 48;
+
+	// Every pixel of image n holds n, so a torn image holds more than one value
+	void
+	fill(std::vector<uint32_t>& pixels, uint32_t n)
+	{
+		std::fill(pixels.begin(), pixels.end(), n);
+	}
+
+	// Returns false if the pixels differ
+	bool
+	read(const NullRenderer::Image& image, uint32_t& n)
+	{
+		std::vector<uint32_t> pixels(static_cast<size_t>(Width) * Height);
+		for (int row = 0; row < Height; row++)
+		{
+			std::memcpy(&pixels[static_cast<size_t>(row) * Width], image.pixels.data() + row * image.bytesPerRow, Width * sizeof(uint32_t));
+		}
+		n = pixels[0];
+		return std::all_of(pixels.begin(), pixels.end(), [n](uint32_t pixel) { return pixel == n; });
+	}
+
+	void
+	testProducerThread()
+	{
+		NullRenderer renderer;
+		renderer.setup(nullptr);
+		std::vector<uint32_t> pixels(static_cast<size_t>(Width) * Height);
+		fill(pixels, 0);
+		renderer.beginImageLayout();
+		renderer.addInputImage(reinterpret_cast<const unsigned char*>(pixels.data()), Width * sizeof(uint32_t), Width, Height);
+		renderer.endImageLayout();
+
+		const uint32_t Count = 20000;
+		std::atomic<bool> done{ false };
+		std::thread producer([&renderer, &done, Count]
+			{
+				std::vector<uint32_t> image(static_cast<size_t>(Width) * Height);
+				for (uint32_t n = 1; n <= Count; n++)
+				{
+					fill(image, n);
+					renderer.submitInputImage(0, reinterpret_cast<const unsigned char*>(image.data()), Width * sizeof(uint32_t), Width, Height);
+				}
+				done = true;
+			});
+
+		// The renderer's thread uploads whatever is newest, which must be whole and never older than the last
+		uint32_t last = 0;
+		bool whole = true;
+		bool ordered = true;
+		uint64_t updates = 0;
+		while (!done)
+		{
+			if (renderer.updateInputImages())
+			{
+				updates++;
+				uint32_t n = 0;
+				whole = whole && read(renderer.getInputImageData(0), n);
+				ordered = ordered && n > last;
+				last = n;
+			}
+		}
+		producer.join();
+		CHECK(whole);
+		CHECK(ordered);
+
+		// The newest image wins
+		if (last != Count)
+		{
+			CHECK(renderer.updateInputImages());
+			updates++;
+		}
+		uint32_t n = 0;
+		CHECK(read(renderer.getInputImageData(0), n));
+		CHECK(n == Count);
+		CHECK(!renderer.updateInputImages());
+
+		InputImageStaging::Counters counters = renderer.getInputImageCounters();
+		CHECK(counters.submitted == Count);
+		CHECK(counters.uploaded == updates);
+		CHECK(counters.uploaded + counters.overwritten == Count);
+		CHECK(counters.dropped == 0);
+	}
+
+	void
+	testDropped()
+	{
+		NullRenderer renderer;
+		renderer.setup(nullptr);
+		std::vector<uint32_t> pixels(static_cast<size_t>(Width) * Height);
+		renderer.beginImageLayout();
+		renderer.addInputImage(reinterpret_cast<const unsigned char*>(pixels.data()), Width * sizeof(uint32_t), Width, Height);
+		renderer.endImageLayout();
+
+		// No such input, and the wrong size
+		CHECK(!renderer.submitInputImage(1, reinterpret_cast<const unsigned char*>(pixels.data()), Width * sizeof(uint32_t), Width, Height));
+		CHECK(!renderer.submitInputImage(0, reinterpret_cast<const unsigned char*>(pixels.data()), Width * sizeof(uint32_t), Width / 2, Height));
+		CHECK(renderer.getInputImageCounters().dropped == 2);
+		CHECK(!renderer.updateInputImages());
+	}
+}
+
+int
+main()
+{
+	testProducerThread();
+	testDropped();
+	return CHECK_RESULT();
+}
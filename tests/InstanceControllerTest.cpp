@@ -0,0 +1,104 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "InstanceController.h"
+#include "NullRenderer.h"
+#include "RunLoop.h"
+#include "TEStandIn.h"
+#include <chrono>
+
+namespace
+{
+	// Runs until frames more frames have started, or a second has passed
+	void
+	run(InstanceController& controller, ConditionRunLoop& runLoop, uint64_t frames)
+	{
+		uint64_t target = controller.getPacerStatistics().frames + frames;
+		auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		while (controller.getPacerStatistics().frames < target && std::chrono::steady_clock::now() < end)
+		{
+			int64_t wait = controller.getWaitTime();
+			if (wait > 0 && runLoop.wait(wait) == RunLoop::Wake::Signal)
+			{
+				controller.update();
+			}
+			else
+			{
+				controller.pace();
+			}
+		}
+	}
+
+	void
+	testInputPattern(TestPattern::Type type)
+	{
+		NullRenderer renderer;
+		renderer.setup(nullptr);
+		ConditionRunLoop runLoop;
+		InstanceController controller(renderer, &runLoop, false);
+		controller.setFrameRate(1000, 1);
+		controller.setInputPattern(type, 64, 32);
+		CHECK(controller.load("test.tox") == TEResultSuccess);
+
+		run(controller, runLoop, 2);
+		CHECK(controller.isLoaded());
+		// Two of the twelve inputs are textures
+		CHECK(renderer.getInputImageCount() == 2);
+		if (renderer.getInputImageCount() != 2)
+		{
+			return;
+		}
+		std::vector<unsigned char> first = renderer.getInputImageData(0).pixels;
+		InputImageStaging::Counters before = renderer.getInputImageCounters();
+
+		run(controller, runLoop, 10);
+		InputImageStaging::Counters after = renderer.getInputImageCounters();
+		const NullRenderer::Image& image = renderer.getInputImageData(0);
+		CHECK(image.width == 64 && image.height == 32);
+		if (TestPattern::isAnimated(type))
+		{
+			// Every frame submits a new drawing for each input
+			CHECK(after.submitted - before.submitted >= 20);
+			CHECK(after.uploaded > before.uploaded);
+			CHECK(image.pixels != first);
+			if (type == TestPattern::Type::Noise)
+			{
+				// Noise is the one animated pattern whose variants differ
+				CHECK(image.pixels != renderer.getInputImageData(1).pixels);
+			}
+		}
+		else
+		{
+			// Drawn once, from the cache
+			CHECK(after.submitted == 0);
+			CHECK(image.pixels == first);
+		}
+	}
+}
+
+int
+main()
+{
+	TEStandInConfiguration configuration = TEStandInGetConfiguration();
+	configuration.links = TEStandInMakeLayout(1, 12, 0);
+	configuration.maxFramesInFlight = 2;
+	TEStandInSetConfiguration(configuration);
+
+	testInputPattern(TestPattern::Type::Gradient);
+	testInputPattern(TestPattern::Type::Bars);
+	testInputPattern(TestPattern::Type::Noise);
+	return CHECK_RESULT();
+}
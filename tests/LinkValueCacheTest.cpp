@@ -0,0 +1,98 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "LinkValueCache.h"
+#include <algorithm>
+
+namespace
+{
+	// The dirty list holds exactly the dirty links
+	bool
+	isConsistent(const LinkValueCache& cache)
+	{
+		std::vector<size_t> dirty = cache.getDirty();
+		std::sort(dirty.begin(), dirty.end());
+		std::vector<size_t> expected;
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			if (cache.isDirty(i))
+			{
+				expected.push_back(i);
+			}
+		}
+		return dirty == expected;
+	}
+
+	void
+	testDirtyList()
+	{
+		LinkValueCache cache;
+		cache.reset(100);
+		CHECK(cache.getDirty().size() == 100);
+
+		// Clean from the middle, the end and the start
+		cache.markClean(50);
+		cache.markClean(99);
+		cache.markClean(0);
+		cache.markClean(50);
+		CHECK(cache.getDirty().size() == 97);
+		CHECK(isConsistent(cache));
+
+		// Drain as update() does, while the list changes under it
+		while (!cache.getDirty().empty())
+		{
+			cache.markClean(cache.getDirty()[cache.getDirty().size() / 2]);
+		}
+		CHECK(isConsistent(cache));
+
+		cache.markDirty(7);
+		cache.markDirty(7);
+		CHECK(cache.getDirty().size() == 1);
+		cache.markAllDirty();
+		CHECK(cache.getDirty().size() == 100);
+		for (size_t i = 0; i < 100; i += 3)
+		{
+			cache.markClean(i);
+		}
+		CHECK(isConsistent(cache));
+	}
+
+	void
+	testValues()
+	{
+		LinkValueCache cache(0.01);
+		cache.reset(1);
+		double value = 1.0;
+		CHECK(cache.updateDoubles(0, &value, 1));
+		cache.markClean(0);
+		value = 1.005;
+		CHECK(!cache.updateDoubles(0, &value, 1));
+		value = 1.1;
+		CHECK(cache.updateDoubles(0, &value, 1));
+		// Stays dirty until sent
+		CHECK(cache.updateDoubles(0, &value, 1));
+		cache.markClean(0);
+		CHECK(!cache.updateDoubles(0, &value, 1));
+	}
+}
+
+int
+main()
+{
+	testDirtyList();
+	testValues();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,491 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Check.h"
+#include "PixelFormat.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/*
+* ConvertPixels() runs SIMD kernels over the body of each row and a scalar loop over the rest, so converting
+* rows of every width up to a few times the widest kernel, and comparing with a scalar reference, compares each
+* kernel with the scalar path.
+*/
+
+namespace
+{
+	const PixelFormat Formats[] = { PixelFormat::BGRA8, PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::R8,
+		PixelFormat::RGBA16, PixelFormat::RGBA16F, PixelFormat::RGBA32F, PixelFormat::RGB10A2 };
+	constexpr int MaxWidth = 37;
+	constexpr int Height = 3;
+	constexpr unsigned char Padding = 0xCD;
+
+	uint32_t
+	random()
+	{
+		static uint32_t state = 2463534242u;
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	float
+	makeFloat(uint32_t bits)
+	{
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint32_t
+	floatBits(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float
+	decodeHalf(uint16_t half)
+	{
+		int exponent = (half >> 10) & 0x1F;
+		int mantissa = half & 0x3FF;
+		float value;
+		if (exponent == 31)
+		{
+			value = mantissa ? NAN : INFINITY;
+		}
+		else if (exponent == 0)
+		{
+			value = std::ldexp(static_cast<float>(mantissa), -24);
+		}
+		else
+		{
+			value = std::ldexp(static_cast<float>(mantissa + 1024), exponent - 25);
+		}
+		return (half & 0x8000) ? -value : value;
+	}
+
+	// Rounds to nearest even through double, which holds every float exactly
+	uint16_t
+	encodeHalf(float value)
+	{
+		uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+		double magnitude = std::fabs(static_cast<double>(value));
+		if (std::isnan(value))
+		{
+			return sign | 0x7E00;
+		}
+		if (magnitude == 0.0)
+		{
+			return sign;
+		}
+		if (magnitude >= 65520.0)
+		{
+			return sign | 0x7C00;
+		}
+		int exponent;
+		std::frexp(magnitude, &exponent);
+		// The exponent of the half's quantum, which stops falling for subnormals
+		int quantum = (exponent - 1 < -14 ? -14 : exponent - 1) - 10;
+		double units = std::nearbyint(std::ldexp(magnitude, -quantum));
+		if (quantum == -24)
+		{
+			// Subnormal, or rounded up to the smallest normal whose bits follow on
+			return sign | static_cast<uint16_t>(units);
+		}
+		// units is in [1024, 2048] and includes the implicit bit, so rounding up to 2048 carries into the exponent
+		return sign | static_cast<uint16_t>(((quantum + 24) << 10) + static_cast<int>(units));
+	}
+
+	uint32_t
+	unorm8(float value)
+	{
+		if (std::isnan(value))
+		{
+			return 255;
+		}
+		value = value < 1.0f ? (value > 0.0f ? value : 0.0f) : 1.0f;
+		return static_cast<uint32_t>(value * 255.0f + 0.5f);
+	}
+
+	// A pixel of source as 8-bit RGBA, red in the lowest byte
+	uint32_t
+	referenceRGBA8(const unsigned char* pixel, PixelFormat format)
+	{
+		uint32_t c[4] = { 0, 0, 0, 255 };
+		switch (format)
+		{
+		case PixelFormat::BGRA8:
+			c[0] = pixel[2];
+			c[1] = pixel[1];
+			c[2] = pixel[0];
+			c[3] = pixel[3];
+			break;
+		case PixelFormat::RGBA8:
+			for (int i = 0; i < 4; i++)
+				c[i] = pixel[i];
+			break;
+		case PixelFormat::RGB8:
+			for (int i = 0; i < 3; i++)
+				c[i] = pixel[i];
+			break;
+		case PixelFormat::R8:
+			c[0] = pixel[0];
+			break;
+		case PixelFormat::RGBA16:
+			for (int i = 0; i < 4; i++)
+			{
+				uint16_t value;
+				memcpy(&value, pixel + i * 2, sizeof(value));
+				c[i] = (static_cast<uint32_t>(value) * 255 + 32768) >> 16;
+			}
+			break;
+		case PixelFormat::RGBA16F:
+			for (int i = 0; i < 4; i++)
+			{
+				uint16_t value;
+				memcpy(&value, pixel + i * 2, sizeof(value));
+				c[i] = unorm8(decodeHalf(value));
+			}
+			break;
+		case PixelFormat::RGBA32F:
+			for (int i = 0; i < 4; i++)
+			{
+				float value;
+				memcpy(&value, pixel + i * 4, sizeof(value));
+				c[i] = unorm8(value);
+			}
+			break;
+		case PixelFormat::RGB10A2:
+		{
+			uint32_t packed;
+			memcpy(&packed, pixel, sizeof(packed));
+			for (int i = 0; i < 3; i++)
+				c[i] = static_cast<uint32_t>(static_cast<float>((packed >> (i * 10)) & 0x3FF) * (255.0f / 1023.0f) + 0.5f);
+			c[3] = (packed >> 30) * 85;
+			break;
+		}
+		}
+		return c[0] | (c[1] << 8) | (c[2] << 16) | (c[3] << 24);
+	}
+
+	// Random pixels, with float components around [0, 1] and specials among them
+	void
+	fillPixels(std::vector<unsigned char>& pixels, PixelFormat format)
+	{
+		const float specials[] = { 0.0f, -0.0f, 1.0f, 0.5f, INFINITY, -INFINITY, NAN, 1e-30f, 65504.0f, -2.0f };
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			pixels[i] = static_cast<unsigned char>(random());
+		}
+		if (format == PixelFormat::RGBA32F)
+		{
+			for (size_t i = 0; i + 4 <= pixels.size(); i += 4)
+			{
+				uint32_t choice = random() % 16;
+				float value = choice < 10 ? specials[choice] : static_cast<float>(random() % 1400) / 1000.0f - 0.2f;
+				memcpy(&pixels[i], &value, sizeof(value));
+			}
+		}
+	}
+
+	// Converts rows of every width up to MaxWidth between buffers with the given padding, which must be untouched
+	template <typename Expected>
+	bool
+	convertRows(PixelFormat from, PixelFormat to, size_t sourcePadding, size_t destinationPadding, Expected expected)
+	{
+		bool matched = true;
+		size_t fromSize = GetBytesPerPixel(from);
+		size_t toSize = GetBytesPerPixel(to);
+		for (int width = 1; width <= MaxWidth; width++)
+		{
+			size_t sourcePitch = width * fromSize + sourcePadding;
+			size_t destinationPitch = width * toSize + destinationPadding;
+			// Sized exactly, so reads past the last row would be out of bounds
+			std::vector<unsigned char> source(sourcePitch * (Height - 1) + width * fromSize);
+			std::vector<unsigned char> destination(destinationPitch * Height, Padding);
+			fillPixels(source, from);
+			if (!ConvertPixels(source.data(), sourcePitch, from, destination.data(), destinationPitch, to, width, Height))
+			{
+				return false;
+			}
+			for (int y = 0; y < Height; y++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					matched = expected(source.data() + y * sourcePitch + x * fromSize, destination.data() + y * destinationPitch + x * toSize) && matched;
+				}
+				for (size_t i = width * toSize; i < destinationPitch; i++)
+				{
+					matched = destination[y * destinationPitch + i] == Padding && matched;
+				}
+			}
+		}
+		return matched;
+	}
+
+	void
+	testNarrowing()
+	{
+		for (PixelFormat from : Formats)
+		{
+			for (PixelFormat to : { PixelFormat::RGBA8, PixelFormat::BGRA8 })
+			{
+				CHECK(CanConvertPixels(from, to));
+				auto expected = [from, to](const unsigned char* source, const unsigned char* destination)
+				{
+					uint32_t pixel = referenceRGBA8(source, from);
+					if (to == PixelFormat::BGRA8)
+					{
+						pixel = (pixel & 0xFF00FF00) | ((pixel & 0xFF) << 16) | ((pixel >> 16) & 0xFF);
+					}
+					uint32_t converted;
+					memcpy(&converted, destination, sizeof(converted));
+					return converted == pixel;
+				};
+				CHECK(convertRows(from, to, 0, 0, expected));
+				// Padding which isn't a whole number of pixels
+				CHECK(convertRows(from, to, 3, 5, expected));
+				CHECK(convertRows(from, to, 16, 1, expected));
+			}
+		}
+	}
+
+	void
+	testCopies()
+	{
+		for (PixelFormat format : Formats)
+		{
+			size_t size = GetBytesPerPixel(format);
+			auto expected = [size](const unsigned char* source, const unsigned char* destination)
+			{
+				return memcmp(source, destination, size) == 0;
+			};
+			CHECK(convertRows(format, format, 0, 0, expected));
+			CHECK(convertRows(format, format, 7, 2, expected));
+		}
+	}
+
+	void
+	testFloatToHalf()
+	{
+		CHECK(CanConvertPixels(PixelFormat::RGBA32F, PixelFormat::RGBA16F));
+		CHECK(!CanConvertPixels(PixelFormat::RGBA16F, PixelFormat::RGBA32F));
+		auto expected = [](const unsigned char* source, const unsigned char* destination)
+		{
+			bool matched = true;
+			for (int i = 0; i < 4; i++)
+			{
+				float value;
+				uint16_t half;
+				memcpy(&value, source + i * 4, sizeof(value));
+				memcpy(&half, destination + i * 2, sizeof(half));
+				if (std::isnan(value))
+				{
+					// Any quiet NaN of the same sign
+					matched = matched && (half & 0x7E00) == 0x7E00 && (half & 0x8000) == (std::signbit(value) ? 0x8000 : 0);
+				}
+				else
+				{
+					matched = matched && half == encodeHalf(value);
+				}
+			}
+			return matched;
+		};
+		CHECK(convertRows(PixelFormat::RGBA32F, PixelFormat::RGBA16F, 0, 0, expected));
+		CHECK(convertRows(PixelFormat::RGBA32F, PixelFormat::RGBA16F, 4, 6, expected));
+
+		// Each value in every lane of a row of 7 pixels, so each is converted by the kernel and by the scalar tail
+		const struct
+		{
+			float		value;
+			uint16_t	half;
+		} cases[] = {
+			{ 0.0f, 0x0000 },
+			{ -0.0f, 0x8000 },
+			{ 1.0f, 0x3C00 },
+			{ -2.0f, 0xC000 },
+			{ INFINITY, 0x7C00 },
+			{ -INFINITY, 0xFC00 },
+			{ 65504.0f, 0x7BFF },
+			// Halfway to the next half rounds to infinity, just below it doesn't
+			{ 65520.0f, 0x7C00 },
+			{ 65519.99f, 0x7BFF },
+			{ 1e10f, 0x7C00 },
+			// Smallest normal and subnormal, and the largest subnormal
+			{ std::ldexp(1.0f, -14), 0x0400 },
+			{ std::ldexp(1.0f, -24), 0x0001 },
+			{ std::ldexp(1023.0f, -24), 0x03FF },
+			// Subnormal ties round to even
+			{ std::ldexp(1.0f, -25), 0x0000 },
+			{ std::ldexp(3.0f, -25), 0x0002 },
+			{ std::ldexp(1.0f, -26), 0x0000 },
+			{ -std::ldexp(3.0f, -25), 0x8002 },
+			// Normal ties round to even
+			{ 1.0f + std::ldexp(1.0f, -11), 0x3C00 },
+			{ 1.0f + std::ldexp(3.0f, -11), 0x3C02 },
+			{ 1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20), 0x3C01 },
+			// Rounding up a subnormal to the smallest normal
+			{ std::ldexp(2047.0f, -25), 0x0400 },
+		};
+		const int Width = 7;
+		for (const auto& test : cases)
+		{
+			float source[Width * 4];
+			uint16_t destination[Width * 4];
+			for (float& value : source)
+			{
+				value = test.value;
+			}
+			CHECK(ConvertPixels(reinterpret_cast<const unsigned char*>(source), sizeof(source), PixelFormat::RGBA32F,
+				reinterpret_cast<unsigned char*>(destination), sizeof(destination), PixelFormat::RGBA16F, Width, 1));
+			bool matched = true;
+			for (uint16_t half : destination)
+			{
+				matched = matched && half == test.half;
+			}
+			CHECK(matched);
+			CHECK(encodeHalf(test.value) == test.half);
+		}
+
+		// NaN stays NaN, keeping its sign and the top of its payload
+		float nans[Width * 4];
+		uint16_t halves[Width * 4];
+		for (int i = 0; i < Width * 4; i++)
+		{
+			nans[i] = makeFloat((i % 2 ? 0xFFC00000u : 0x7FC00000u) | (0x155u << 13));
+		}
+		CHECK(ConvertPixels(reinterpret_cast<const unsigned char*>(nans), sizeof(nans), PixelFormat::RGBA32F,
+			reinterpret_cast<unsigned char*>(halves), sizeof(halves), PixelFormat::RGBA16F, Width, 1));
+		bool matched = true;
+		for (int i = 0; i < Width * 4; i++)
+		{
+			matched = matched && halves[i] == ((i % 2 ? 0xFE00 : 0x7E00) | 0x155);
+		}
+		CHECK(matched);
+		CHECK(floatBits(decodeHalf(0x3C00)) == floatBits(1.0f));
+	}
+
+	void
+	testHalfToUnorm8()
+	{
+		const struct
+		{
+			uint16_t	half;
+			uint8_t		unorm;
+		} cases[] = {
+			{ 0x0000, 0 },
+			{ 0x8000, 0 },
+			{ 0x3C00, 255 },
+			{ 0x3800, 128 },
+			{ 0xBC00, 0 },
+			{ 0x7C00, 255 },
+			{ 0xFC00, 0 },
+			// NaN becomes 1, whichever path converts it
+			{ 0x7E00, 255 },
+			{ 0xFE01, 255 },
+			// Subnormals are as good as zero
+			{ 0x0001, 0 },
+			{ 0x03FF, 0 },
+			{ 0x1C04, 1 },
+		};
+		const int Width = 7;
+		for (const auto& test : cases)
+		{
+			uint16_t source[Width * 4];
+			uint8_t destination[Width * 4];
+			for (uint16_t& value : source)
+			{
+				value = test.half;
+			}
+			CHECK(ConvertPixels(reinterpret_cast<const unsigned char*>(source), sizeof(source), PixelFormat::RGBA16F,
+				destination, sizeof(destination), PixelFormat::RGBA8, Width, 1));
+			bool matched = true;
+			for (uint8_t unorm : destination)
+			{
+				matched = matched && unorm == test.unorm;
+			}
+			CHECK(matched);
+		}
+	}
+
+	void
+	testRGB10A2()
+	{
+		// Red in the lowest bits, then green, blue and two bits of alpha
+		auto pack = [](uint32_t red, uint32_t green, uint32_t blue, uint32_t alpha)
+		{
+			return red | (green << 10) | (blue << 20) | (alpha << 30);
+		};
+		const struct
+		{
+			uint32_t	packed;
+			uint32_t	rgba;
+		} cases[] = {
+			{ pack(0, 0, 0, 0), 0x00000000 },
+			{ pack(1023, 0, 0, 3), 0xFF0000FF },
+			{ pack(0, 1023, 0, 1), 0x5500FF00 },
+			{ pack(0, 0, 1023, 2), 0xAAFF0000 },
+			// 512 * 255 / 1023 is 127.6, 3 is 0.75 and 1 is 0.25
+			{ pack(512, 3, 1, 3), 0xFF000180 },
+			{ pack(1020, 1022, 3, 0), 0x0001FFFE },
+		};
+		const int Width = 7;
+		for (const auto& test : cases)
+		{
+			uint32_t source[Width];
+			uint32_t rgba[Width];
+			uint32_t bgra[Width];
+			for (uint32_t& pixel : source)
+			{
+				pixel = test.packed;
+			}
+			CHECK(ConvertPixels(reinterpret_cast<const unsigned char*>(source), sizeof(source), PixelFormat::RGB10A2,
+				reinterpret_cast<unsigned char*>(rgba), sizeof(rgba), PixelFormat::RGBA8, Width, 1));
+			CHECK(ConvertPixels(reinterpret_cast<const unsigned char*>(source), sizeof(source), PixelFormat::RGB10A2,
+				reinterpret_cast<unsigned char*>(bgra), sizeof(bgra), PixelFormat::BGRA8, Width, 1));
+			uint32_t swapped = (test.rgba & 0xFF00FF00) | ((test.rgba & 0xFF) << 16) | ((test.rgba >> 16) & 0xFF);
+			bool matched = true;
+			for (int x = 0; x < Width; x++)
+			{
+				matched = matched && rgba[x] == test.rgba && bgra[x] == swapped;
+			}
+			CHECK(matched);
+		}
+	}
+
+	void
+	testUnsupported()
+	{
+		unsigned char pixels[16] = {};
+		CHECK(!CanConvertPixels(PixelFormat::RGBA8, PixelFormat::RGB8));
+		CHECK(!CanConvertPixels(PixelFormat::RGBA8, PixelFormat::RGBA32F));
+		CHECK(!ConvertPixels(pixels, 4, PixelFormat::RGBA8, pixels, 16, PixelFormat::RGBA32F, 1, 1));
+	}
+}
+
+int
+main()
+{
+	testNarrowing();
+	testCopies();
+	testFloatToHalf();
+	testHalfToUnorm8();
+	testRGB10A2();
+	testUnsupported();
+	return CHECK_RESULT();
+}
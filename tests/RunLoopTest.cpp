@@ -0,0 +1,94 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "RunLoop.h"
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	constexpr int64_t Millisecond = 1000000;
+
+	int64_t
+	elapsedSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void
+	testTimeout()
+	{
+		ConditionRunLoop loop;
+		auto start = std::chrono::steady_clock::now();
+		CHECK(loop.wait(5 * Millisecond) == RunLoop::Wake::Timeout);
+		CHECK(elapsedSince(start) >= 5 * Millisecond);
+	}
+
+	void
+	testWakeBeforeWait()
+	{
+		ConditionRunLoop loop;
+		// Wakes are coalesced into one
+		loop.wake();
+		loop.wake();
+		loop.wake();
+		CHECK(loop.wait(RunLoop::Infinite) == RunLoop::Wake::Signal);
+		CHECK(loop.wait(Millisecond) == RunLoop::Wake::Timeout);
+	}
+
+	void
+	testWakeFromThread()
+	{
+		ConditionRunLoop loop;
+		auto start = std::chrono::steady_clock::now();
+		std::thread waker([&loop]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				loop.wake();
+			});
+		// Far longer than the waker takes, so only a wake() ends it in time
+		CHECK(loop.wait(10000 * Millisecond) == RunLoop::Wake::Signal);
+		CHECK(elapsedSince(start) < 5000 * Millisecond);
+		waker.join();
+
+		waker = std::thread([&loop]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				loop.wake();
+			});
+		CHECK(loop.wait(RunLoop::Infinite) == RunLoop::Wake::Signal);
+		waker.join();
+	}
+
+	void
+	testCreate()
+	{
+		std::unique_ptr<RunLoop> loop = RunLoop::create();
+		CHECK(loop);
+		loop->wake();
+		CHECK(loop->wait(RunLoop::Infinite) == RunLoop::Wake::Signal);
+	}
+}
+
+int
+main()
+{
+	testTimeout();
+	testWakeBeforeWait();
+	testWakeFromThread();
+	testCreate();
+	return CHECK_RESULT();
+}
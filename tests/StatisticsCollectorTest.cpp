@@ -0,0 +1,73 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+
+#include "Check.h"
+#include "StatisticsCollector.h"
+
+namespace
+{
+	TEInstanceStatistics
+	makeStatistics(int64_t frames, int64_t frameTimeCPU, int64_t frameTimeGPU)
+	{
+		TEInstanceStatistics statistics{};
+		statistics.frames = frames;
+		statistics.frameTimeCPU = frameTimeCPU;
+		statistics.frameTimeGPU = frameTimeGPU;
+		return statistics;
+	}
+
+	void
+	testWeightedFrameTimes()
+	{
+		using Metric = StatisticsCollector::Metric;
+		StatisticsCollector collector;
+		// Ten frames taking 1ms in total, then one frame of 1ms
+		collector.record(makeStatistics(10, 1000000, 2000000));
+		collector.record(makeStatistics(1, 1000000, -1));
+		collector.collect();
+
+		const LatencyHistogram& cpu = collector.getHistogram(Metric::FrameTimeCPU);
+		CHECK(cpu.getCount() == 11);
+		CHECK(cpu.getMean() == 1000000 * 2 / 11);
+		CHECK(cpu.getMin() == 100000);
+		CHECK(cpu.getMax() == 1000000);
+		// The median is one of the ten short frames, not the long one
+		CHECK(cpu.getPercentile(50.0) < 110000);
+
+		const LatencyHistogram& gpu = collector.getHistogram(Metric::FrameTimeGPU);
+		CHECK(gpu.getCount() == 10);
+		CHECK(gpu.getMean() == 200000);
+		CHECK(collector.getTotals().frames == 11);
+	}
+
+	void
+	testNoFrames()
+	{
+		StatisticsCollector collector;
+		collector.record(makeStatistics(0, 0, 0));
+		collector.collect();
+		CHECK(collector.getHistogram(StatisticsCollector::Metric::FrameTimeCPU).getCount() == 0);
+		CHECK(collector.getHistogram(StatisticsCollector::Metric::FrameTimeGPU).getCount() == 0);
+		CHECK(collector.getTotals().frames == 0);
+	}
+}
+
+int
+main()
+{
+	testWeightedFrameTimes();
+	testNoFrames();
+	return CHECK_RESULT();
+}
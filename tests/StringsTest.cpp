@@ -0,0 +1,155 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Check.h"
+#include "Strings.h"
+
+namespace
+{
+	constexpr bool WideIsUTF16 = sizeof(wchar_t) == 2;
+
+	bool
+	roundTrips(const std::string& utf8, const std::wstring& wide)
+	{
+		std::wstring toWide;
+		std::string toUTF8;
+		return ConvertToWide(utf8, toWide) && toWide == wide &&
+			ConvertToMultiByte(wide, toUTF8) && toUTF8 == utf8 &&
+			ConvertToWide(utf8) == wide && ConvertToMultiByte(wide) == utf8;
+	}
+
+	bool
+	rejectsUTF8(const std::string& utf8)
+	{
+		std::wstring wide = L"unchanged";
+		return !ConvertToWide(utf8, wide) && wide.empty() && ConvertToWide(utf8).empty();
+	}
+
+	bool
+	rejectsWide(const std::wstring& wide)
+	{
+		std::string utf8 = "unchanged";
+		return !ConvertToMultiByte(wide, utf8) && utf8.empty() && ConvertToMultiByte(wide).empty();
+	}
+
+	void
+	testASCII()
+	{
+		CHECK(roundTrips("", L""));
+		CHECK(roundTrips("a", L"a"));
+		// Lengths either side of the 16 characters converted at a time
+		std::string utf8;
+		std::wstring wide;
+		for (int i = 0; i < 40; i++)
+		{
+			CHECK(roundTrips(utf8, wide));
+			char c = static_cast<char>(' ' + i * 2);
+			utf8 += c;
+			wide += static_cast<wchar_t>(c);
+		}
+		CHECK(roundTrips(std::string("\x7F\x01", 2), std::wstring(L"\x7F\x01", 2)));
+	}
+
+	void
+	testBMP()
+	{
+		CHECK(roundTrips("\xC3\xA9", L"\x00E9"));
+		CHECK(roundTrips("\xDF\xBF", L"\x07FF"));
+		CHECK(roundTrips("\xE0\xA0\x80", L"\x0800"));
+		CHECK(roundTrips("\xE6\x9D\xB1\xE4\xBA\xAC", L"\x6771\x4EAC"));
+		CHECK(roundTrips("\xEF\xBF\xBD", L"\xFFFD"));
+		// Non-ASCII characters at each position within and after a run of ASCII
+		for (size_t i = 0; i <= 20; i++)
+		{
+			std::string utf8(20, 'x');
+			std::wstring wide(20, L'x');
+			utf8.replace(i, i < 20 ? 1 : 0, "\xC3\xA9");
+			wide.replace(i, i < 20 ? 1 : 0, L"\x00E9");
+			CHECK(roundTrips(utf8, wide));
+		}
+	}
+
+	void
+	testSupplementary()
+	{
+		// U+1F3AC, and the last code point
+		std::wstring clapper = WideIsUTF16 ? std::wstring(L"\xD83C\xDFAC") : std::wstring(1, static_cast<wchar_t>(0x1F3AC));
+		std::wstring last = WideIsUTF16 ? std::wstring(L"\xDBFF\xDFFF") : std::wstring(1, static_cast<wchar_t>(0x10FFFF));
+		CHECK(roundTrips("\xF0\x9F\x8E\xAC", clapper));
+		CHECK(roundTrips("\xF4\x8F\xBF\xBF", last));
+		CHECK(roundTrips("take \xF0\x9F\x8E\xAC" "1", L"take " + clapper + L"1"));
+	}
+
+	void
+	testInvalidUTF8()
+	{
+		CHECK(rejectsUTF8("\x80"));
+		CHECK(rejectsUTF8("\xBF"));
+		CHECK(rejectsUTF8("\xFF"));
+		// Truncated
+		CHECK(rejectsUTF8("\xC3"));
+		CHECK(rejectsUTF8("\xE2\x82"));
+		CHECK(rejectsUTF8("\xF0\x9F\x8E"));
+		CHECK(rejectsUTF8("\xE2\x82x"));
+		// Overlong
+		CHECK(rejectsUTF8("\xC0\xAF"));
+		CHECK(rejectsUTF8("\xE0\x80\xAF"));
+		CHECK(rejectsUTF8("\xF0\x80\x80\xAF"));
+		// Surrogates, and beyond U+10FFFF
+		CHECK(rejectsUTF8("\xED\xA0\x80"));
+		CHECK(rejectsUTF8("\xED\xBF\xBF"));
+		CHECK(rejectsUTF8("\xF4\x90\x80\x80"));
+		// After a run converted 16 at a time
+		CHECK(rejectsUTF8(std::string(32, 'a') + "\xC3"));
+	}
+
+	void
+	testInvalidWide()
+	{
+		// Unpaired surrogates, at the end and before other characters
+		CHECK(rejectsWide(std::wstring(1, static_cast<wchar_t>(0xD800))));
+		CHECK(rejectsWide(std::wstring(1, static_cast<wchar_t>(0xDC00))));
+		CHECK(rejectsWide(std::wstring(1, static_cast<wchar_t>(0xD83C)) + L"a"));
+		CHECK(rejectsWide(L"a" + std::wstring(1, static_cast<wchar_t>(0xDFAC)) + L"b"));
+		CHECK(rejectsWide(std::wstring(32, L'a') + std::wstring(1, static_cast<wchar_t>(0xDBFF))));
+		if constexpr (!WideIsUTF16)
+		{
+			CHECK(rejectsWide(std::wstring(1, static_cast<wchar_t>(0x110000))));
+		}
+	}
+
+	void
+	testBuffers()
+	{
+		wchar_t wide[8];
+		char utf8[8];
+		CHECK(ConvertToWide("abc", 3, wide, 8) == 3);
+		CHECK(ConvertToWide("abc", 3, wide, 2) == ConversionFailed);
+		CHECK(ConvertToMultiByte(L"\x00E9", 1, utf8, 2) == 2);
+		CHECK(ConvertToMultiByte(L"\x00E9", 1, utf8, 1) == ConversionFailed);
+		CHECK(ConvertToMultiByte(L"\x6771", 1, utf8, 2) == ConversionFailed);
+	}
+}
+
+int
+main()
+{
+	testASCII();
+	testBMP();
+	testSupplementary();
+	testInvalidUTF8();
+	testInvalidWide();
+	testBuffers();
+	return CHECK_RESULT();
+}
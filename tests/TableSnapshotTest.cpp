@@ -0,0 +1,139 @@
+/* Shared Use License: This file is owned by Derivative Inc. (Derivative)
+* and can only be used, and/or modified for use, in conjunction with
+* Derivative's TouchDesigner software, and only if you are a licensee who has
+* accepted Derivative's TouchDesigner license or assignment agreement
+* (which also govern the use of this file). You may share or redistribute
+* a modified version of this file provided the following conditions are met:
+*
+* 1. The shared file or redistribution must retain the information set out
+* above and this list of conditions.
+* 2. Derivative's name (Derivative Inc.) or its trademarks may not be used
+* to endorse or promote products derived from this file without specific
+* prior written permission from Derivative.
+*/
+
+#include "Check.h"
+#include "TableSnapshot.h"
+#include <string>
+
+namespace
+{
+	TouchObject<TETable>
+	makeTable(const std::vector<std::vector<std::string>>& rows)
+	{
+		TouchObject<TETable> table;
+		table.take(TETableCreate());
+		int32_t columns = rows.empty() ? 0 : static_cast<int32_t>(rows[0].size());
+		TETableResize(table, static_cast<int32_t>(rows.size()), columns);
+		for (int32_t row = 0; row < static_cast<int32_t>(rows.size()); row++)
+		{
+			for (int32_t column = 0; column < columns; column++)
+			{
+				TETableSetStringValue(table, row, column, rows[row][column].c_str());
+			}
+		}
+		return table;
+	}
+
+	void
+	testNumericColumns()
+	{
+		TableSnapshot snapshot;
+		CHECK(snapshot.update(makeTable({ { "1", "a" }, { "-2.5", "3" }, { "1e3", "" } })));
+		CHECK(snapshot.getRowCount() == 3);
+		CHECK(snapshot.getColumnCount() == 2);
+
+		const TableSnapshot::Column& numbers = snapshot.getColumn(0);
+		CHECK(numbers.type == TableSnapshot::ColumnType::Number);
+		CHECK(numbers.numbers.size() == 3);
+		CHECK(numbers.numbers[0] == 1.0);
+		CHECK(numbers.numbers[1] == -2.5);
+		CHECK(numbers.numbers[2] == 1000.0);
+
+		// A single non-numeric cell, even an empty one, makes the column strings
+		const TableSnapshot::Column& strings = snapshot.getColumn(1);
+		CHECK(strings.type == TableSnapshot::ColumnType::String);
+		CHECK(strings.strings.size() == 3);
+		CHECK(snapshot.getString(strings.strings[1]) == "3");
+		CHECK(snapshot.getString(strings.strings[2]).empty());
+	}
+
+	void
+	testInterning()
+	{
+		TableSnapshot snapshot;
+		CHECK(snapshot.update(makeTable({ { "red", "blue" }, { "blue", "red" }, { "red", "green" } })));
+		const TableSnapshot::Column& first = snapshot.getColumn(0);
+		const TableSnapshot::Column& second = snapshot.getColumn(1);
+		CHECK(snapshot.getStringCount() == 3);
+		CHECK(first.strings[0] == first.strings[2]);
+		CHECK(first.strings[0] == second.strings[1]);
+		CHECK(first.strings[1] == second.strings[0]);
+		CHECK(first.strings[0] != first.strings[1]);
+		CHECK(snapshot.findString("red") == first.strings[0]);
+		CHECK(snapshot.findString("green") == second.strings[2]);
+		CHECK(snapshot.findString("yellow") == TableSnapshot::InvalidStringID);
+		CHECK(snapshot.getString(snapshot.findString("blue")) == "blue");
+	}
+
+	void
+	testUnchangedTableReused()
+	{
+		TableSnapshot snapshot;
+		TouchObject<TETable> table = makeTable({ { "1", "x" }, { "2", "y" } });
+		CHECK(snapshot.update(table));
+		uint64_t generation = snapshot.getGeneration();
+		uint32_t x = snapshot.findString("x");
+
+		CHECK(!snapshot.update(table));
+		CHECK(snapshot.getGeneration() == generation);
+		CHECK(snapshot.findString("x") == x);
+
+		// Another table holding the same cells is reused too
+		CHECK(!snapshot.update(makeTable({ { "1", "x" }, { "2", "y" } })));
+		CHECK(snapshot.getGeneration() == generation);
+
+		CHECK(snapshot.update(TouchObject<TETable>()));
+		CHECK(snapshot.getRowCount() == 0);
+		CHECK(!snapshot.update(TouchObject<TETable>()));
+	}
+
+	void
+	testChangedTableDecoded()
+	{
+		TableSnapshot snapshot;
+		TouchObject<TETable> table = makeTable({ { "1", "x" }, { "2", "y" } });
+		CHECK(snapshot.update(table));
+		uint64_t generation = snapshot.getGeneration();
+
+		// Changed in place, as pooled input tables are
+		TETableSetStringValue(table, 1, 0, "5");
+		TETableSetStringValue(table, 0, 1, "z");
+		CHECK(snapshot.update(table));
+		CHECK(snapshot.getGeneration() != generation);
+		CHECK(snapshot.getColumn(0).numbers[1] == 5.0);
+		CHECK(snapshot.findString("z") == snapshot.getColumn(1).strings[0]);
+		CHECK(snapshot.findString("x") == TableSnapshot::InvalidStringID);
+
+		// Moving a character between cells changes the table
+		TETableSetStringValue(table, 0, 1, "zy");
+		TETableSetStringValue(table, 1, 1, "");
+		CHECK(snapshot.update(table));
+		CHECK(snapshot.getString(snapshot.getColumn(1).strings[0]) == "zy");
+
+		// As does resizing it
+		TETableResize(table, 3, 2);
+		CHECK(snapshot.update(table));
+		CHECK(snapshot.getRowCount() == 3);
+	}
+}
+
+int
+main()
+{
+	testNumericColumns();
+	testInterning();
+	testUnchangedTableReused();
+	testChangedTableDecoded();
+	return CHECK_RESULT();
+}